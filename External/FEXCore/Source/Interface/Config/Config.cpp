@@ -1,5 +1,6 @@
 #include "Common/StringConv.h"
 #include "Common/Paths.h"
+#include "Interface/Config/ConfigSnapshot.h"
 #include "Utils/FileLoading.h"
 
 #include <FEXCore/Config/Config.h>
@@ -59,7 +60,7 @@ namespace JSON {
     return &*alloc->json_objects->emplace(alloc->json_objects->end());
   }
 
-  static void LoadJSonConfig(const std::string &Config, std::function<void(const char *Name, const char *ConfigSring)> Func) {
+  static void ParseJSonConfig(const std::string &Config, Snapshot::OptionCallback const &Func) {
     std::vector<char> Data;
     if (!FEXCore::FileLoading::LoadFile(Data, Config)) {
       return;
@@ -104,6 +105,11 @@ namespace JSON {
       Func(ConfigName, ConfigString);
     }
   }
+
+  static void LoadJSonConfig(const std::string &Config, Snapshot::OptionCallback const &Func) {
+    // Skips parsing if a FEX parent already did it for the same file
+    Snapshot::LoadFile(Config, Func, ParseJSonConfig);
+  }
 }
 
   std::string GetDataDirectory() {
@@ -309,6 +315,7 @@ namespace JSON {
   void Shutdown() {
     ConfigLayers.clear();
     Meta = nullptr;
+    Snapshot::Shutdown();
   }
 
   void Load() {
@@ -0,0 +1,341 @@
+/*
+$info$
+tags: glue|config
+desc: Hands the config files a FEX process parsed down to its FEX children through a sealed memfd
+$end_info$
+*/
+
+#include "Interface/Config/ConfigSnapshot.h"
+
+#include <FEXCore/Config/Config.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace FEXCore::Config::Snapshot {
+  // A file that changed since the parent parsed it no longer matches
+  struct FileKey {
+    uint64_t Dev{};
+    uint64_t Inode{};
+    uint64_t Size{};
+    int64_t MTimeSec{};
+    int64_t MTimeNSec{};
+    uint32_t Exists{};
+
+    bool operator==(FileKey const &) const = default;
+  };
+
+  static FileKey GetFileKey(const std::string &Path) {
+    struct stat Stat{};
+    if (stat(Path.c_str(), &Stat) == -1) {
+      return {};
+    }
+
+    return FileKey {
+      .Dev = Stat.st_dev,
+      .Inode = Stat.st_ino,
+      .Size = static_cast<uint64_t>(Stat.st_size),
+      .MTimeSec = Stat.st_mtim.tv_sec,
+      .MTimeNSec = Stat.st_mtim.tv_nsec,
+      .Exists = 1,
+    };
+  }
+
+  // Files this process loaded, the contents of its own snapshot
+  struct LoadedFile {
+    std::string Path;
+    FileKey Key;
+    std::vector<std::pair<std::string, std::string>> Options;
+  };
+  static std::vector<LoadedFile> LoadedFiles;
+
+  // Files in the parent's snapshot, pointing in to the mapping
+  struct ParentFile {
+    std::string_view Path;
+    FileKey Key;
+    std::vector<std::pair<const char*, const char*>> Options;
+  };
+  static std::vector<ParentFile> ParentFiles;
+  static void *ParentMapping{};
+  static size_t ParentMappingSize{};
+
+  static std::atomic<int> SnapshotFD{-1};
+  static FileKey SnapshotKey{};
+
+  constexpr uint32_t SNAPSHOT_MAGIC = 0x53584546; // 'FEXS'
+  constexpr uint32_t SNAPSHOT_VERSION = 1;
+  // Config files are a few KB at most, anything larger isn't ours
+  constexpr size_t SNAPSHOT_MAX_SIZE = 16 * 1024 * 1024;
+
+  class Writer {
+  public:
+    template<typename T>
+    void Write(T Value) {
+      auto Bytes = reinterpret_cast<const char*>(&Value);
+      Data.insert(Data.end(), Bytes, Bytes + sizeof(T));
+    }
+
+    void WriteString(std::string_view String) {
+      Write<uint32_t>(String.size());
+      Data.insert(Data.end(), String.begin(), String.end());
+      // Null terminated so the child can use the strings in place
+      Data.emplace_back('\0');
+    }
+
+    std::vector<char> Data;
+  };
+
+  class Reader {
+  public:
+    Reader(const char *Data, size_t Size)
+      : Data {Data}, Size {Size} {
+    }
+
+    template<typename T>
+    bool Read(T *Value) {
+      if (Size - Offset < sizeof(T)) {
+        return false;
+      }
+      memcpy(Value, Data + Offset, sizeof(T));
+      Offset += sizeof(T);
+      return true;
+    }
+
+    bool ReadString(std::string_view *String) {
+      uint32_t Length{};
+      if (!Read(&Length) || Size - Offset <= Length || Data[Offset + Length] != '\0') {
+        return false;
+      }
+      *String = std::string_view(Data + Offset, Length);
+      Offset += Length + 1;
+      return true;
+    }
+
+  private:
+    const char *Data;
+    size_t Size;
+    size_t Offset{};
+  };
+
+  static bool ReadFileKey(Reader &Input, FileKey *Key) {
+    return Input.Read(&Key->Dev) &&
+      Input.Read(&Key->Inode) &&
+      Input.Read(&Key->Size) &&
+      Input.Read(&Key->MTimeSec) &&
+      Input.Read(&Key->MTimeNSec) &&
+      Input.Read(&Key->Exists);
+  }
+
+  static void WriteFileKey(Writer &Output, FileKey const &Key) {
+    Output.Write(Key.Dev);
+    Output.Write(Key.Inode);
+    Output.Write(Key.Size);
+    Output.Write(Key.MTimeSec);
+    Output.Write(Key.MTimeNSec);
+    Output.Write(Key.Exists);
+  }
+
+  static bool ParseSnapshot(const char *Data, size_t Size) {
+    Reader Input{Data, Size};
+
+    uint32_t Magic{}, Version{}, NumFiles{};
+    if (!Input.Read(&Magic) || !Input.Read(&Version) || !Input.Read(&NumFiles) ||
+        Magic != SNAPSHOT_MAGIC || Version != SNAPSHOT_VERSION) {
+      return false;
+    }
+
+    for (uint32_t i = 0; i < NumFiles; ++i) {
+      ParentFile File{};
+      uint32_t NumOptions{};
+      if (!Input.ReadString(&File.Path) || !ReadFileKey(Input, &File.Key) || !Input.Read(&NumOptions)) {
+        return false;
+      }
+
+      for (uint32_t j = 0; j < NumOptions; ++j) {
+        std::string_view Name, Value;
+        if (!Input.ReadString(&Name) || !Input.ReadString(&Value)) {
+          return false;
+        }
+        File.Options.emplace_back(Name.data(), Value.data());
+      }
+
+      ParentFiles.emplace_back(std::move(File));
+    }
+
+    return true;
+  }
+
+  static void UnmapParentSnapshot() {
+    ParentFiles.clear();
+    if (ParentMapping) {
+      munmap(ParentMapping, ParentMappingSize);
+      ParentMapping = nullptr;
+      ParentMappingSize = 0;
+    }
+  }
+
+  void LoadFile(const std::string &Path, OptionCallback const &Func, ParseCallback const &Parse) {
+    const auto Key = GetFileKey(Path);
+
+    // Loading the same file again replaces what we had for it
+    auto Loaded = std::find_if(LoadedFiles.begin(), LoadedFiles.end(), [&Path](LoadedFile const &File) {
+      return File.Path == Path;
+    });
+    if (Loaded == LoadedFiles.end()) {
+      Loaded = LoadedFiles.emplace(LoadedFiles.end(), LoadedFile{Path, Key, {}});
+    }
+    else {
+      Loaded->Key = Key;
+      Loaded->Options.clear();
+    }
+
+    auto &Options = Loaded->Options;
+    const auto Record = [&Options, &Func](const char *Name, const char *ConfigString) {
+      Options.emplace_back(Name, ConfigString);
+      Func(Name, ConfigString);
+    };
+
+    auto Parent = std::find_if(ParentFiles.begin(), ParentFiles.end(), [&Path, &Key](ParentFile const &File) {
+      return File.Path == Path && File.Key == Key;
+    });
+    if (Parent != ParentFiles.end()) {
+      for (auto &[Name, ConfigString] : Parent->Options) {
+        Record(Name, ConfigString);
+      }
+      return;
+    }
+
+    if (Key.Exists) {
+      Parse(Path, Record);
+    }
+  }
+
+  void Shutdown() {
+    UnmapParentSnapshot();
+    LoadedFiles.clear();
+
+    int FD = SnapshotFD.exchange(-1);
+    if (FD != -1) {
+      close(FD);
+    }
+  }
+
+  static int CreateSnapshotFD() {
+    Writer Output{};
+    Output.Write(SNAPSHOT_MAGIC);
+    Output.Write(SNAPSHOT_VERSION);
+    Output.Write<uint32_t>(LoadedFiles.size());
+    for (auto &File : LoadedFiles) {
+      Output.WriteString(File.Path);
+      WriteFileKey(Output, File.Key);
+      Output.Write<uint32_t>(File.Options.size());
+      for (auto &[Name, ConfigString] : File.Options) {
+        Output.WriteString(Name);
+        Output.WriteString(ConfigString);
+      }
+    }
+
+    int FD = ::memfd_create("FEXConfigSnapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (FD == -1) {
+      return -1;
+    }
+
+    size_t Written{};
+    while (Written < Output.Data.size()) {
+      ssize_t Result = write(FD, Output.Data.data() + Written, Output.Data.size() - Written);
+      if (Result == -1 && errno == EINTR) {
+        continue;
+      }
+      if (Result <= 0) {
+        close(FD);
+        return -1;
+      }
+      Written += Result;
+    }
+
+    // Sealed so the child can map it without the contents or size changing underneath it
+    if (fcntl(FD, F_ADD_SEALS, F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE) == -1) {
+      close(FD);
+      return -1;
+    }
+
+    return FD;
+  }
+}
+
+namespace FEXCore::Config {
+  int GetSnapshotFD() {
+    int FD = Snapshot::SnapshotFD.load();
+    if (FD == -1) {
+      // Multiple threads can execve at once, only one of them gets to keep theirs
+      int NewFD = Snapshot::CreateSnapshotFD();
+      if (NewFD == -1) {
+        return -1;
+      }
+
+      struct stat Stat{};
+      fstat(NewFD, &Stat);
+      if (Snapshot::SnapshotFD.compare_exchange_strong(FD, NewFD)) {
+        Snapshot::SnapshotKey = {.Dev = Stat.st_dev, .Inode = Stat.st_ino, .Exists = 1};
+        return NewFD;
+      }
+
+      close(NewFD);
+    }
+
+    // The guest can close our fd and get something else with the same number
+    struct stat Stat{};
+    if (fstat(FD, &Stat) == -1 ||
+        Stat.st_dev != Snapshot::SnapshotKey.Dev ||
+        Stat.st_ino != Snapshot::SnapshotKey.Inode) {
+      return -1;
+    }
+
+    return FD;
+  }
+
+  void LoadSnapshot(int FD) {
+    Snapshot::UnmapParentSnapshot();
+
+    // Only trust a sealed file, it can't change or shrink while it is mapped
+    // Anything else isn't ours to close
+    constexpr int RequiredSeals = F_SEAL_SHRINK | F_SEAL_WRITE;
+    int Seals = fcntl(FD, F_GET_SEALS);
+    if (Seals == -1 || (Seals & RequiredSeals) != RequiredSeals) {
+      return;
+    }
+
+    struct stat Stat{};
+    if (fstat(FD, &Stat) == -1 ||
+        Stat.st_size <= 0 || static_cast<size_t>(Stat.st_size) > Snapshot::SNAPSHOT_MAX_SIZE) {
+      close(FD);
+      return;
+    }
+
+    void *Mapping = mmap(nullptr, Stat.st_size, PROT_READ, MAP_PRIVATE, FD, 0);
+    close(FD);
+    if (Mapping == MAP_FAILED) {
+      return;
+    }
+
+    Snapshot::ParentMapping = Mapping;
+    Snapshot::ParentMappingSize = Stat.st_size;
+
+    if (!Snapshot::ParseSnapshot(reinterpret_cast<const char*>(Mapping), Stat.st_size)) {
+      LogMan::Msg::DFmt("Ignoring invalid config snapshot");
+      Snapshot::UnmapParentSnapshot();
+    }
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <functional>
+#include <string>
+
+namespace FEXCore::Config::Snapshot {
+  using OptionCallback = std::function<void(const char *Name, const char *ConfigString)>;
+  using ParseCallback = std::function<void(const std::string &Path, OptionCallback const &Func)>;
+
+  /**
+   * @brief Loads the options of a config file, from the parent's snapshot if the file hasn't changed since
+   *
+   * The options are also recorded for the snapshot handed to our own children.
+   *
+   * @param Path The config file
+   * @param Func Called for each option in the file
+   * @param Parse Parses the file if the snapshot doesn't have it
+   */
+  void LoadFile(const std::string &Path, OptionCallback const &Func, ParseCallback const &Parse);
+
+  void Shutdown();
+}
@@ -95,6 +95,10 @@ namespace FEXCore::Context {
     CTX->Pause();
   }
 
+  void PauseOtherThreads(FEXCore::Context::Context *CTX) {
+    CTX->PauseOtherThreads();
+  }
+
   void Stop(FEXCore::Context::Context *CTX) {
     CTX->Stop(false);
   }
@@ -178,6 +182,10 @@ namespace FEXCore::Context {
     CTX->SetAOTIRRenamer(CacheRenamer);
   }
 
+  void SetGuestSymbolizer(FEXCore::Context::Context *CTX, GuestSymbolizer Symbolizer) {
+    CTX->SetGuestSymbolizer(std::move(Symbolizer));
+  }
+
   void FinalizeAOTIRCache(FEXCore::Context::Context *CTX) {
     CTX->FinalizeAOTIRCache();
   }
@@ -192,11 +200,27 @@ namespace FEXCore::Context {
   void RemoveNamedRegion(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length) {
     return CTX->RemoveNamedRegion(Base, Length);
   }
+  void AddGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length, bool PrivateFile, int Prot) {
+    return CTX->AddGuestMapping(Base, Length, PrivateFile, Prot);
+  }
+  void RemoveGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length) {
+    return CTX->RemoveGuestMapping(Base, Length);
+  }
+  void ProtectGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length, int Prot) {
+    return CTX->ProtectGuestMapping(Base, Length, Prot);
+  }
+  bool TracksGuestMappings(FEXCore::Context::Context *CTX) {
+    return CTX->TracksGuestMappings();
+  }
 
 namespace Debug {
   void CompileRIP(FEXCore::Context::Context *CTX, uint64_t RIP) {
     CTX->CompileRIP(CTX->ParentThread, RIP);
   }
+
+  void RetainDebugData(FEXCore::Context::Context *CTX) {
+    CTX->RetainDebugData();
+  }
   uint64_t GetThreadCount(FEXCore::Context::Context *CTX) {
     return CTX->GetThreadCount();
   }
@@ -31,6 +31,13 @@
 
 namespace FEXCore {
 class CodeLoader;
+class LookupCachePagePool;
+class BlockProfiler;
+class CodeStats;
+class CompileTimeStats;
+class GuestSymbols;
+class ReadOnlyRegions;
+class SampleProfiler;
 class ThunkHandler;
 class GdbServer;
 
@@ -87,6 +94,7 @@ namespace FEXCore::Context {
       FEX_CONFIG_OPT(AOTIRGenerate, AOTIRGENERATE);
       FEX_CONFIG_OPT(AOTIRLoad, AOTIRLOAD);
       FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
+      FEX_CONFIG_OPT(ReadOnlyFolding, READONLYFOLDING);
       FEX_CONFIG_OPT(Core, CORE);
       FEX_CONFIG_OPT(MaxInstPerBlock, MAXINST);
       FEX_CONFIG_OPT(RootFSPath, ROOTFS);
@@ -98,6 +106,14 @@ namespace FEXCore::Context {
       FEX_CONFIG_OPT(LibraryJITNaming, LIBRARYJITNAMING);
       FEX_CONFIG_OPT(BlockJITNaming, BLOCKJITNAMING);
       FEX_CONFIG_OPT(ParanoidTSO, PARANOIDTSO);
+      FEX_CONFIG_OPT(LookupCacheL1MaxEntries, LOOKUPCACHEL1MAXENTRIES);
+      FEX_CONFIG_OPT(IRCacheSize, IRCACHESIZE);
+      FEX_CONFIG_OPT(SampleProfile, SAMPLEPROFILE);
+      FEX_CONFIG_OPT(SampleProfileFrequency, SAMPLEPROFILEFREQUENCY);
+      FEX_CONFIG_OPT(BlockProfile, BLOCKPROFILE);
+      FEX_CONFIG_OPT(CodeStats, CODESTATS);
+      FEX_CONFIG_OPT(CompileTimeStats, COMPILETIMESTATS);
+      FEX_CONFIG_OPT(CompileTimeLog, COMPILETIMELOG);
     } Config;
 
     using IntCallbackReturn =  FEX_NAKED void(*)(FEXCore::Core::InternalThreadState *Thread, volatile void *Host_RSP);
@@ -109,6 +125,9 @@ namespace FEXCore::Context {
     uint64_t ThreadID{};
     FEXCore::Core::InternalThreadState* ParentThread;
     std::vector<FEXCore::Core::InternalThreadState*> Threads;
+    // Torn down threads that kept their JIT state, CreateThread hands these out first
+    // Protected by ThreadCreationMutex
+    std::vector<FEXCore::Core::InternalThreadState*> ThreadPool;
     std::atomic_bool CoreShuttingDown{false};
 
     std::mutex IdleWaitMutex;
@@ -121,14 +140,23 @@ namespace FEXCore::Context {
     FEXCore::CPUIDEmu CPUID;
     FEXCore::HLE::SyscallHandler *SyscallHandler{};
     std::unique_ptr<FEXCore::ThunkHandler> ThunkHandler;
+    // Backing for every thread's L2 lookup cache pages
+    std::unique_ptr<FEXCore::LookupCachePagePool> L2PagePool;
+    // Only exist while the matching profiler is enabled
+    std::unique_ptr<FEXCore::SampleProfiler> SampleProfiler;
+    std::unique_ptr<FEXCore::BlockProfiler> BlockProfiler;
+    // Only exists while any profiler is enabled
+    std::unique_ptr<FEXCore::GuestSymbols> GuestSymbols;
+    // Only exists while code statistics are enabled
+    std::unique_ptr<FEXCore::CodeStats> CodeStats;
+    // Only exists while compile time statistics are enabled
+    std::unique_ptr<FEXCore::CompileTimeStats> CompileTimeStats;
+    // Only exists while loads from read-only memory get folded
+    std::unique_ptr<FEXCore::ReadOnlyRegions> ReadOnlyRegions;
 
     CustomCPUFactoryType CustomCPUFactory;
     FEXCore::Context::ExitHandler CustomExitHandler;
 
-#ifdef BLOCKSTATS
-    std::unique_ptr<FEXCore::BlockSamplingData> BlockData;
-#endif
-
     SignalDelegator *SignalDelegation{};
     X86GeneratedCode X86CodeGen;
 
@@ -140,6 +168,7 @@ namespace FEXCore::Context {
     int GetProgramStatus() const;
     bool IsPaused() const { return !Running; }
     void Pause();
+    void PauseOtherThreads();
     void Run();
     void WaitForThreadsToRun();
     void Step();
@@ -168,6 +197,9 @@ namespace FEXCore::Context {
     FEXCore::Core::RuntimeStats *GetRuntimeStatsForThread(uint64_t Thread);
     bool GetDebugDataForRIP(uint64_t RIP, FEXCore::Core::DebugData *Data);
     bool FindHostCodeForRIP(uint64_t RIP, uint8_t **Code);
+    // Blocks compiled afterwards keep their IR and debug data for the lookups above
+    void RetainDebugData() { KeepDebugData = true; }
+    bool RetainsDebugData() const { return KeepDebugData; }
 
     struct GenerateIRResult {
       FEXCore::IR::IRListView* IRList;
@@ -177,6 +209,8 @@ namespace FEXCore::Context {
       uint64_t TotalInstructionsLength;
       uint64_t StartAddr;
       uint64_t Length;
+      // Pages of read-only memory that loads were folded from
+      std::vector<uint64_t> ReadOnlyPages;
     };
     [[nodiscard]] GenerateIRResult GenerateIR(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP);
 
@@ -258,6 +292,8 @@ namespace FEXCore::Context {
     /**
      * @brief Destroys this FEX thread object and stops tracking it internally
      *
+     * The object and its JIT state may be kept around for the next CreateThread instead of being freed
+     *
      * @param Thread The internal FEX thread state object
      */
     void DestroyThread(FEXCore::Core::InternalThreadState *Thread);
@@ -272,6 +308,11 @@ namespace FEXCore::Context {
     void AddNamedRegion(uintptr_t Base, uintptr_t Size, uintptr_t Offset, const std::string &filename);
     void RemoveNamedRegion(uintptr_t Base, uintptr_t Size);
 
+    void AddGuestMapping(uintptr_t Base, uintptr_t Size, bool PrivateFile, int Prot);
+    void RemoveGuestMapping(uintptr_t Base, uintptr_t Size);
+    void ProtectGuestMapping(uintptr_t Base, uintptr_t Size, int Prot);
+    bool TracksGuestMappings() const { return ReadOnlyRegions != nullptr; }
+
     FEXCore::JITSymbols Symbols;
 
     // Public for threading
@@ -297,9 +338,18 @@ namespace FEXCore::Context {
       IRCaptureCache.SetAOTIRRenamer(CacheRenamer);
     }
 
+    void SetGuestSymbolizer(GuestSymbolizer Symbolizer);
+
   protected:
     void ClearCodeCache(FEXCore::Core::InternalThreadState *Thread, bool AlsoClearIRCache);
 
+    /**
+     * @brief Drops every block with host code in [HostStart, HostEnd) so the backend can reuse that memory
+     *
+     * Blocks outside of the range stay compiled, only links in to the evicted blocks are undone.
+     */
+    void EvictCodeRange(FEXCore::Core::InternalThreadState *Thread, uintptr_t HostStart, uintptr_t HostEnd);
+
   private:
     /**
      * @brief Does some final thread initialization
@@ -310,6 +360,18 @@ namespace FEXCore::Context {
      */
     void InitializeThreadData(FEXCore::Core::InternalThreadState *Thread);
 
+    /**
+     * @brief Resets a torn down thread object to its initial state while keeping its JIT state
+     *
+     * @param Thread The internal FEX thread state object, no longer executing and no longer in Threads
+     *
+     * @return false if the thread object can't be reused and needs to be deleted instead
+     */
+    bool RecycleThread(FEXCore::Core::InternalThreadState *Thread);
+
+    // Creating the compiler objects and the code buffer is most of the cost of a new thread
+    static constexpr size_t MAX_POOLED_THREADS = 8;
+
     void WaitForIdleWithTimeout();
 
     void NotifyPause();
@@ -325,6 +387,7 @@ namespace FEXCore::Context {
     IR::AOTIRCaptureCache IRCaptureCache;
 
     bool StartPaused = false;
+    bool KeepDebugData = false;
     FEX_CONFIG_OPT(AppFilename, APP_FILENAME);
   };
 
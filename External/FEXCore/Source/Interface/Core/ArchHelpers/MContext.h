@@ -28,6 +28,7 @@ struct X86ContextBackup {
 
   // Guest state
   int Signal;
+  uint64_t GuestSignalMask;
   uint32_t Flags;
   uint64_t OriginalRIP;
   uint64_t FPStateLocation;
@@ -51,6 +52,7 @@ struct ArmContextBackup {
 
   // Guest state
   int Signal;
+  uint64_t GuestSignalMask;
   uint32_t Flags;
   uint64_t OriginalRIP;
   uint64_t FPStateLocation;
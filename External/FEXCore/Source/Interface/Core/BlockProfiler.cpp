@@ -0,0 +1,227 @@
+/*
+$info$
+tags: glue|profiling
+desc: Counts entries and time of every JIT block and writes a sorted report at exit
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/BlockProfiler.h"
+#include "Interface/Core/GuestSymbols.h"
+
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef _M_X86_64
+#include <x86intrin.h>
+#endif
+
+namespace FEXCore {
+  // Same counter the JIT reads on block entry
+  static inline uint64_t ReadTimestamp() {
+#ifdef _M_X86_64
+    return __rdtsc();
+#elif defined(_M_ARM_64)
+    uint64_t Result;
+    __asm volatile("mrs %[Res], CNTVCT_EL0" : [Res] "=r" (Result));
+    return Result;
+#else
+    return 0;
+#endif
+  }
+
+  BlockProfilerThread::BlockProfilerThread() {
+    // Only the pages of slots that get assigned are ever touched
+    void *Ptr = FEXCore::Allocator::mmap(nullptr, MAPPING_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (Ptr != MAP_FAILED) {
+      Data = reinterpret_cast<Header*>(Ptr);
+      Counters = reinterpret_cast<BlockProfileCounters*>(Data + 1);
+      Data->LastCounters = &Counters[FEX_SLOT];
+    }
+  }
+
+  BlockProfilerThread::~BlockProfilerThread() {
+    if (Data) {
+      FEXCore::Allocator::munmap(Data, MAPPING_SIZE);
+    }
+  }
+
+  BlockProfileCounters *BlockProfilerThread::GetCounters(uint64_t GuestRIP) {
+    if (!Data) {
+      return nullptr;
+    }
+
+    auto it = Blocks.find(GuestRIP);
+    if (it != Blocks.end()) {
+      return &Counters[it->second.Slot];
+    }
+
+    if (NextSlot == MAX_BLOCKS) {
+      return nullptr;
+    }
+
+    const auto Slot = NextSlot++;
+    Blocks.emplace(GuestRIP, BlockInfo{Slot, 0, 0, 0});
+    return &Counters[Slot];
+  }
+
+  void BlockProfilerThread::SetBlockInfo(uint64_t GuestRIP, uint64_t GuestSize, uint64_t GuestInstructions, uint64_t HostSize) {
+    auto it = Blocks.find(GuestRIP);
+    if (it == Blocks.end()) {
+      return;
+    }
+
+    it->second.GuestSize = GuestSize;
+    it->second.GuestInstructions = GuestInstructions;
+    it->second.HostSize = HostSize;
+  }
+
+  void BlockProfilerThread::Pause() {
+    if (!Data || PauseDepth++ != 0) {
+      return;
+    }
+
+    const uint64_t Now = ReadTimestamp();
+    Data->LastCounters->Cycles += Now - Data->LastTimestamp;
+    PausedCounters = Data->LastCounters;
+    Data->LastCounters = &Counters[FEX_SLOT];
+    Data->LastTimestamp = Now;
+  }
+
+  void BlockProfilerThread::Resume() {
+    if (!Data || PauseDepth == 0 || --PauseDepth != 0) {
+      return;
+    }
+
+    const uint64_t Now = ReadTimestamp();
+    Data->LastCounters->Cycles += Now - Data->LastTimestamp;
+    Data->LastCounters = PausedCounters;
+    Data->LastTimestamp = Now;
+  }
+
+  void BlockProfilerThread::Start() {
+    if (!Data) {
+      return;
+    }
+
+    PauseDepth = 0;
+    Data->LastCounters = &Counters[FEX_SLOT];
+    Data->LastTimestamp = ReadTimestamp();
+  }
+
+  void BlockProfilerThread::Reset() {
+    if (!Data) {
+      return;
+    }
+
+    memset(Counters, 0, NextSlot * sizeof(BlockProfileCounters));
+  }
+
+  BlockProfiler::BlockProfiler(FEXCore::Context::Context *CTX, std::string const &OutputFolder)
+    : CTX {CTX}
+    , OutputFolder {OutputFolder} {
+  }
+
+  void BlockProfiler::StartThread(FEXCore::Core::InternalThreadState *Thread) {
+    if (!Thread->BlockProfiler) {
+      Thread->BlockProfiler = std::make_unique<BlockProfilerThread>();
+    }
+    Thread->BlockProfiler->Start();
+  }
+
+  void BlockProfiler::StopThread(FEXCore::Core::InternalThreadState *Thread) {
+    auto ThreadProfiler = Thread->BlockProfiler.get();
+    if (!ThreadProfiler) {
+      return;
+    }
+
+    // Charges the last block up to now
+    ThreadProfiler->Pause();
+
+    std::lock_guard lk(BlocksMutex);
+    ThreadProfiler->VisitBlocks([this](uint64_t GuestRIP, BlockProfileCounters const &Counters, uint64_t GuestSize, uint64_t GuestInstructions, uint64_t HostSize) {
+      auto &Stats = Blocks[GuestRIP];
+      Stats.Calls += Counters.Calls;
+      Stats.Cycles += Counters.Cycles;
+      // Threads compile the same RIP the same way
+      Stats.GuestSize = GuestSize;
+      Stats.GuestInstructions = GuestInstructions;
+      Stats.HostSize = HostSize;
+    });
+    FEXCounters.Cycles += ThreadProfiler->GetFEXCounters().Cycles;
+
+    ThreadProfiler->Reset();
+  }
+
+  void BlockProfiler::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // Another thread may have held this at the time of the fork
+    new (&BlocksMutex) std::mutex{};
+
+    Blocks.clear();
+    FEXCounters = {};
+
+    if (LiveThread->BlockProfiler) {
+      LiveThread->BlockProfiler->Reset();
+      LiveThread->BlockProfiler->Start();
+    }
+  }
+
+  void BlockProfiler::WriteProfile(std::string const &Application) {
+    std::lock_guard lk(BlocksMutex);
+
+    if (Blocks.empty()) {
+      return;
+    }
+
+    const auto Filename = fmt::format("{}/{}-{}.blocks", OutputFolder, std::filesystem::path(Application).filename().string(), ::getpid());
+    FILE *fp = fopen(Filename.c_str(), "w");
+    if (!fp) {
+      LogMan::Msg::EFmt("Couldn't open block profile '{}': {}", Filename, strerror(errno));
+      return;
+    }
+
+    std::vector<std::pair<uint64_t, BlockStats const*>> Sorted;
+    Sorted.reserve(Blocks.size());
+    uint64_t TotalCycles = FEXCounters.Cycles;
+    for (auto const &[GuestRIP, Stats] : Blocks) {
+      Sorted.emplace_back(GuestRIP, &Stats);
+      TotalCycles += Stats.Cycles;
+    }
+
+    std::sort(Sorted.begin(), Sorted.end(), [](auto const &lhs, auto const &rhs) {
+      return lhs.second->Cycles > rhs.second->Cycles;
+    });
+
+    // Cycles are host timestamp counter ticks
+    fmt::print(fp, "# {:>18} {:>7} {:>14} {:>16} {:>11} {:>6} {:>10}  {}\n",
+      "RIP", "Time%", "Calls", "Cycles", "Cycles/Call", "Insts", "Host/Guest", "Symbol");
+    fmt::print(fp, "  {:>18} {:>6.2f}% {:>14} {:>16} {:>11} {:>6} {:>10}  {}\n",
+      "-", TotalCycles ? FEXCounters.Cycles * 100.0 / TotalCycles : 0.0, "-", FEXCounters.Cycles, "-", "-", "-", "[FEX]");
+
+    for (auto const &[GuestRIP, Stats] : Sorted) {
+      fmt::print(fp, "  {:>#18x} {:>6.2f}% {:>14} {:>16} {:>11.1f} {:>6} {:>10.2f}  {}\n",
+        GuestRIP,
+        TotalCycles ? Stats->Cycles * 100.0 / TotalCycles : 0.0,
+        Stats->Calls,
+        Stats->Cycles,
+        static_cast<double>(Stats->Cycles) / Stats->Calls,
+        Stats->GuestInstructions,
+        Stats->GuestSize ? static_cast<double>(Stats->HostSize) / Stats->GuestSize : 0.0,
+        CTX->GuestSymbols->GetName(GuestRIP));
+    }
+
+    fclose(fp);
+
+    LogMan::Msg::IFmt("Block profile: {} blocks written to '{}'", Sorted.size(), Filename);
+  }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+namespace Core {
+  struct InternalThreadState;
+}
+
+// Bumped by JIT code on every block entry
+struct BlockProfileCounters {
+  uint64_t Calls;
+  uint64_t Cycles;
+};
+
+/**
+ * @brief Per thread side of the block profiler
+ *
+ * Every instrumented block is assigned a slot in a contiguous counter array when it is compiled.
+ * On entry a block reads the host timestamp counter, charges the time since the last block entry to the last block
+ * and makes itself the last block. Code that runs between two blocks, like the dispatcher, is charged to the block
+ * before it.
+ *
+ * Everything must only be called from the owning thread.
+ */
+class BlockProfilerThread final {
+public:
+  // Read and written by the JIT code, always at the start of the mapping
+  struct Header {
+    uint64_t LastTimestamp;
+    BlockProfileCounters *LastCounters;
+  };
+
+  constexpr static size_t MAX_BLOCKS = 64 * 1024;
+
+  BlockProfilerThread();
+  ~BlockProfilerThread();
+
+  BlockProfilerThread(BlockProfilerThread const&) = delete;
+  BlockProfilerThread& operator=(BlockProfilerThread const&) = delete;
+
+  Header *GetHeader() { return Data; }
+
+  /**
+   * @brief Gets the counters of a block while compiling it
+   *
+   * Recompiling a RIP reuses its counters.
+   *
+   * @return nullptr if there are no free slots left, the block isn't instrumented
+   */
+  BlockProfileCounters *GetCounters(uint64_t GuestRIP);
+
+  // Static information for the report, called once the block is compiled
+  void SetBlockInfo(uint64_t GuestRIP, uint64_t GuestSize, uint64_t GuestInstructions, uint64_t HostSize);
+
+  /**
+   * @name Excludes FEX time from the blocks
+   *
+   * Time spent between Pause and Resume is charged to the FEX slot instead of the current block.
+   * Calls can nest.
+   * @{ */
+    void Pause();
+    void Resume();
+  /**  @} */
+
+  // Starts timing from now
+  void Start();
+
+  // Drops all counts but keeps slot assignments, blocks in the code cache still point at them
+  void Reset();
+
+  /**
+   * @brief Visits every block that was entered at least once
+   *
+   * Visit(GuestRIP, Counters, GuestSize, GuestInstructions, HostSize)
+   */
+  template<typename Visitor>
+  void VisitBlocks(Visitor &&Visit) const {
+    for (auto const &[GuestRIP, Info] : Blocks) {
+      if (Counters[Info.Slot].Calls) {
+        Visit(GuestRIP, Counters[Info.Slot], Info.GuestSize, Info.GuestInstructions, Info.HostSize);
+      }
+    }
+  }
+
+  BlockProfileCounters const &GetFEXCounters() const { return Counters[FEX_SLOT]; }
+
+private:
+  // Time not spent in guest code
+  constexpr static size_t FEX_SLOT = 0;
+
+  struct BlockInfo {
+    uint32_t Slot;
+    uint32_t GuestSize;
+    uint32_t GuestInstructions;
+    uint32_t HostSize;
+  };
+
+  constexpr static size_t MAPPING_SIZE = sizeof(Header) + MAX_BLOCKS * sizeof(BlockProfileCounters);
+
+  Header *Data{};
+  // Directly follows the header in the same mapping
+  BlockProfileCounters *Counters{};
+
+  // Keyed by guest RIP
+  std::unordered_map<uint64_t, BlockInfo> Blocks;
+  uint32_t NextSlot{FEX_SLOT + 1};
+
+  uint32_t PauseDepth{};
+  BlockProfileCounters *PausedCounters{};
+};
+
+/**
+ * @brief Process wide side of the block profiler
+ *
+ * Threads hand their counts over when they exit and the merged counts are written out sorted by time.
+ */
+class BlockProfiler final {
+public:
+  BlockProfiler(FEXCore::Context::Context *CTX, std::string const &OutputFolder);
+
+  // Called on the thread itself when it starts and stops executing
+  void StartThread(FEXCore::Core::InternalThreadState *Thread);
+  void StopThread(FEXCore::Core::InternalThreadState *Thread);
+
+  // Only the live thread continues counting, dead threads' counts belong to the parent
+  void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+  /**
+   * @brief Writes every merged block to `<OutputFolder>/<Application>-<PID>.blocks`
+   */
+  void WriteProfile(std::string const &Application);
+
+private:
+  struct BlockStats {
+    uint64_t Calls;
+    uint64_t Cycles;
+    uint64_t GuestSize;
+    uint64_t GuestInstructions;
+    uint64_t HostSize;
+  };
+
+  FEXCore::Context::Context *CTX;
+  std::string const OutputFolder;
+
+  std::mutex BlocksMutex;
+  // Keyed by guest RIP
+  std::unordered_map<uint64_t, BlockStats> Blocks;
+  BlockProfileCounters FEXCounters{};
+};
+}
@@ -0,0 +1,92 @@
+/*
+$info$
+tags: glue|telemetry
+desc: Counts guest instructions, IR ops and host code bytes per IR op for telemetry
+$end_info$
+*/
+
+#include "Interface/Core/CodeStats.h"
+
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/IR/IntrusiveIRList.h>
+#include <FEXCore/Utils/Telemetry.h>
+
+namespace FEXCore {
+  void CodeStatsThread::RecordIR(FEXCore::IR::IRListView const *IR, bool Optimized) {
+    auto &Counts = Optimized ? OptimizedOps : DispatchedOps;
+    for (auto [CodeNode, IROp] : IR->GetAllCode()) {
+      ++Counts[IROp->Op];
+    }
+  }
+
+  void CodeStats::MergeThread(FEXCore::Core::InternalThreadState *Thread) {
+    auto ThreadStats = Thread->CodeStats.get();
+    if (!ThreadStats) {
+      return;
+    }
+
+    std::lock_guard lk(StatsMutex);
+
+    for (auto const &[Name, Count] : ThreadStats->GuestInstructions) {
+      GuestInstructions[Name] += Count;
+    }
+
+    for (size_t i = 0; i < DispatchedOps.size(); ++i) {
+      DispatchedOps[i] += ThreadStats->DispatchedOps[i];
+      OptimizedOps[i] += ThreadStats->OptimizedOps[i];
+      HostOps[i] += ThreadStats->HostOps[i];
+      HostBytes[i] += ThreadStats->HostBytes[i];
+    }
+
+    PassRuns += ThreadStats->PassRuns;
+    PassRunsChanged += ThreadStats->PassRunsChanged;
+
+    *ThreadStats = {};
+  }
+
+  void CodeStats::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // Another thread may have held this at the time of the fork
+    new (&StatsMutex) std::mutex{};
+
+    GuestInstructions.clear();
+    DispatchedOps = {};
+    OptimizedOps = {};
+    HostOps = {};
+    HostBytes = {};
+    PassRuns = 0;
+    PassRunsChanged = 0;
+
+    if (LiveThread->CodeStats) {
+      *LiveThread->CodeStats = {};
+    }
+  }
+
+  void CodeStats::Publish() {
+    std::lock_guard lk(StatsMutex);
+
+    for (auto const &[Name, Count] : GuestInstructions) {
+      FEXCore::Telemetry::AddKeyedValue("Guest instructions compiled", Name, Count);
+    }
+
+    for (size_t i = 0; i < DispatchedOps.size(); ++i) {
+      auto const &Name = FEXCore::IR::GetName(static_cast<FEXCore::IR::IROps>(i));
+      if (DispatchedOps[i]) {
+        FEXCore::Telemetry::AddKeyedValue("IR ops dispatched", Name, DispatchedOps[i]);
+      }
+      if (OptimizedOps[i]) {
+        FEXCore::Telemetry::AddKeyedValue("IR ops after passes", Name, OptimizedOps[i]);
+      }
+      if (HostOps[i]) {
+        FEXCore::Telemetry::AddKeyedValue("IR ops emitted by the JIT", Name, HostOps[i]);
+      }
+      if (HostBytes[i]) {
+        FEXCore::Telemetry::AddKeyedValue("Host code bytes per IR op", Name, HostBytes[i]);
+      }
+    }
+
+    if (PassRuns) {
+      FEXCore::Telemetry::AddKeyedValue("IR passes", "Blocks optimized", PassRuns);
+      FEXCore::Telemetry::AddKeyedValue("IR passes", "Blocks changed by the passes", PassRunsChanged);
+    }
+  }
+}
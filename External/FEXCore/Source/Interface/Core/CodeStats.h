@@ -0,0 +1,96 @@
+#pragma once
+
+#include <FEXCore/IR/IR.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+
+namespace FEXCore {
+namespace Core {
+  struct InternalThreadState;
+}
+namespace IR {
+  class IRListView;
+}
+
+/**
+ * @brief Per thread counts of what went in to and came out of compiling blocks
+ *
+ * Counted on every compile, recompiles included, so hot code that gets evicted counts more than once.
+ * Only touched by the thread that owns it.
+ */
+class CodeStatsThread final {
+public:
+  // Name is usually X86InstInfo::Name, it must outlive the thread
+  void RecordGuestInstruction(char const *Name) {
+    ++GuestInstructions[Name];
+  }
+
+  /**
+   * @brief Counts the IR ops of a block
+   *
+   * @param Optimized If the passes have run over the IR yet
+   */
+  void RecordIR(FEXCore::IR::IRListView const *IR, bool Optimized);
+
+  void RecordPassResult(bool Changed) {
+    ++PassRuns;
+    PassRunsChanged += Changed;
+  }
+
+  // Called by the JITs for every op they emit
+  void RecordHostCode(FEXCore::IR::IROps Op, size_t Bytes) {
+    ++HostOps[Op];
+    HostBytes[Op] += Bytes;
+  }
+
+private:
+  friend class CodeStats;
+
+  using IROpCounts = std::array<uint64_t, FEXCore::IR::IROps::OP_LAST + 1>;
+
+  // Pointers to the instruction table names, equal names may have different pointers
+  std::unordered_map<char const*, uint64_t> GuestInstructions;
+
+  IROpCounts DispatchedOps{};
+  IROpCounts OptimizedOps{};
+  IROpCounts HostOps{};
+  IROpCounts HostBytes{};
+
+  uint64_t PassRuns{};
+  uint64_t PassRunsChanged{};
+};
+
+/**
+ * @brief Process wide side of the code statistics
+ *
+ * Threads hand their counts over when they stop and the merged counts are handed to telemetry when the context
+ * goes away, so they end up in the application's telemetry file.
+ */
+class CodeStats final {
+public:
+  // Merges and clears the thread's counts
+  void MergeThread(FEXCore::Core::InternalThreadState *Thread);
+
+  // Counts from before the fork belong to the parent
+  void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+  void Publish();
+
+private:
+  std::mutex StatsMutex;
+
+  std::map<std::string, uint64_t> GuestInstructions;
+  CodeStatsThread::IROpCounts DispatchedOps{};
+  CodeStatsThread::IROpCounts OptimizedOps{};
+  CodeStatsThread::IROpCounts HostOps{};
+  CodeStatsThread::IROpCounts HostBytes{};
+  uint64_t PassRuns{};
+  uint64_t PassRunsChanged{};
+};
+}
@@ -1,6 +1,10 @@
 #include "Interface/Context/Context.h"
+#include "Interface/Core/LocalIRCache.h"
 #include "Interface/Core/LookupCache.h"
 #include "Interface/Core/CompileService.h"
+#include "Interface/Core/CompileTimeStats.h"
+#include "Interface/Core/BlockProfiler.h"
+#include "Interface/Core/CodeStats.h"
 #include "Interface/Core/OpcodeDispatcher.h"
 #include "FEXCore/Debug/InternalThreadState.h"
 #include "FEXCore/HLE/Linux/ThreadManagement.h"
@@ -68,7 +72,7 @@ namespace FEXCore {
       // It's safe to clear things that aren't marked safe since we are clearing cache
       GCArray.clear();
 
-      LOGMAN_THROW_A_FMT(CompileThreadData->LocalIRCache.empty(), "Compile service must never have LocalIRCache");
+      LOGMAN_THROW_A_FMT(CompileThreadData->LocalIRCache->Empty(), "Compile service must never have LocalIRCache");
 
       CompileMutex.unlock();
     }
@@ -161,5 +165,12 @@ namespace FEXCore {
         return Entry->SafeToClear.load(std::memory_order_relaxed);
       });
     }
+
+    if (CTX->CodeStats) {
+      CTX->CodeStats->MergeThread(CompileThreadData.get());
+    }
+    if (CTX->CompileTimeStats) {
+      CTX->CompileTimeStats->MergeThread(CompileThreadData.get());
+    }
   }
 }
@@ -0,0 +1,152 @@
+/*
+$info$
+tags: glue|profiling
+desc: Breaks compile time down in to decode, dispatch, passes, RA and codegen
+$end_info$
+*/
+
+#include "Interface/Core/CompileTimeStats.h"
+#include "Interface/IR/PassManager.h"
+
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <unistd.h>
+
+namespace FEXCore {
+  static std::atomic_uint64_t &GetStageStat(FEXCore::Core::RuntimeStats &Stats, CompileStage Stage) {
+    switch (Stage) {
+      case CompileStage::Decode: return Stats.DecodeTime;
+      case CompileStage::Dispatch: return Stats.DispatchTime;
+      case CompileStage::Passes: return Stats.PassTime;
+      case CompileStage::RA: return Stats.RATime;
+      case CompileStage::Codegen: default: return Stats.CodegenTime;
+    }
+  }
+
+  static constexpr std::array<char const*, static_cast<size_t>(CompileStage::Count)> StageNames {
+    "Decode",
+    "Dispatch",
+    "Passes",
+    "RA",
+    "Codegen",
+  };
+
+  void CompileTimeStatsThread::BeginBlock(uint64_t GuestRIP) {
+    Current = {};
+    Current.GuestRIP = GuestRIP;
+  }
+
+  void CompileTimeStatsThread::AddTime(FEXCore::Core::InternalThreadState *Thread, CompileStage Stage, uint64_t Nanoseconds) {
+    // Only this thread writes these, a plain add is enough
+    auto &Stat = GetStageStat(Thread->Stats, Stage);
+    Stat.store(Stat.load(std::memory_order_relaxed) + Nanoseconds, std::memory_order_relaxed);
+    Current.Times[static_cast<size_t>(Stage)] += Nanoseconds;
+  }
+
+  void CompileTimeStatsThread::EndBlock(uint64_t GuestInstructions) {
+    ++BlocksCompiled;
+    if (KeepRecords) {
+      Current.GuestInstructions = GuestInstructions;
+      Records.emplace_back(Current);
+    }
+  }
+
+  CompileTimeStats::CompileTimeStats(std::string const &LogFolder)
+    : LogFolder {LogFolder} {
+  }
+
+  void CompileTimeStats::ResetThread(FEXCore::Core::InternalThreadState *Thread) {
+    for (size_t i = 0; i < static_cast<size_t>(CompileStage::Count); ++i) {
+      GetStageStat(Thread->Stats, static_cast<CompileStage>(i)).store(0, std::memory_order_relaxed);
+    }
+
+    Thread->PassManager->ResetPassTimings();
+
+    Thread->CompileTimes->BlocksCompiled = 0;
+    Thread->CompileTimes->Records.clear();
+  }
+
+  void CompileTimeStats::MergeThread(FEXCore::Core::InternalThreadState *Thread) {
+    auto ThreadStats = Thread->CompileTimes.get();
+    if (!ThreadStats) {
+      return;
+    }
+
+    std::lock_guard lk(StatsMutex);
+
+    for (size_t i = 0; i < StageTimes.size(); ++i) {
+      StageTimes[i] += GetStageStat(Thread->Stats, static_cast<CompileStage>(i)).load(std::memory_order_relaxed);
+    }
+
+    Thread->PassManager->VisitPassTimings([this](std::string const &Name, uint64_t Time) {
+      PassTimes[Name] += Time;
+    });
+
+    BlocksCompiled += ThreadStats->BlocksCompiled;
+    Records.insert(Records.end(), ThreadStats->Records.begin(), ThreadStats->Records.end());
+
+    ResetThread(Thread);
+  }
+
+  void CompileTimeStats::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // Another thread may have held this at the time of the fork
+    new (&StatsMutex) std::mutex{};
+
+    StageTimes = {};
+    BlocksCompiled = 0;
+    PassTimes.clear();
+    Records.clear();
+
+    if (LiveThread->CompileTimes) {
+      ResetThread(LiveThread);
+    }
+  }
+
+  void CompileTimeStats::WriteSummary(std::string const &Application) {
+    std::lock_guard lk(StatsMutex);
+
+    if (BlocksCompiled == 0) {
+      return;
+    }
+
+    uint64_t Total{};
+    for (auto Time : StageTimes) {
+      Total += Time;
+    }
+
+    LogMan::Msg::IFmt("Compile time: {} blocks in {:.3f}ms, {:.1f}us per block", BlocksCompiled, Total / 1e6, Total / 1e3 / BlocksCompiled);
+    for (size_t i = 0; i < StageTimes.size(); ++i) {
+      LogMan::Msg::IFmt("  {:<10} {:>10.3f}ms {:>5.1f}%", StageNames[i], StageTimes[i] / 1e6, Total ? StageTimes[i] * 100.0 / Total : 0.0);
+    }
+
+    for (auto const &[Name, Time] : PassTimes) {
+      LogMan::Msg::IFmt("    Pass {:<22} {:>10.3f}ms", Name, Time / 1e6);
+    }
+
+    if (LogFolder.empty()) {
+      return;
+    }
+
+    const auto Filename = fmt::format("{}/{}-{}.compile.csv", LogFolder, std::filesystem::path(Application).filename().string(), ::getpid());
+    FILE *fp = fopen(Filename.c_str(), "w");
+    if (!fp) {
+      LogMan::Msg::EFmt("Couldn't open compile time log '{}': {}", Filename, strerror(errno));
+      return;
+    }
+
+    // Nanoseconds, in compile order per thread
+    fmt::print(fp, "RIP,Instructions,Decode,Dispatch,Passes,RA,Codegen\n");
+    for (auto const &Record : Records) {
+      fmt::print(fp, "0x{:x},{},{},{},{},{},{}\n",
+        Record.GuestRIP, Record.GuestInstructions,
+        Record.Times[0], Record.Times[1], Record.Times[2], Record.Times[3], Record.Times[4]);
+    }
+
+    fclose(fp);
+  }
+}
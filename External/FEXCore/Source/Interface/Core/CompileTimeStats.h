@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FEXCore {
+namespace Core {
+  struct InternalThreadState;
+}
+
+enum class CompileStage {
+  Decode,
+  Dispatch,
+  // Every pass but register allocation
+  Passes,
+  RA,
+  Codegen,
+  Count,
+};
+
+/**
+ * @brief Per thread side of the compile time statistics
+ *
+ * The stage totals live in the thread's RuntimeStats, this only keeps what is needed for the per block records.
+ * Only touched by the thread that owns it.
+ */
+class CompileTimeStatsThread final {
+public:
+  struct Record {
+    uint64_t GuestRIP;
+    uint64_t GuestInstructions;
+    std::array<uint64_t, static_cast<size_t>(CompileStage::Count)> Times;
+  };
+
+  CompileTimeStatsThread(bool KeepRecords)
+    : KeepRecords {KeepRecords} {}
+
+  static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Starts a new per block record
+  void BeginBlock(uint64_t GuestRIP);
+
+  // Adds to the thread's RuntimeStats and the current record
+  void AddTime(FEXCore::Core::InternalThreadState *Thread, CompileStage Stage, uint64_t Nanoseconds);
+
+  void EndBlock(uint64_t GuestInstructions);
+
+private:
+  friend class CompileTimeStats;
+
+  bool const KeepRecords;
+  uint64_t BlocksCompiled{};
+  Record Current{};
+  std::vector<Record> Records;
+};
+
+/**
+ * @brief Process wide side of the compile time statistics
+ *
+ * Threads hand their times over when they stop. At exit a summary is logged and if a log folder was given every
+ * block's times are written to `<Folder>/<Application>-<PID>.compile.csv`.
+ */
+class CompileTimeStats final {
+public:
+  CompileTimeStats(std::string const &LogFolder);
+
+  // Merges and clears the thread's times
+  void MergeThread(FEXCore::Core::InternalThreadState *Thread);
+
+  // Times from before the fork belong to the parent
+  void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+  void WriteSummary(std::string const &Application);
+
+private:
+  static void ResetThread(FEXCore::Core::InternalThreadState *Thread);
+
+  std::string const LogFolder;
+
+  std::mutex StatsMutex;
+  std::array<uint64_t, static_cast<size_t>(CompileStage::Count)> StageTimes{};
+  uint64_t BlocksCompiled{};
+  // Keyed by pass name, in nanoseconds
+  std::map<std::string, uint64_t> PassTimes;
+  std::vector<CompileTimeStatsThread::Record> Records;
+};
+}
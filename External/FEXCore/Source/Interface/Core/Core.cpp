@@ -8,14 +8,21 @@ $end_info$
 */
 
 #include "Interface/Context/Context.h"
+#include "Interface/Core/BlockProfiler.h"
+#include "Interface/Core/CodeStats.h"
+#include "Interface/Core/GuestSymbols.h"
+#include "Interface/Core/LocalIRCache.h"
 #include "Interface/Core/LookupCache.h"
 #include "Interface/Core/CompileService.h"
+#include "Interface/Core/CompileTimeStats.h"
 #include "Interface/Core/Core.h"
 #include "Interface/Core/CPUID.h"
 #include "Interface/Core/Frontend.h"
 #include "Interface/Core/GdbServer.h"
 #include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/ReadOnlyRegions.h"
 #include "Interface/Core/Interpreter/InterpreterCore.h"
+#include "Interface/Core/SampleProfiler.h"
 #include "Interface/Core/JIT/JITCore.h"
 #include "Interface/HLE/Thunks/Thunks.h"
 #include "Interface/IR/Passes/RegisterAllocationPass.h"
@@ -56,6 +63,7 @@ $end_info$
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <sched.h>
 #include <set>
 #include <shared_mutex>
 #include <signal.h>
@@ -139,17 +147,55 @@ constexpr std::array<std::string_view const, 16> RegNames = {
 std::string_view const& GetGRegName(unsigned Reg) {
   return RegNames[Reg];
 }
+
+InternalThreadState::InternalThreadState() = default;
+InternalThreadState::~InternalThreadState() = default;
 } // namespace FEXCore::Core
 
 namespace FEXCore::Context {
   Context::Context()
   : IRCaptureCache {this} {
-#ifdef BLOCKSTATS
-    BlockData = std::make_unique<FEXCore::BlockSamplingData>();
+    L2PagePool = std::make_unique<FEXCore::LookupCachePagePool>(FEXCore::LookupCache::SIZE_PER_PAGE);
+    if (!Config.SampleProfile().empty()) {
+      SampleProfiler = std::make_unique<FEXCore::SampleProfiler>(this, Config.SampleProfile(), Config.SampleProfileFrequency());
+    }
+    if (!Config.BlockProfile().empty()) {
+      BlockProfiler = std::make_unique<FEXCore::BlockProfiler>(this, Config.BlockProfile());
+    }
+    if (SampleProfiler || BlockProfiler) {
+      GuestSymbols = std::make_unique<FEXCore::GuestSymbols>();
+    }
+#ifndef FEX_DISABLE_TELEMETRY
+    if (Config.CodeStats()) {
+      CodeStats = std::make_unique<FEXCore::CodeStats>();
+    }
 #endif
+    if (Config.CompileTimeStats() || !Config.CompileTimeLog().empty()) {
+      CompileTimeStats = std::make_unique<FEXCore::CompileTimeStats>(Config.CompileTimeLog());
+    }
+    // Folded blocks are only thrown away when the mman SMC checks see the memory change
+    // The AOT IR cache is reused across runs where the loaded values differ
+    if (Config.ReadOnlyFolding() && Config.SMCChecks == FEXCore::Config::CONFIG_SMC_MMAN &&
+        Config.Is64BitMode && !Config.AOTIRCapture() && !Config.AOTIRGenerate()) {
+      ReadOnlyRegions = std::make_unique<FEXCore::ReadOnlyRegions>();
+    }
   }
 
   Context::~Context() {
+    if (SampleProfiler) {
+      // Every thread handed its samples over when it stopped executing
+      SampleProfiler->WriteProfile(AppFilename());
+    }
+    if (BlockProfiler) {
+      BlockProfiler->WriteProfile(AppFilename());
+    }
+    if (CodeStats) {
+      CodeStats->Publish();
+    }
+    if (CompileTimeStats) {
+      CompileTimeStats->WriteSummary(AppFilename());
+    }
+
     {
       for (auto &Thread : Threads) {
         if (Thread->ExecutionThread->joinable()) {
@@ -165,6 +211,11 @@ namespace FEXCore::Context {
         delete Thread;
       }
       Threads.clear();
+
+      for (auto &Thread : ThreadPool) {
+        delete Thread;
+      }
+      ThreadPool.clear();
     }
   }
 
@@ -199,6 +250,10 @@ namespace FEXCore::Context {
 
     ThunkHandler.reset(FEXCore::ThunkHandler::Create());
 
+    if (SampleProfiler) {
+      SampleProfiler->RegisterSignalHandler();
+    }
+
     LocalLoader = Loader;
     using namespace FEXCore::Core;
 
@@ -220,6 +275,7 @@ namespace FEXCore::Context {
     if (!DebugServer) {
       DebugServer = std::make_unique<GdbServer>(this);
       StartPaused = true;
+      RetainDebugData();
     }
   }
 
@@ -288,6 +344,40 @@ namespace FEXCore::Context {
     }
   }
 
+  void Context::PauseOtherThreads() {
+    const pid_t tid = FHU::Syscalls::gettid();
+
+    // Held throughout so none of the threads can be destroyed while waiting on them
+    std::lock_guard<std::mutex> lk(ThreadCreationMutex);
+    for (auto &Thread : Threads) {
+      if (Thread->ThreadManager.TID == tid) {
+        continue;
+      }
+
+      Thread->SignalReason.store(FEXCore::Core::SignalEvent::Pause);
+      if (Thread->RunningEvents.Running.load()) {
+        FHU::Syscalls::tgkill(Thread->ThreadManager.PID, Thread->ThreadManager.TID, SignalDelegator::SIGNAL_FOR_PAUSE);
+      }
+
+      // A thread that hasn't started yet must never get to run guest code
+      if (Thread->RunningEvents.WaitingToStart.load()) {
+        Thread->RunningEvents.EarlyExit = true;
+        Thread->StartRunning.NotifyAll();
+      }
+    }
+
+    // Nothing ever wakes these threads up again
+    for (auto &Thread : Threads) {
+      if (Thread->ThreadManager.TID == tid) {
+        continue;
+      }
+
+      while (Thread->RunningEvents.Running.load() && !Thread->RunningEvents.ThreadSleeping.load()) {
+        sched_yield();
+      }
+    }
+  }
+
   void Context::Run() {
     // Spin up all the threads
     std::lock_guard<std::mutex> lk(ThreadCreationMutex);
@@ -426,7 +516,8 @@ namespace FEXCore::Context {
           : nullptr),
         decltype(Entry.DebugData)(new Core::DebugData())
       };
-      Thread->LocalIRCache.insert({Addr, std::move(Entry)});
+      // There is no guest code to generate this IR from again
+      Thread->LocalIRCache->Insert(Addr, std::move(Entry), true);
     };
 
     LocalLoader->AddIR(IRHandler);
@@ -472,6 +563,7 @@ namespace FEXCore::Context {
     State->OpDispatcher = std::make_unique<FEXCore::IR::OpDispatchBuilder>(this);
     State->OpDispatcher->SetMultiblock(Config.Multiblock);
     State->LookupCache = std::make_unique<FEXCore::LookupCache>(this);
+    State->LocalIRCache = std::make_unique<FEXCore::LocalIRCache>(this);
     State->FrontendDecoder = std::make_unique<FEXCore::Frontend::Decoder>(this);
     State->PassManager = std::make_unique<FEXCore::IR::PassManager>();
     State->PassManager->RegisterExitHandler([this]() {
@@ -491,6 +583,15 @@ namespace FEXCore::Context {
 
     State->PassManager->RegisterSyscallHandler(SyscallHandler);
 
+    if (CodeStats) {
+      State->CodeStats = std::make_unique<FEXCore::CodeStatsThread>();
+    }
+
+    if (CompileTimeStats) {
+      State->CompileTimes = std::make_unique<FEXCore::CompileTimeStatsThread>(!Config.CompileTimeLog().empty());
+      State->PassManager->EnablePassTimings();
+    }
+
     // Create CPU backend
     switch (Config.Core) {
 #ifdef INTERPRETER_ENABLED
@@ -521,11 +622,20 @@ namespace FEXCore::Context {
 
   FEXCore::Core::InternalThreadState* Context::CreateThread(FEXCore::Core::CPUState *NewThreadState, uint64_t ParentTID) {
     FEXCore::Core::InternalThreadState *Thread{};
+    bool Recycled{};
 
-    // Grab the new thread object
+    // Grab the new thread object, a torn down one still has its compiler set up
     {
       std::lock_guard<std::mutex> lk(ThreadCreationMutex);
-      Thread = Threads.emplace_back(new FEXCore::Core::InternalThreadState{});
+      if (!ThreadPool.empty()) {
+        Thread = ThreadPool.back();
+        ThreadPool.pop_back();
+        Recycled = true;
+      }
+      else {
+        Thread = new FEXCore::Core::InternalThreadState{};
+      }
+      Threads.emplace_back(Thread);
       Thread->ThreadManager.TID = ++ThreadID;
     }
 
@@ -536,12 +646,65 @@ namespace FEXCore::Context {
     // Set up the thread manager state
     Thread->ThreadManager.parent_tid = ParentTID;
 
-    InitializeCompiler(Thread, false);
+    if (!Recycled) {
+      InitializeCompiler(Thread, false);
+    }
     InitializeThreadData(Thread);
 
     return Thread;
   }
 
+  bool Context::RecycleThread(FEXCore::Core::InternalThreadState *Thread) {
+    // The compile service shares state with the thread it compiles for
+    if (!Thread->CPUBackend || Thread->IsCompileService || Thread->CompileService || CoreShuttingDown.load()) {
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(ThreadCreationMutex);
+      if (ThreadPool.size() >= MAX_POOLED_THREADS) {
+        return false;
+      }
+    }
+
+    // Nothing the last guest thread compiled is useful to the next one
+    // The tables go back to their initial size and their pages are handed back to the kernel
+    Thread->LookupCache->ClearCache();
+    Thread->LocalIRCache->Clear();
+    Thread->CPUBackend->ResetCache();
+
+    // The backend and dispatcher have the thread object's address baked in to their code, so the object itself
+    // is reset in place rather than a new one being created around the JIT state
+    auto OpDispatcher = std::move(Thread->OpDispatcher);
+    auto CPUBackend = std::move(Thread->CPUBackend);
+    auto LookupCache = std::move(Thread->LookupCache);
+    auto LocalIRCache = std::move(Thread->LocalIRCache);
+    auto FrontendDecoder = std::move(Thread->FrontendDecoder);
+    auto PassManager = std::move(Thread->PassManager);
+    // Already merged and reset when the thread stopped executing
+    auto CodeStats = std::move(Thread->CodeStats);
+    auto CompileTimes = std::move(Thread->CompileTimes);
+
+    Thread->~InternalThreadState();
+    new (Thread) FEXCore::Core::InternalThreadState{};
+
+    Thread->CTX = this;
+    Thread->OpDispatcher = std::move(OpDispatcher);
+    Thread->CPUBackend = std::move(CPUBackend);
+    Thread->LookupCache = std::move(LookupCache);
+    Thread->LocalIRCache = std::move(LocalIRCache);
+    Thread->FrontendDecoder = std::move(FrontendDecoder);
+    Thread->PassManager = std::move(PassManager);
+    Thread->CodeStats = std::move(CodeStats);
+    Thread->CompileTimes = std::move(CompileTimes);
+
+    {
+      std::lock_guard<std::mutex> lk(ThreadCreationMutex);
+      ThreadPool.emplace_back(Thread);
+    }
+    return true;
+  }
+
   void Context::DestroyThread(FEXCore::Core::InternalThreadState *Thread) {
     // remove new thread object
     {
@@ -558,7 +721,10 @@ namespace FEXCore::Context {
       // To be able to delete a thread from itself, we need to detached the std::thread object
       Thread->ExecutionThread->detach();
     }
-    delete Thread;
+
+    if (!RecycleThread(Thread)) {
+      delete Thread;
+    }
   }
 
   void Context::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
@@ -604,24 +770,63 @@ namespace FEXCore::Context {
       // Erase the shared_ptr
       LiveThread->CompileService.reset();
     }
+
+    if (SampleProfiler) {
+      SampleProfiler->CleanupAfterFork(LiveThread);
+    }
+    if (BlockProfiler) {
+      BlockProfiler->CleanupAfterFork(LiveThread);
+    }
+    if (GuestSymbols) {
+      GuestSymbols->CleanupAfterFork();
+    }
+    if (CodeStats) {
+      CodeStats->CleanupAfterFork(LiveThread);
+    }
+    if (CompileTimeStats) {
+      CompileTimeStats->CleanupAfterFork(LiveThread);
+    }
+    if (ReadOnlyRegions) {
+      ReadOnlyRegions->CleanupAfterFork();
+    }
   }
 
   void Context::AddBlockMapping(FEXCore::Core::InternalThreadState *Thread, uint64_t Address, void *Ptr, uint64_t Start, uint64_t Length) {
     Thread->LookupCache->AddBlockMapping(Address, Ptr, Start, Length);
+    if (Thread->LookupCache->WasEvicted(Address)) {
+      Thread->Stats.BlocksRecompiled.fetch_add(1);
+    }
   }
 
   void Context::ClearCodeCache(FEXCore::Core::InternalThreadState *Thread, bool AlsoClearIRCache) {
+    if (Thread->SampleProfiler) {
+      Thread->SampleProfiler->ClearBlocks();
+    }
     Thread->LookupCache->ClearCache();
+    // Return stack entries point in to the code buffers that are about to be dropped
+    Thread->CurrentFrame->ClearReturnStack();
     Thread->CPUBackend->ClearCache();
     if (Thread->CompileService) {
       Thread->CompileService->ClearCache(Thread);
     }
 
     if (AlsoClearIRCache) {
-      Thread->LocalIRCache.clear();
+      Thread->LocalIRCache->Clear();
     }
   }
 
+  void Context::EvictCodeRange(FEXCore::Core::InternalThreadState *Thread, uintptr_t HostStart, uintptr_t HostEnd) {
+    const auto BlocksEvicted = Thread->LookupCache->EraseHostCodeRange(HostStart, HostEnd);
+    if (Thread->SampleProfiler) {
+      Thread->SampleProfiler->EraseHostCodeRange(HostStart, HostEnd);
+    }
+    // Cheaper to drop everything than to find the entries pointing in to the range
+    Thread->CurrentFrame->ClearReturnStack();
+
+    Thread->Stats.CodeSegmentsEvicted.fetch_add(1);
+    Thread->Stats.BlocksEvicted.fetch_add(BlocksEvicted);
+  }
+
   static void IRDumper(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP, IR::RegisterAllocationData* RA) {
     FILE* f = nullptr;
     bool CloseAfter = false;
@@ -683,8 +888,17 @@ namespace FEXCore::Context {
     uint64_t TotalInstructions {0};
     uint64_t TotalInstructionsLength {0};
 
+    auto CompileTimes = Thread->CompileTimes.get();
+    uint64_t StageStart = CompileTimes ? CompileTimeStatsThread::Now() : 0;
+
     Thread->FrontendDecoder->DecodeInstructionsAtEntry(GuestCode, GuestRIP);
 
+    if (CompileTimes) {
+      const auto Now = CompileTimeStatsThread::Now();
+      CompileTimes->AddTime(Thread, CompileStage::Decode, Now - StageStart);
+      StageStart = Now;
+    }
+
     auto CodeBlocks = Thread->FrontendDecoder->GetDecodedBlocks();
 
     Thread->OpDispatcher->BeginFunction(GuestRIP, CodeBlocks);
@@ -748,9 +962,17 @@ namespace FEXCore::Context {
             BlockInstructionsLength += DecodedInfo->InstSize;
             TotalInstructionsLength += DecodedInfo->InstSize;
             ++TotalInstructions;
+
+            if (Thread->CodeStats) {
+              Thread->CodeStats->RecordGuestInstruction(TableInfo->Name ?: "UND");
+            }
           }
         }
         else {
+          if (Thread->CodeStats) {
+            Thread->CodeStats->RecordGuestInstruction("Invalid");
+          }
+
           // Invalid instruction
           Thread->OpDispatcher->InvalidOp(DecodedInfo);
           Thread->OpDispatcher->_ExitFunction(Thread->OpDispatcher->_EntrypointOffset(Block.Entry - GuestRIP, GPRSize));
@@ -780,6 +1002,10 @@ namespace FEXCore::Context {
 
     Thread->OpDispatcher->Finalize();
 
+    if (CompileTimes) {
+      CompileTimes->AddTime(Thread, CompileStage::Dispatch, CompileTimeStatsThread::Now() - StageStart);
+    }
+
     // Debug
     {
       if (Thread->CTX->Config.DumpIR() != "no") {
@@ -791,8 +1017,28 @@ namespace FEXCore::Context {
       }
     }
 
+    if (Thread->CodeStats) {
+      auto IR = Thread->OpDispatcher->ViewIR();
+      Thread->CodeStats->RecordIR(&IR, false);
+    }
+
+    StageStart = CompileTimes ? CompileTimeStatsThread::Now() : 0;
+    const uint64_t RAStart = CompileTimes ? Thread->PassManager->GetPassTime("RA") : 0;
+
     // Run the passmanager over the IR from the dispatcher
-    Thread->PassManager->Run(Thread->OpDispatcher.get());
+    const bool PassesChanged = Thread->PassManager->Run(Thread->OpDispatcher.get());
+
+    if (CompileTimes) {
+      const uint64_t RATime = Thread->PassManager->GetPassTime("RA") - RAStart;
+      CompileTimes->AddTime(Thread, CompileStage::Passes, CompileTimeStatsThread::Now() - StageStart - RATime);
+      CompileTimes->AddTime(Thread, CompileStage::RA, RATime);
+    }
+
+    if (Thread->CodeStats) {
+      auto IR = Thread->OpDispatcher->ViewIR();
+      Thread->CodeStats->RecordIR(&IR, true);
+      Thread->CodeStats->RecordPassResult(PassesChanged);
+    }
 
     // Debug
     {
@@ -820,6 +1066,7 @@ namespace FEXCore::Context {
       .TotalInstructionsLength = TotalInstructionsLength,
       .StartAddr = Thread->FrontendDecoder->DecodedMinAddress,
       .Length = Thread->FrontendDecoder->DecodedMaxAddress - Thread->FrontendDecoder->DecodedMinAddress,
+      .ReadOnlyPages = Thread->OpDispatcher->GetReadOnlyPages(),
     };
   }
 
@@ -831,17 +1078,20 @@ namespace FEXCore::Context {
     uint64_t StartAddr {};
     uint64_t Length {};
 
-    // Do we already have this in the IR cache?
-    auto LocalEntry = Thread->LocalIRCache.find(GuestRIP);
+    auto CompileTimes = Thread->CompileTimes.get();
+    if (CompileTimes) {
+      CompileTimes->BeginBlock(GuestRIP);
+    }
 
-    if (LocalEntry != Thread->LocalIRCache.end()) {
+    // Do we already have this in the IR cache?
+    if (auto LocalEntry = Thread->LocalIRCache->Find(GuestRIP)) {
       // Entry already exists
       // pull in the data
-      IRList = LocalEntry->second.IR.get();
-      DebugData = LocalEntry->second.DebugData.get();
-      RAData = LocalEntry->second.RAData.get();
-      StartAddr = LocalEntry->second.StartAddr;
-      Length = LocalEntry->second.Length;
+      IRList = LocalEntry->IR.get();
+      DebugData = LocalEntry->DebugData.get();
+      RAData = LocalEntry->RAData.get();
+      StartAddr = LocalEntry->StartAddr;
+      Length = LocalEntry->Length;
 
       GeneratedIR = false;
     }
@@ -862,7 +1112,7 @@ namespace FEXCore::Context {
 
     if (IRList == nullptr) {
       // Generate IR + Meta Info
-      auto [IRCopy, RACopy, TotalInstructions, TotalInstructionsLength, _StartAddr, _Length] = GenerateIR(Thread, GuestRIP);
+      auto [IRCopy, RACopy, TotalInstructions, TotalInstructionsLength, _StartAddr, _Length, ReadOnlyPages] = GenerateIR(Thread, GuestRIP);
 
       // Setup pointers to internal structures
       IRList = IRCopy;
@@ -874,6 +1124,7 @@ namespace FEXCore::Context {
       // Initialize metadata
       DebugData->GuestCodeSize = TotalInstructionsLength;
       DebugData->GuestInstructionCount = TotalInstructions;
+      DebugData->ReadOnlyPages = std::move(ReadOnlyPages);
 
       // Increment stats
       Thread->Stats.BlocksCompiled.fetch_add(1);
@@ -883,11 +1134,25 @@ namespace FEXCore::Context {
     }
 
     if (IRList == nullptr) {
+      if (CompileTimes) {
+        // Frontend time was still spent, keep it in the records
+        CompileTimes->EndBlock(0);
+      }
       return {};
     }
+
+    const uint64_t CodegenStart = CompileTimes ? CompileTimeStatsThread::Now() : 0;
+
     // Attempt to get the CPU backend to compile this code
+    auto CompiledCode = Thread->CPUBackend->CompileCode(GuestRIP, IRList, DebugData, RAData);
+
+    if (CompileTimes) {
+      CompileTimes->AddTime(Thread, CompileStage::Codegen, CompileTimeStatsThread::Now() - CodegenStart);
+      CompileTimes->EndBlock(DebugData ? DebugData->GuestInstructionCount : 0);
+    }
+
     return {
-      .CompiledCode = Thread->CPUBackend->CompileCode(GuestRIP, IRList, DebugData, RAData),
+      .CompiledCode = CompiledCode,
       .IRData = IRList,
       .DebugData = DebugData,
       .RAData = RAData,
@@ -911,12 +1176,21 @@ namespace FEXCore::Context {
   uintptr_t Context::CompileBlock(FEXCore::Core::CpuStateFrame *Frame, uint64_t GuestRIP) {
     auto Thread = Frame->Thread;
 
+    // Backends come through here when they run out of L1 miss budget
+    Thread->LookupCache->CheckL1Size();
+
     // Is the code in the cache?
     // The backends only check L1 and L2, not L3
     if (auto HostCode = Thread->LookupCache->FindBlock(GuestRIP)) {
       return HostCode;
     }
 
+    auto ThreadProfiler = Thread->BlockProfiler.get();
+    if (ThreadProfiler) {
+      // Compile time isn't the calling block's
+      ThreadProfiler->Pause();
+    }
+
     void *CodePtr {};
     FEXCore::IR::IRListView *IRList {};
     FEXCore::Core::DebugData *DebugData {};
@@ -963,10 +1237,20 @@ namespace FEXCore::Context {
     if (CodePtr == nullptr) {
       if (DecrementRefCount)
         --Thread->CompileBlockReentrantRefCount;
+      if (ThreadProfiler) {
+        ThreadProfiler->Resume();
+      }
       return 0;
     }
 
     // The core managed to compile the code.
+    if (Thread->SampleProfiler && DebugData) {
+      Thread->SampleProfiler->AddBlock(reinterpret_cast<uintptr_t>(CodePtr), DebugData->HostCodeSize, GuestRIP);
+    }
+    if (ThreadProfiler && DebugData) {
+      ThreadProfiler->SetBlockInfo(GuestRIP, DebugData->GuestCodeSize, DebugData->GuestInstructionCount, DebugData->HostCodeSize);
+    }
+
     if (Config.BlockJITNaming()) {
       if (DebugData) {
         if (DebugData->Subblocks.size()) {
@@ -991,6 +1275,9 @@ namespace FEXCore::Context {
         GeneratedIR,
         DecrementRefCount)) {
       // Early exit
+      if (ThreadProfiler) {
+        ThreadProfiler->Resume();
+      }
       return (uintptr_t)CodePtr;
     }
 
@@ -1000,6 +1287,16 @@ namespace FEXCore::Context {
     // Insert to lookup cache
     AddBlockMapping(Thread, GuestRIP, CodePtr, StartAddr, Length);
 
+    if (DebugData) {
+      // Loads folded from read-only memory go stale the same way the code does
+      for (auto Page : DebugData->ReadOnlyPages) {
+        Thread->LookupCache->CodePages[Page].push_back(GuestRIP);
+      }
+    }
+
+    if (ThreadProfiler) {
+      ThreadProfiler->Resume();
+    }
     return (uintptr_t)CodePtr;
   }
 
@@ -1011,6 +1308,13 @@ namespace FEXCore::Context {
 
     ++IdleWaitRefCount;
 
+    if (SampleProfiler) {
+      SampleProfiler->StartThread(Thread);
+    }
+    if (BlockProfiler) {
+      BlockProfiler->StartThread(Thread);
+    }
+
     // Now notify the thread that we are initialized
     Thread->ThreadWaiting.NotifyAll();
 
@@ -1042,6 +1346,20 @@ namespace FEXCore::Context {
       }
     }
 
+    if (SampleProfiler) {
+      // Before dropping the ref count so the samples are merged by the time RunUntilExit returns
+      SampleProfiler->StopThread(Thread);
+    }
+    if (BlockProfiler) {
+      BlockProfiler->StopThread(Thread);
+    }
+    if (CodeStats) {
+      CodeStats->MergeThread(Thread);
+    }
+    if (CompileTimeStats) {
+      CompileTimeStats->MergeThread(Thread);
+    }
+
     --IdleWaitRefCount;
     IdleWaitCV.notify_all();
 
@@ -1068,7 +1386,7 @@ namespace FEXCore::Context {
   }
 
   void Context::RemoveCodeEntry(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP) {
-    Thread->LocalIRCache.erase(GuestRIP);
+    Thread->LocalIRCache->Erase(GuestRIP);
     Thread->LookupCache->Erase(GuestRIP);
   }
 
@@ -1095,12 +1413,12 @@ namespace FEXCore::Context {
   }
 
   bool Context::GetDebugDataForRIP(uint64_t RIP, FEXCore::Core::DebugData *Data) {
-    auto it = ParentThread->LocalIRCache.find(RIP);
-    if (it == ParentThread->LocalIRCache.end()) {
+    auto LocalEntry = ParentThread->LocalIRCache->Find(RIP);
+    if (!LocalEntry) {
       return false;
     }
 
-    memcpy(Data, it->second.DebugData.get(), sizeof(FEXCore::Core::DebugData));
+    memcpy(Data, LocalEntry->DebugData.get(), sizeof(FEXCore::Core::DebugData));
     return true;
   }
 
@@ -1115,19 +1433,56 @@ namespace FEXCore::Context {
   }
 
   uint64_t HandleSyscall(FEXCore::HLE::SyscallHandler *Handler, FEXCore::Core::CpuStateFrame *Frame, FEXCore::HLE::SyscallArguments *Args) {
+    auto ThreadProfiler = Frame->Thread->BlockProfiler.get();
+    if (ThreadProfiler) {
+      // Time in the kernel and the syscall handler isn't the block's
+      ThreadProfiler->Pause();
+    }
+
     uint64_t Result{};
     Result = Handler->HandleSyscall(Frame, Args);
+
+    if (ThreadProfiler) {
+      ThreadProfiler->Resume();
+    }
     return Result;
   }
 
   void Context::AddNamedRegion(uintptr_t Base, uintptr_t Size, uintptr_t Offset, const std::string &filename) {
     IRCaptureCache.AddNamedRegion(Base, Size, Offset, filename);
+    if (GuestSymbols) {
+      GuestSymbols->AddNamedRegion(Base, Size, Offset, filename);
+    }
   }
 
   void Context::RemoveNamedRegion(uintptr_t Base, uintptr_t Size) {
     IRCaptureCache.RemoveNamedRegion(Base, Size);
   }
 
+  void Context::AddGuestMapping(uintptr_t Base, uintptr_t Size, bool PrivateFile, int Prot) {
+    if (ReadOnlyRegions) {
+      ReadOnlyRegions->AddMapping(Base, Size, PrivateFile, Prot);
+    }
+  }
+
+  void Context::RemoveGuestMapping(uintptr_t Base, uintptr_t Size) {
+    if (ReadOnlyRegions) {
+      ReadOnlyRegions->RemoveMapping(Base, Size);
+    }
+  }
+
+  void Context::ProtectGuestMapping(uintptr_t Base, uintptr_t Size, int Prot) {
+    if (ReadOnlyRegions) {
+      ReadOnlyRegions->ProtectMapping(Base, Size, Prot);
+    }
+  }
+
+  void Context::SetGuestSymbolizer(GuestSymbolizer Symbolizer) {
+    if (GuestSymbols) {
+      GuestSymbols->SetSymbolizer(std::move(Symbolizer));
+    }
+  }
+
   void ConfigureAOTGen(FEXCore::Core::InternalThreadState *Thread, std::set<uint64_t> *ExternalBranches, uint64_t SectionMaxAddress) {
     Thread->FrontendDecoder->SetExternalBranches(ExternalBranches);
     Thread->FrontendDecoder->SetSectionMaxAddress(SectionMaxAddress);
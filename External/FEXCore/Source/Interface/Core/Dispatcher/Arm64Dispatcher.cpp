@@ -62,6 +62,7 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
   Literal l_CompileBlock {GetCompileBlockPtr()};
   Literal l_ExitFunctionLink {config.ExitFunctionLink};
   Literal l_ExitFunctionLinkThis {config.ExitFunctionLinkThis};
+  Literal l_InlineCacheMiss {config.InlineCacheMiss};
 
   // Push all the register we need to save
   PushCalleeSavedRegisters();
@@ -101,7 +102,8 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
   // L1 Cache
   ldr(x0, &l_L1Ptr);
 
-  and_(x3, RipReg, LookupCache::L1_ENTRIES_MASK);
+  ldr(x3, MemOperand(x0, LookupCache::L1_MASK_OFFSET));
+  and_(x3, RipReg, x3);
   add(x0, x0, Operand(x3, Shift::LSL, 4));
   ldp(x3, x0, MemOperand(x0));
   cmp(x0, RipReg);
@@ -161,7 +163,14 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
       // update L1 cache
       ldr(x0, &l_L1Ptr);
 
-      and_(x1, RipReg, LookupCache::L1_ENTRIES_MASK);
+      // Charge the L1 miss, the block compiler checks if the L1 needs to grow once it runs out
+      ldr(x1, MemOperand(x0, LookupCache::L1_MISS_BUDGET_OFFSET));
+      subs(x1, x1, 1);
+      str(x1, MemOperand(x0, LookupCache::L1_MISS_BUDGET_OFFSET));
+      b(&NoBlock, Condition::mi);
+
+      ldr(x1, MemOperand(x0, LookupCache::L1_MASK_OFFSET));
+      and_(x1, RipReg, x1);
       add(x0, x0, Operand(x1, Shift::LSL, 4));
       stp(x3, x2, MemOperand(x0));
 
@@ -263,6 +272,54 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
     br(x0);
   }
 
+  {
+    InlineCacheMissAddress = GetCursorAddress<uint64_t>();
+    // x0 is the inline cache and x1 the guest RIP, set at the block end
+    stp(x0, x1, MemOperand(sp, -16, PreIndex));
+
+    if (SRAEnabled)
+      SpillStaticRegs();
+
+    if (SignalSafeCompile) {
+      // Same as the linker, the mask lives below the saved arguments
+      LoadConstant(x0, ~0ULL);
+      stp(x0, x0, MemOperand(sp, -16, PreIndex));
+      LoadConstant(x0, SIG_SETMASK);
+      add(x1, sp, 0);
+      add(x2, sp, 0);
+      LoadConstant(x3, 8);
+      LoadConstant(x8, SYS_rt_sigprocmask);
+      svc(0);
+    }
+
+    ldr(x0, &l_ExitFunctionLinkThis);
+    mov(x1, STATE);
+    ldp(x2, x3, MemOperand(sp, SignalSafeCompile ? 16 : 0, Offset));
+
+    ldr(x4, &l_InlineCacheMiss);
+    blr(x4);
+
+    if (SignalSafeCompile) {
+      mov(x4, x0);
+      LoadConstant(x0, SIG_SETMASK);
+      add(x1, sp, 0);
+      LoadConstant(x2, 0);
+      LoadConstant(x3, 8);
+      LoadConstant(x8, SYS_rt_sigprocmask);
+      svc(0);
+
+      add(sp, sp, 16);
+
+      mov(x0, x4);
+    }
+
+    add(sp, sp, 16);
+
+    if (SRAEnabled)
+      FillStaticRegs();
+    br(x0);
+  }
+
   // Need to create the block
   {
     bind(&NoBlock);
@@ -446,6 +503,7 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
   place(&l_CompileBlock);
   place(&l_ExitFunctionLink);
   place(&l_ExitFunctionLinkThis);
+  place(&l_InlineCacheMiss);
 
 
   FinalizeCode();
@@ -62,6 +62,9 @@ ArchHelpers::Context::ContextBackup* Dispatcher::StoreThreadState(int Signal, vo
   // Retain the action pointer so we can see it when we return
   Context->Signal = Signal;
 
+  // The guest mask needs to come back on sigreturn as well
+  Context->GuestSignalMask = CTX->SignalDelegation->GetGuestSignalMask();
+
   // Save guest state
   // We can't guarantee if registers are in context or host GPRs
   // So we need to save everything
@@ -108,6 +111,9 @@ void Dispatcher::RestoreThreadState(void *ucontext) {
   // Now restore host state
   ArchHelpers::Context::RestoreContext(ucontext, Context);
 
+  // The guest can change the mask it returns to through the ucontext
+  uint64_t GuestSignalMask = Context->GuestSignalMask;
+
   if (Context->UContextLocation) {
     auto Frame = ThreadState->CurrentFrame;
 
@@ -119,6 +125,7 @@ void Dispatcher::RestoreThreadState(void *ucontext) {
 
     if (!(Context->Flags & ArchHelpers::Context::ContextFlags::CONTEXT_FLAG_32BIT)) {
       auto *guest_uctx = reinterpret_cast<FEXCore::x86_64::ucontext_t*>(Context->UContextLocation);
+      GuestSignalMask = guest_uctx->uc_sigmask.val[0];
       [[maybe_unused]] auto *guest_siginfo = reinterpret_cast<siginfo_t*>(Context->SigInfoLocation);
 
       // If the guest modified the RIP then we need to take special precautions here
@@ -178,6 +185,7 @@ void Dispatcher::RestoreThreadState(void *ucontext) {
     }
     else {
       auto *guest_uctx = reinterpret_cast<FEXCore::x86::ucontext_t*>(Context->UContextLocation);
+      GuestSignalMask = guest_uctx->uc_sigmask.val[0];
       [[maybe_unused]] auto *guest_siginfo = reinterpret_cast<FEXCore::x86::siginfo_t*>(Context->SigInfoLocation);
       // If the guest modified the RIP then we need to take special precautions here
       if (Context->OriginalRIP != guest_uctx->uc_mcontext.gregs[FEXCore::x86::FEX_REG_EIP] ||
@@ -240,6 +248,8 @@ void Dispatcher::RestoreThreadState(void *ucontext) {
       }
     }
   }
+
+  CTX->SignalDelegation->RestoreGuestSignalMask(GuestSignalMask, ucontext);
 }
 
 static uint32_t ConvertSignalToTrapNo(int Signal, siginfo_t *HostSigInfo) {
@@ -464,6 +474,9 @@ bool Dispatcher::HandleGuestSignal(int Signal, void *info, void *ucontext, Guest
       guest_uctx->uc_stack.ss_sp = GuestStack->ss_sp;
       guest_uctx->uc_stack.ss_size = GuestStack->ss_size;
 
+      // Mask the guest had before the signal
+      guest_uctx->uc_sigmask.val[0] = ContextBackup->GuestSignalMask;
+
       Frame->State.gregs[X86State::REG_RSI] = SigInfoLocation;
       Frame->State.gregs[X86State::REG_RDX] = UContextLocation;
     }
@@ -554,6 +567,9 @@ bool Dispatcher::HandleGuestSignal(int Signal, void *info, void *ucontext, Guest
       guest_uctx->uc_stack.ss_sp = static_cast<uint32_t>(reinterpret_cast<uint64_t>(GuestStack->ss_sp));
       guest_uctx->uc_stack.ss_size = GuestStack->ss_size;
 
+      // Mask the guest had before the signal
+      guest_uctx->uc_sigmask.val[0] = ContextBackup->GuestSignalMask;
+
       // These three elements are in every siginfo
       guest_siginfo->si_signo = HostSigInfo->si_signo;
       guest_siginfo->si_errno = HostSigInfo->si_errno;
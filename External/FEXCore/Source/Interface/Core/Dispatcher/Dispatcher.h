@@ -27,6 +27,7 @@ struct DispatcherConfig {
   bool ExecuteBlocksWithCall = false;
   uintptr_t ExitFunctionLink = 0;
   uintptr_t ExitFunctionLinkThis = 0;
+  uintptr_t InlineCacheMiss = 0;
   bool StaticRegisterAssignment = false;
 };
 
@@ -47,6 +48,7 @@ public:
   uint64_t ThreadPauseHandlerAddress{};
   uint64_t ThreadPauseHandlerAddressSpillSRA{};
   uint64_t ExitFunctionLinkerAddress{};
+  uint64_t InlineCacheMissAddress{};
   uint64_t SignalHandlerReturnAddress{};
   uint64_t UnimplementedInstructionAddress{};
   uint64_t OverflowExceptionInstructionAddress{};
@@ -55,6 +57,17 @@ public:
 
   /**  @} */
 
+  /**
+   * @brief Targets remembered at each block exit with a non-constant RIP
+   *
+   * The cache is data in the code buffer: `{HostCode, GuestRIP}` per entry followed by the miss target.
+   * Empty entries and the miss target point at `InlineCacheMissAddress`. Once every entry is used the miss
+   * target points right after itself, where the L1 cache lookup of the exit lives.
+   */
+  static constexpr size_t INLINE_CACHE_ENTRIES = 2;
+  // RIP of empty entries, non-canonical so no guest branch can ever match it
+  static constexpr uint64_t INLINE_CACHE_EMPTY_RIP = 0x8000'0000'0000'0000ULL;
+
   uint32_t SignalHandlerRefCounter{};
   struct SynchronousFaultDataStruct {
     bool FaultToTopAndGeneratedException{};
@@ -98,7 +98,7 @@ X86Dispatcher::X86Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::Inte
     mov(r13, Thread->LookupCache->GetL1Pointer());
     mov(rax, rdx);
 
-    and_(rax, LookupCache::L1_ENTRIES_MASK);
+    and_(rax, qword[r13 + LookupCache::L1_MASK_OFFSET]);
     shl(rax, 4);
     cmp(qword[r13 + rax + 8], rdx);
     jne(FullLookup);
@@ -144,8 +144,13 @@ X86Dispatcher::X86Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::Inte
     // Update L1
 
     mov(r13, Thread->LookupCache->GetL1Pointer());
+
+    // Charge the L1 miss, the block compiler checks if the L1 needs to grow once it runs out
+    sub(qword[r13 + LookupCache::L1_MISS_BUDGET_OFFSET], 1);
+    js(NoBlock);
+
     mov(rcx, rdx);
-    and_(rcx, LookupCache::L1_ENTRIES_MASK);
+    and_(rcx, qword[r13 + LookupCache::L1_MASK_OFFSET]);
     shl(rcx, 1);
     mov(qword[r13 + rcx*8 + 8], rdx);
     mov(qword[r13 + rcx*8 + 0], rax);
@@ -220,6 +225,19 @@ X86Dispatcher::X86Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::Inte
     jmp(rax);
   }
 
+  {
+    InlineCacheMissAddress = getCurr<uint64_t>();
+    // {rdi, rsi, rdx, rcx}
+    mov(rdi, config.ExitFunctionLinkThis);
+    mov(rsi, STATE);
+    mov(rdx, rcx); // rcx is the inline cache and rax the guest RIP, set at the block end
+    mov(rcx, rax);
+
+    mov(rax, config.InlineCacheMiss);
+    call(rax);
+    jmp(rax);
+  }
+
   {
     // Pause handler
     ThreadPauseHandlerAddress = getCurr<uint64_t>();
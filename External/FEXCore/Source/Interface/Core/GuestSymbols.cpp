@@ -0,0 +1,59 @@
+/*
+$info$
+tags: glue|profiling
+desc: Names guest code addresses through the mapped files for profiler reports
+$end_info$
+*/
+
+#include "Interface/Core/GuestSymbols.h"
+
+#include <filesystem>
+#include <fmt/format.h>
+
+namespace FEXCore {
+  void GuestSymbols::AddNamedRegion(uintptr_t Base, uintptr_t Size, uintptr_t Offset, std::string const &Filename) {
+    std::lock_guard lk(RegionMutex);
+    Regions.insert_or_assign(Base, Region{Size, Offset, Filename});
+  }
+
+  std::string GuestSymbols::GetName(uint64_t RIP, bool IsReturnAddress) {
+    const uint64_t LookupRIP = IsReturnAddress ? RIP - 1 : RIP;
+
+    std::lock_guard lk(RegionMutex);
+
+    auto Cached = Names.find(LookupRIP);
+    if (Cached != Names.end()) {
+      return Cached->second;
+    }
+
+    std::string Name = fmt::format("0x{:x}", RIP);
+
+    // Later mappings in to a reserved range are more specific than the reservation
+    auto Region = Regions.upper_bound(LookupRIP);
+    if (Region != Regions.begin()) {
+      --Region;
+      if (LookupRIP < Region->first + Region->second.Size) {
+        const uint64_t FileOffset = LookupRIP - Region->first + Region->second.Offset;
+        std::string Symbol;
+        if (Symbolizer) {
+          Symbol = Symbolizer(Region->second.Filename, FileOffset);
+        }
+
+        if (!Symbol.empty()) {
+          Name = std::move(Symbol);
+        }
+        else {
+          Name = fmt::format("{}+0x{:x}", std::filesystem::path(Region->second.Filename).filename().string(), FileOffset);
+        }
+      }
+    }
+
+    Names.emplace(LookupRIP, Name);
+    return Name;
+  }
+
+  void GuestSymbols::CleanupAfterFork() {
+    // Another thread may have held this at the time of the fork
+    new (&RegionMutex) std::mutex{};
+  }
+}
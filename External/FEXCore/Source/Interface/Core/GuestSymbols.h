@@ -0,0 +1,52 @@
+#pragma once
+
+#include <FEXCore/Core/Context.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace FEXCore {
+/**
+ * @brief Names guest code addresses for the profilers' reports
+ *
+ * Remembers every file mapping the frontend told us about and asks the frontend's symbolizer
+ * to name an offset in to the file. Mappings are never forgotten so code that was unmapped
+ * before exit can still be named.
+ */
+class GuestSymbols final {
+public:
+  void AddNamedRegion(uintptr_t Base, uintptr_t Size, uintptr_t Offset, std::string const &Filename);
+
+  void SetSymbolizer(FEXCore::Context::GuestSymbolizer Symbolizer) {
+    this->Symbolizer = std::move(Symbolizer);
+  }
+
+  /**
+   * @brief Names a guest address
+   *
+   * Falls back to `<file>+0x<offset>` without a symbol, or the bare address without a mapping.
+   *
+   * @param IsReturnAddress Names the call before RIP, which might be in a different function
+   */
+  std::string GetName(uint64_t RIP, bool IsReturnAddress = false);
+
+  void CleanupAfterFork();
+
+private:
+  struct Region {
+    uintptr_t Size;
+    uintptr_t Offset;
+    std::string Filename;
+  };
+
+  std::mutex RegionMutex;
+  std::map<uintptr_t, Region> Regions;
+
+  FEXCore::Context::GuestSymbolizer Symbolizer;
+  // Keyed by the looked up address
+  std::unordered_map<uint64_t, std::string> Names;
+};
+}
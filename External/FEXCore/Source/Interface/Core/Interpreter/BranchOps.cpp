@@ -25,18 +25,6 @@ static void SignalReturn(FEXCore::Core::InternalThreadState *Thread) {
 }
 
 #define DEF_OP(x) void InterpreterOps::Op_##x(IR::IROp_Header *IROp, IROpData *Data, IR::NodeID Node)
-DEF_OP(GuestCallDirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestCallIndirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestReturn) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
 DEF_OP(SignalReturn) {
   SignalReturn(Data->State);
 }
@@ -59,6 +47,15 @@ DEF_OP(ExitFunction) {
   Data->BlockResults.Quit = true;
 }
 
+DEF_OP(GuestCall) {
+  // No return stack in the interpreter, the call is just a block exit
+  Op_ExitFunction(IROp, Data, Node);
+}
+
+DEF_OP(GuestReturn) {
+  Op_ExitFunction(IROp, Data, Node);
+}
+
 DEF_OP(Jump) {
   auto Op = IROp->C<IR::IROp_Jump>();
   uintptr_t ListBegin = Data->CurrentIR->GetListData();
@@ -4,6 +4,7 @@
 #include "Interface/Core/ArchHelpers/MContext.h"
 #include "Interface/Core/Dispatcher/Dispatcher.h"
 #include "Interface/Core/Interpreter/InterpreterClass.h"
+#include "Interface/Core/LocalIRCache.h"
 #include <FEXCore/Config/Config.h>
 #include <FEXCore/Core/CoreState.h>
 #include <FEXCore/Core/SignalDelegator.h>
@@ -30,9 +31,14 @@ class CPUBackend;
 static void InterpreterExecution(FEXCore::Core::CpuStateFrame *Frame) {
   auto Thread = Frame->Thread;
 
-  auto LocalEntry = Thread->LocalIRCache.find(Thread->CurrentFrame->State.rip);
+  // The interpreter always retains the IR of every block it has compiled
+  auto LocalEntry = Thread->LocalIRCache->Find(Thread->CurrentFrame->State.rip);
 
-  InterpreterOps::InterpretIR(Thread, Thread->CurrentFrame->State.rip, LocalEntry->second.IR.get(), LocalEntry->second.DebugData.get());
+  if (!LocalEntry->InterpreterProgram) {
+    LocalEntry->InterpreterProgram.reset(InterpreterOps::CreateProgram(LocalEntry->IR.get()));
+  }
+
+  InterpreterOps::InterpretIR(Thread, Thread->CurrentFrame->State.rip, LocalEntry->IR.get(), LocalEntry->InterpreterProgram.get(), LocalEntry->DebugData.get());
 }
 
 InterpreterCore::InterpreterCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalThreadState *Thread, bool CompileThread)
@@ -35,7 +35,6 @@
 
 namespace FEXCore::CPU {
 
-using OpHandler = void (*)(IR::IROp_Header *IROp, InterpreterOps::IROpData *Data, IR::NodeID Node);
 using OpHandlerArray = std::array<OpHandler, IR::IROps::OP_LAST + 1>;
 
 constexpr OpHandlerArray InterpreterOpHandlers = [] {
@@ -112,8 +111,7 @@ constexpr OpHandlerArray InterpreterOpHandlers = [] {
   REGISTER_OP(ATOMICFETCHNEG,         AtomicFetchNeg);
 
   // Branch ops
-  REGISTER_OP(GUESTCALLDIRECT,        GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT,      GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,              GuestCall);
   REGISTER_OP(GUESTRETURN,            GuestReturn);
   REGISTER_OP(SIGNALRETURN,           SignalReturn);
   REGISTER_OP(CALLBACKRETURN,         CallbackReturn);
@@ -322,7 +320,61 @@ void InterpreterOps::Op_Unhandled(FEXCore::IR::IROp_Header *IROp, IROpData *Data
 void InterpreterOps::Op_NoOp(FEXCore::IR::IROp_Header *IROp, IROpData *Data, IR::NodeID Node) {
 }
 
-void InterpreterOps::InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, FEXCore::Core::DebugData *DebugData) {
+void InterpreterProgramDeleter::operator()(InterpreterProgram *Program) const {
+  delete Program;
+}
+
+uint32_t InterpreterProgram::GetBlockStart(IR::NodeID Block) const {
+  auto it = std::lower_bound(BlockStarts.begin(), BlockStarts.end(), Block, [](auto const &Start, IR::NodeID Block) {
+    return Start.first < Block;
+  });
+  LOGMAN_THROW_A_FMT(it != BlockStarts.end() && it->first == Block, "Jump to a node that isn't a code block");
+  return it->second;
+}
+
+InterpreterProgram *InterpreterOps::CreateProgram(FEXCore::IR::IRListView const *CurrentIR) {
+  using namespace FEXCore::IR;
+
+  auto Program = new InterpreterProgram{};
+  Program->Ops.reserve(CurrentIR->GetSSACount());
+  Program->SSASize = CurrentIR->GetSSACount() * 16;
+
+  for (auto [BlockNode, BlockHeader] : CurrentIR->GetBlocks()) {
+    auto BlockIROp = BlockHeader->CW<IROp_CodeBlock>();
+    LOGMAN_THROW_A_FMT(BlockIROp->Header.Op == IR::OP_CODEBLOCK, "IR type failed to be a code block");
+
+    Program->BlockStarts.emplace_back(CurrentIR->GetID(BlockNode), Program->Ops.size());
+
+    for (auto [CodeNode, IROp] : CurrentIR->GetCode(BlockNode)) {
+      const bool CanLeaveBlock =
+        IROp->Op == OP_EXITFUNCTION ||
+        IROp->Op == OP_GUESTCALL ||
+        IROp->Op == OP_GUESTRETURN ||
+        IROp->Op == OP_JUMP ||
+        IROp->Op == OP_CONDJUMP;
+
+      Program->Ops.emplace_back(InterpreterProgram::Op {
+        InterpreterOpHandlers[IROp->Op],
+        IROp,
+        CurrentIR->GetID(CodeNode),
+        CanLeaveBlock,
+      });
+    }
+
+    if (Program->Ops.size() > Program->BlockStarts.back().second) {
+      Program->Ops.back().EndsBlock = true;
+    }
+  }
+
+  std::sort(Program->BlockStarts.begin(), Program->BlockStarts.end(), [](auto const &lhs, auto const &rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  Program->Ops.shrink_to_fit();
+  return Program;
+}
+
+void InterpreterOps::InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, InterpreterProgram const *Program, FEXCore::Core::DebugData *DebugData) {
   volatile void *StackEntry = alloca(0);
 
   // Debug data is only passed in debug builds
@@ -331,64 +383,49 @@ void InterpreterOps::InterpretIR(FEXCore::Core::InternalThreadState *Thread, uin
   Thread->Stats.InstructionsExecuted.fetch_add(DebugData->GuestInstructionCount);
   #endif
 
-  uintptr_t ListSize = CurrentIR->GetSSACount();
-
   static_assert(sizeof(FEXCore::IR::IROp_Header) == 4);
   static_assert(sizeof(FEXCore::IR::OrderedNode) == 16);
 
-  auto BlockEnd = CurrentIR->GetBlocks().end();
-
   InterpreterOps::IROpData OpData{};
   OpData.State = Thread;
-  OpData.SSAData = alloca(ListSize * 16);
+  OpData.SSAData = alloca(Program->SSASize);
   OpData.CurrentEntry = Entry;
   OpData.CurrentIR = CurrentIR;
   OpData.StackEntry = StackEntry;
-  OpData.BlockIterator = CurrentIR->GetBlocks().begin();
 
   // Clear them all to zero. Required for Zero-extend semantics
-  memset(OpData.SSAData, 0, ListSize * 16);
+  // Handlers only write the width of their result and wider readers rely on the rest of the slot being zero
+  memset(OpData.SSAData, 0, Program->SSASize);
 
-  while (1) {
-    using namespace FEXCore::IR;
-    auto [BlockNode, BlockHeader] = OpData.BlockIterator();
-    auto BlockIROp = BlockHeader->CW<IROp_CodeBlock>();
-    LOGMAN_THROW_A_FMT(BlockIROp->Header.Op == IR::OP_CODEBLOCK, "IR type failed to be a code block");
-
-    // Reset the block results per block
-    memset(&OpData.BlockResults, 0, sizeof(OpData.BlockResults));
+  auto const *Ops = Program->Ops.data();
+  const size_t OpCount = Program->Ops.size();
+  size_t Index = 0;
 
-    auto CodeBegin = CurrentIR->at(BlockIROp->Begin);
-    auto CodeLast = CurrentIR->at(BlockIROp->Last);
-
-    for (auto [CodeNode, IROp] : CurrentIR->GetCode(BlockNode)) {
-      const auto ID = CurrentIR->GetID(CodeNode);
-      const uint32_t Op = IROp->Op;
+  while (Index < OpCount) {
+    auto const &Op = Ops[Index];
+    Op.Handler(Op.IROp, &OpData, Op.Node);
 
-      // Execute handler
-      OpHandler Handler = InterpreterOpHandlers[Op];
-
-      Handler(IROp, &OpData, ID);
-
-      if (OpData.BlockResults.Quit ||
-          OpData.BlockResults.Redo ||
-          CodeBegin == CodeLast) {
-        break;
-      }
+    if (!Op.EndsBlock) {
+      ++Index;
+      continue;
+    }
 
-      ++CodeBegin;
+    // If we have set to early exit then leave
+    if (OpData.BlockResults.Quit) {
+      break;
     }
 
-    // Iterator will have been set, go again
     if (OpData.BlockResults.Redo) {
+      // Iterator will have been set to the target block, go again from there
+      OpData.BlockResults.Redo = false;
+      Index = Program->GetBlockStart(OpData.BlockIterator.ID());
       continue;
     }
 
-    // If we have set to early exit or at the end block then leave
-    if (OpData.BlockResults.Quit || ++OpData.BlockIterator == BlockEnd) {
-      break;
-    }
+    // Fall through in to the next block, leaves at the end of the last one
+    ++Index;
   }
+
 }
 
 }
@@ -4,6 +4,9 @@
 #include <FEXCore/IR/IR.h>
 #include <FEXCore/IR/IntrusiveIRList.h>
 
+#include <utility>
+#include <vector>
+
 namespace FEXCore::Core {
   struct InternalThreadState;
 }
@@ -40,10 +43,14 @@ namespace FEXCore::CPU {
     void *fn;
   };
 
+  struct InterpreterProgram;
+
   class InterpreterOps {
 
     public:
-      static void InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, FEXCore::Core::DebugData *DebugData);
+      // Lowers the IR once, the result lives as long as the IR does
+      static InterpreterProgram *CreateProgram(FEXCore::IR::IRListView const *CurrentIR);
+      static void InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, InterpreterProgram const *Program, FEXCore::Core::DebugData *DebugData);
       static bool GetFallbackHandler(IR::IROp_Header *IROp, FallbackInfo *Info);
 
       struct IROpData {
@@ -137,8 +144,7 @@ namespace FEXCore::CPU {
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(GuestReturn);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
@@ -398,4 +404,32 @@ namespace FEXCore::CPU {
   }
 
   };
+
+  using OpHandler = void (*)(IR::IROp_Header *IROp, InterpreterOps::IROpData *Data, IR::NodeID Node);
+
+  /**
+   * @brief A block's IR lowered for the interpreter
+   *
+   * Every op's handler is looked up once and the code blocks are laid out back to back in IR order, so running a block
+   * is a walk over one flat array instead of the IR's linked lists.
+   * Operands are still read from the SSA slots of their node IDs and the SSA data is still cleared on every run, this
+   * is not threaded code with resolved operand slots.
+   */
+  struct InterpreterProgram {
+    struct Op {
+      OpHandler Handler;
+      IR::IROp_Header *IROp;
+      IR::NodeID Node;
+      // Last op of a code block or an op that can leave one, the only places that need to check the block results
+      bool EndsBlock;
+    };
+
+    std::vector<Op> Ops;
+    // Code block node ID to the index of its first op, sorted by ID
+    std::vector<std::pair<IR::NodeID, uint32_t>> BlockStarts;
+    // Bytes of SSA data the program needs
+    size_t SSASize;
+
+    uint32_t GetBlockStart(IR::NodeID Block) const;
+  };
 } // namespace FEXCore::CPU
@@ -18,18 +18,6 @@ namespace FEXCore::CPU {
 using namespace vixl;
 using namespace vixl::aarch64;
 #define DEF_OP(x) void Arm64JITCore::Op_##x(IR::IROp_Header *IROp, IR::NodeID Node)
-DEF_OP(GuestCallDirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestCallIndirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestReturn) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
 DEF_OP(SignalReturn) {
   // First we must reset the stack
   ResetStack();
@@ -65,17 +53,13 @@ DEF_OP(CallbackReturn) {
   ret();
 }
 
-DEF_OP(ExitFunction) {
-  auto Op = IROp->C<IR::IROp_ExitFunction>();
-
+void Arm64JITCore::EmitBlockExit(IR::OrderedNodeWrapper NewRIPNode) {
   Label FullLookup;
 
-  ResetStack();
-
   aarch64::Register RipReg;
   uint64_t NewRIP;
 
-  if (IsInlineConstant(Op->NewRIP, &NewRIP) || IsInlineEntrypointOffset(Op->NewRIP, &NewRIP)) {
+  if (IsInlineConstant(NewRIPNode, &NewRIP) || IsInlineEntrypointOffset(NewRIPNode, &NewRIP)) {
     Literal l_BranchHost{ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress};
     Literal l_BranchGuest{NewRIP};
 
@@ -85,12 +69,37 @@ DEF_OP(ExitFunction) {
     place(&l_BranchHost);
     place(&l_BranchGuest);
   } else {
-    RipReg = GetReg<RA_64>(Op->Header.Args[0].ID());
+    RipReg = GetReg<RA_64>(NewRIPNode.ID());
+    Label l_InlineCache;
+
+    // Inline cache of the last targets, the miss target expects the cache in x0 and the RIP in x1
+    adr(x0, &l_InlineCache);
+    mov(x1, RipReg);
+
+    for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+      Label NextEntry;
+      ldp(x2, x3, MemOperand(x0, i * 16));
+      cmp(x3, RipReg);
+      b(&NextEntry, Condition::ne);
+      br(x2);
+      bind(&NextEntry);
+    }
+
+    ldr(x2, MemOperand(x0, Dispatcher::INLINE_CACHE_ENTRIES * 16));
+    br(x2);
+
+    bind(&l_InlineCache);
+    for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+      dc64(ThreadSharedData.Dispatcher->InlineCacheMissAddress);
+      dc64(Dispatcher::INLINE_CACHE_EMPTY_RIP);
+    }
+    dc64(ThreadSharedData.Dispatcher->InlineCacheMissAddress);
 
-    // L1 Cache
+    // L1 Cache, megamorphic sites end up here
     LoadConstant(x0, ThreadState->LookupCache->GetL1Pointer());
 
-    and_(x3, RipReg, LookupCache::L1_ENTRIES_MASK);
+    ldr(x3, MemOperand(x0, LookupCache::L1_MASK_OFFSET));
+    and_(x3, RipReg, x3);
     add(x0, x0, Operand(x3, Shift::LSL, 4));
 
     ldp(x1, x0, MemOperand(x0));
@@ -105,6 +114,82 @@ DEF_OP(ExitFunction) {
   }
 }
 
+DEF_OP(ExitFunction) {
+  auto Op = IROp->C<IR::IROp_ExitFunction>();
+
+  ResetStack();
+
+  EmitBlockExit(Op->NewRIP);
+}
+
+DEF_OP(GuestCall) {
+  auto Op = IROp->C<IR::IROp_GuestCall>();
+
+  ResetStack();
+
+  Label l_ReturnRecord;
+  uint64_t ReturnRIP;
+  const bool HasReturnRecord = IsInlineConstant(Op->ReturnRIP, &ReturnRIP) || IsInlineEntrypointOffset(Op->ReturnRIP, &ReturnRIP);
+
+  if (HasReturnRecord) {
+    // Push the return address' link record on to the return stack
+    // A single store so a signal arriving mid push can't leave a torn entry
+    ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)));
+    adr(x1, &l_ReturnRecord);
+    add(x2, STATE, x0);
+    str(x1, MemOperand(x2, offsetof(FEXCore::Core::CpuStateFrame, ReturnStack)));
+    add(x0, x0, sizeof(uint64_t));
+    and_(x0, x0, FEXCore::Core::CpuStateFrame::RETURN_STACK_MASK);
+    str(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)));
+  }
+
+  EmitBlockExit(Op->NewRIP);
+
+  if (HasReturnRecord) {
+    // Never executed, only branched through by the matching return
+    // Same layout as a constant exit, the linker patches the branch in front of the record
+    ldr(x0, 2);
+    blr(x0);
+    bind(&l_ReturnRecord);
+    dc64(ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress);
+    dc64(ReturnRIP);
+  }
+}
+
+DEF_OP(GuestReturn) {
+  auto Op = IROp->C<IR::IROp_GuestReturn>();
+
+  ResetStack();
+
+  if (!IsInlineConstant(Op->NewRIP) && !IsInlineEntrypointOffset(Op->NewRIP, nullptr)) {
+    Label ReturnStackMiss;
+    auto RipReg = GetReg<RA_64>(Op->NewRIP.ID());
+
+    // Pop the return stack, the entry is consumed even if it doesn't match
+    ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)));
+    sub(x0, x0, sizeof(uint64_t));
+    and_(x0, x0, FEXCore::Core::CpuStateFrame::RETURN_STACK_MASK);
+    str(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)));
+
+    add(x0, STATE, x0);
+    ldr(x1, MemOperand(x0, offsetof(FEXCore::Core::CpuStateFrame, ReturnStack)));
+    cbz(x1, &ReturnStackMiss);
+
+    // The record knows which RIP it was pushed for
+    ldp(x0, x2, MemOperand(x1));
+    cmp(x2, RipReg);
+    b(&ReturnStackMiss, Condition::ne);
+
+    // The linker expects the record in LR, same as if we had come from a blr in front of it
+    mov(lr, x1);
+    br(x0);
+
+    bind(&ReturnStackMiss);
+  }
+
+  EmitBlockExit(Op->NewRIP);
+}
+
 DEF_OP(Jump) {
   const auto Op = IROp->C<IR::IROp_Jump>();
   const auto ArgID = Op->Args(0).ID();
@@ -483,8 +568,7 @@ DEF_OP(CPUID) {
 #undef DEF_OP
 void Arm64JITCore::RegisterBranchHandlers() {
 #define REGISTER_OP(op, x) OpHandlers[FEXCore::IR::IROps::OP_##op] = &Arm64JITCore::Op_##x
-  REGISTER_OP(GUESTCALLDIRECT,   GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT, GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,         GuestCall);
   REGISTER_OP(GUESTRETURN,       GuestReturn);
   REGISTER_OP(SIGNALRETURN,      SignalReturn);
   REGISTER_OP(CALLBACKRETURN,    CallbackReturn);
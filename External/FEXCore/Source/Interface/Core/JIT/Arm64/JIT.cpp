@@ -11,6 +11,8 @@ $end_info$
 */
 
 #include "Interface/Context/Context.h"
+#include "Interface/Core/BlockProfiler.h"
+#include "Interface/Core/CodeStats.h"
 #include "Interface/Core/LookupCache.h"
 
 #include "Interface/Core/ArchHelpers/Arm64.h"
@@ -335,11 +337,13 @@ void Arm64JITCore::FreeCodeBuffer(CodeBuffer Buffer) {
 Arm64JITCore::Arm64JITCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalThreadState *Thread, bool CompileThread)
   : Arm64Emitter(ctx, 0)
   , CTX {ctx}
-  , ThreadState {Thread} {
+  , ThreadState {Thread}
+  , IsCompileThread {CompileThread} {
   {
     DispatcherConfig config;
     config.ExitFunctionLink = reinterpret_cast<uintptr_t>(&ExitFunctionLink);
     config.ExitFunctionLinkThis = reinterpret_cast<uintptr_t>(this);
+    config.InlineCacheMiss = reinterpret_cast<uintptr_t>(&InlineCacheMiss);
     config.StaticRegisterAssignment = ctx->Config.StaticRegisterAllocation;
 
     Dispatcher = std::make_unique<Arm64Dispatcher>(CTX, ThreadState, config);
@@ -464,6 +468,12 @@ void Arm64JITCore::ClearCache() {
       InitialCodeBuffer = AllocateNewCodeBuffer(InitialCodeBuffer.Size);
       *Buffer = vixl::CodeBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
     }
+
+    if (UsingCodeSegments()) {
+      // Can't grow any more, from now on fill one segment at a time
+      CurrentCodeSegment = 0;
+      *Buffer = vixl::CodeBuffer(InitialCodeBuffer.Ptr, CODE_SEGMENT_SIZE);
+    }
   }
   else {
     // We have signal handlers that have generated code
@@ -475,6 +485,39 @@ void Arm64JITCore::ClearCache() {
   }
 }
 
+void Arm64JITCore::ResetCache() {
+  if (*ThreadSharedData.SignalHandlerRefCounterPtr != 0) {
+    ClearCache();
+    return;
+  }
+
+  for (auto CodeBuffer : CodeBuffers) {
+    FreeCodeBuffer(CodeBuffer);
+  }
+  CodeBuffers.clear();
+  CurrentCodeBuffer = &InitialCodeBuffer;
+  CurrentCodeSegment = 0;
+
+  // Keep the buffer at the size it grew to, but give its pages back until the next thread writes code
+  madvise(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size, MADV_DONTNEED);
+  *GetBuffer() = vixl::CodeBuffer(InitialCodeBuffer.Ptr, UsingCodeSegments() ? CODE_SEGMENT_SIZE : InitialCodeBuffer.Size);
+}
+
+bool Arm64JITCore::EvictNextCodeSegment() {
+  // Code in any segment might be live under a signal frame, only a full clear knows how to deal with that
+  if (!UsingCodeSegments() || *ThreadSharedData.SignalHandlerRefCounterPtr != 0) {
+    return false;
+  }
+
+  // Oldest segment is the one after the current
+  CurrentCodeSegment = (CurrentCodeSegment + 1) % NUM_CODE_SEGMENTS;
+  auto SegmentBegin = InitialCodeBuffer.Ptr + CurrentCodeSegment * CODE_SEGMENT_SIZE;
+
+  CTX->EvictCodeRange(ThreadState, reinterpret_cast<uintptr_t>(SegmentBegin), reinterpret_cast<uintptr_t>(SegmentBegin) + CODE_SEGMENT_SIZE);
+  *GetBuffer() = vixl::CodeBuffer(SegmentBegin, CODE_SEGMENT_SIZE);
+  return true;
+}
+
 Arm64JITCore::~Arm64JITCore() {
   for (auto CodeBuffer : CodeBuffers) {
     FreeCodeBuffer(CodeBuffer);
@@ -619,6 +662,7 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
 
   this->Entry = Entry;
   this->RAData = RAData;
+  auto CodeStats = ThreadState->CodeStats.get();
 
   #ifndef NDEBUG
   LoadConstant(x0, Entry);
@@ -628,7 +672,8 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
 
   // Fairly excessive buffer range to make sure we don't overflow
   uint32_t BufferRange = SSACount * 16;
-  if ((GetCursorOffset() + BufferRange) > CurrentCodeBuffer->Size) {
+  if ((GetCursorOffset() + BufferRange) > GetBuffer()->GetCapacity() &&
+      !EvictNextCodeSegment()) {
     ThreadState->CTX->ClearCodeCache(ThreadState, false);
   }
 
@@ -692,6 +737,29 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
     }
   }
 
+  if (ThreadState->BlockProfiler) {
+    if (auto Counters = ThreadState->BlockProfiler->GetCounters(Entry)) {
+      using Header = FEXCore::BlockProfilerThread::Header;
+
+      // Charge the time since the last block entry to the last block and become the last block
+      LoadConstant(x1, reinterpret_cast<uintptr_t>(ThreadState->BlockProfiler->GetHeader()));
+      mrs(x2, CNTVCT_EL0);
+      ldr(x3, MemOperand(x1, offsetof(Header, LastTimestamp)));
+      str(x2, MemOperand(x1, offsetof(Header, LastTimestamp)));
+      sub(x2, x2, x3);
+      ldr(x3, MemOperand(x1, offsetof(Header, LastCounters)));
+      ldr(x0, MemOperand(x3, offsetof(FEXCore::BlockProfileCounters, Cycles)));
+      add(x0, x0, x2);
+      str(x0, MemOperand(x3, offsetof(FEXCore::BlockProfileCounters, Cycles)));
+
+      LoadConstant(x3, reinterpret_cast<uintptr_t>(Counters));
+      str(x3, MemOperand(x1, offsetof(Header, LastCounters)));
+      ldr(x0, MemOperand(x3, offsetof(FEXCore::BlockProfileCounters, Calls)));
+      add(x0, x0, 1);
+      str(x0, MemOperand(x3, offsetof(FEXCore::BlockProfileCounters, Calls)));
+    }
+  }
+
   PendingTargetLabel = nullptr;
 
   for (auto [BlockNode, BlockHeader] : IR->GetBlocks()) {
@@ -724,7 +792,12 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
 
       // Execute handler
       OpHandler Handler = OpHandlers[IROp->Op];
+      const auto OpStart = GetCursorOffset();
       (this->*Handler)(IROp, ID);
+
+      if (CodeStats) {
+        CodeStats->RecordHostCode(IROp->Op, GetCursorOffset() - OpStart);
+      }
     }
 
     if (DebugData) {
@@ -768,6 +841,9 @@ uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuSt
   uintptr_t branch = (uintptr_t)(record) - 8;
   auto LinkerAddress = core->ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress;
 
+  // The return stack always goes through the record
+  record[0] = HostCode;
+
   auto offset = HostCode/4 - branch/4;
   if (IsInt26(offset)) {
     // optimal case - can branch directly
@@ -790,8 +866,7 @@ uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuSt
       vixl::aarch64::CPU::EnsureIAndDCacheCoherency((void*)branch, 24);
     });
   } else {
-    // fallback case - do a soft-er link by patching the pointer
-    record[0] = HostCode;
+    // fallback case - do a soft-er link through the pointer
 
     // Add de-linking handler
     Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [record, LinkerAddress]{
@@ -802,6 +877,41 @@ uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuSt
   return HostCode;
 }
 
+uint64_t Arm64JITCore::InlineCacheMiss(Arm64JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *Cache, uint64_t GuestRip) {
+  auto Thread = Frame->Thread;
+
+  auto HostCode = Thread->LookupCache->FindBlock(GuestRip);
+
+  if (!HostCode) {
+    Thread->CurrentFrame->State.rip = GuestRip;
+    return core->ThreadSharedData.Dispatcher->AbsoluteLoopTopAddress;
+  }
+
+  auto MissAddress = core->ThreadSharedData.Dispatcher->InlineCacheMissAddress;
+  for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+    auto Entry = &Cache[i * 2];
+    if (Entry[0] != MissAddress) {
+      continue;
+    }
+
+    // The RIP first so a half filled entry only ever leads back here
+    Entry[1] = GuestRip;
+    Entry[0] = HostCode;
+
+    Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)Entry, [Entry, MissAddress]{
+      // Empty the entry again, it can be reused as long as the site isn't megamorphic
+      Entry[0] = MissAddress;
+      Entry[1] = Dispatcher::INLINE_CACHE_EMPTY_RIP;
+    });
+
+    return HostCode;
+  }
+
+  // Every entry is in use, stop coming here and use the L1 cache lookup that follows the cache
+  Cache[Dispatcher::INLINE_CACHE_ENTRIES * 2] = reinterpret_cast<uint64_t>(&Cache[Dispatcher::INLINE_CACHE_ENTRIES * 2 + 1]);
+  return HostCode;
+}
+
 std::unique_ptr<CPUBackend> CreateArm64JITCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalThreadState *Thread, bool CompileThread) {
   return std::make_unique<Arm64JITCore>(ctx, Thread, CompileThread);
 }
@@ -59,6 +59,7 @@ public:
   [[nodiscard]] bool NeedsOpDispatch() override { return true; }
 
   void ClearCache() override;
+  void ResetCache() override;
 
   static constexpr size_t INITIAL_CODE_SIZE = 1024 * 1024 * 16;
   [[nodiscard]] CodeBuffer AllocateNewCodeBuffer(size_t Size);
@@ -167,11 +168,46 @@ private:
   static constexpr size_t MAX_CODE_SIZE = 1024 * 1024 * 128;
   static constexpr size_t MAX_DISPATCHER_CODE_SIZE = 4096 * 2;
 
+  /**
+   * @name Code segments
+   *
+   * Once the initial code buffer has grown to MAX_CODE_SIZE, code is emitted in to one segment of it at a time.
+   * When a segment fills up the oldest one is evicted and reused instead of clearing the whole code cache.
+   * @{ */
+  constexpr static size_t NUM_CODE_SEGMENTS = 8;
+  constexpr static size_t CODE_SEGMENT_SIZE = MAX_CODE_SIZE / NUM_CODE_SEGMENTS;
+  size_t CurrentCodeSegment{};
+
+  // Compile threads emit code for another thread's block cache, they can't evict from it
+  bool const IsCompileThread;
+
+  [[nodiscard]] bool UsingCodeSegments() const {
+    return !IsCompileThread && CurrentCodeBuffer == &InitialCodeBuffer && InitialCodeBuffer.Size == MAX_CODE_SIZE;
+  }
+
+  /**
+   * @brief Moves the emitter to the next segment in FIFO order, evicting every block in it
+   *
+   * @return false if a full clear is needed instead
+   */
+  bool EvictNextCodeSegment();
+  /**  @} */
+
 #if DEBUG
   vixl::aarch64::Disassembler Disasm;
 #endif
 
   static uint64_t ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *record);
+  static uint64_t InlineCacheMiss(Arm64JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *Cache, uint64_t GuestRip);
+
+  /**
+   * @name Block exits
+   *
+   * Shared between ExitFunction and the guest call/return exits
+   * @{ */
+  // Leaves the block to NewRIP through a link record or the L1 cache
+  void EmitBlockExit(IR::OrderedNodeWrapper NewRIP);
+  /**  @} */
 
   struct CompilerSharedData {
     uint64_t SignalReturnInstruction{};
@@ -275,8 +311,7 @@ private:
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(GuestReturn);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
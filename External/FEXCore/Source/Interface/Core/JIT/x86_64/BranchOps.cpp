@@ -29,18 +29,6 @@ $end_info$
 
 namespace FEXCore::CPU {
 #define DEF_OP(x) void X86JITCore::Op_##x(IR::IROp_Header *IROp, IR::NodeID Node)
-DEF_OP(GuestCallDirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestCallIndirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestReturn) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
 DEF_OP(SignalReturn) {
   // Adjust the stack first for a regular return
   if (SpillSlots) {
@@ -78,36 +66,75 @@ DEF_OP(CallbackReturn) {
   ret();
 }
 
-DEF_OP(ExitFunction) {
-  Label FullLookup;
-  auto Op = IROp->C<IR::IROp_ExitFunction>();
-
+void X86JITCore::EmitLinkRecord(Label &l_Record, uint64_t GuestRIP, uint64_t BranchSite) {
+  // Aligned so linking can swap the start of the lea for a jmp rel32 with a single store
+  // The record ends up 16 bytes after it
+  align(8);
+  lea(rax, ptr[rip + l_Record]);
+  jmp(qword[rax]);
+
+  align(8);
+  L(l_Record);
+  dq(ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress);
+  dq(GuestRIP);
+  dq(BranchSite);
+}
 
-  if (SpillSlots) {
-    add(rsp, SpillSlots * 16);
+bool X86JITCore::IsConstantExitBlock(IR::OrderedNodeWrapper Block, uint64_t *NewRIP) const {
+  for (auto [CodeNode, IROp] : IR->GetCode(IR->GetNode(Block))) {
+    switch (IROp->Op) {
+      case IR::OP_BEGINBLOCK:
+      case IR::OP_ENDBLOCK:
+        break;
+      case IR::OP_EXITFUNCTION: {
+        auto Op = IROp->C<IR::IROp_ExitFunction>();
+        return IsInlineConstant(Op->NewRIP, NewRIP) || IsInlineEntrypointOffset(Op->NewRIP, NewRIP);
+      }
+      default:
+        return false;
+    }
   }
 
+  return false;
+}
+
+void X86JITCore::EmitBlockExit(IR::OrderedNodeWrapper NewRIPNode) {
+  Label FullLookup;
   uint64_t NewRIP;
 
-  if (IsInlineConstant(Op->NewRIP, &NewRIP) || IsInlineEntrypointOffset(Op->NewRIP, &NewRIP)) {
+  if (IsInlineConstant(NewRIPNode, &NewRIP) || IsInlineEntrypointOffset(NewRIPNode, &NewRIP)) {
     Label l_BranchHost;
-    Label l_BranchGuest;
+    EmitLinkRecord(l_BranchHost, NewRIP);
+  } else {
+    Xbyak::Reg RipReg = GetSrc<RA_64>(NewRIPNode.ID());
+    Label l_InlineCache;
 
-    lea(rax, ptr[rip + l_BranchHost]);
-    jmp(qword[rax]);
+    // Inline cache of the last targets, the miss target expects the cache in rcx and the RIP in rax
+    mov(rax, RipReg);
+    lea(rcx, ptr[rip + l_InlineCache]);
+
+    for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+      Label NextEntry;
+      cmp(qword[rcx + i * 16 + 8], rax);
+      jne(NextEntry);
+      jmp(qword[rcx + i * 16]);
+      L(NextEntry);
+    }
 
-    L(l_BranchHost);
-    dq(ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress);
-    L(l_BranchGuest);
-    dq(NewRIP);
-  } else {
-    Xbyak::Reg RipReg = GetSrc<RA_64>(Op->NewRIP.ID());
+    jmp(qword[rcx + Dispatcher::INLINE_CACHE_ENTRIES * 16]);
+
+    L(l_InlineCache);
+    for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+      dq(ThreadSharedData.Dispatcher->InlineCacheMissAddress);
+      dq(Dispatcher::INLINE_CACHE_EMPTY_RIP);
+    }
+    dq(ThreadSharedData.Dispatcher->InlineCacheMissAddress);
 
-    // L1 Cache
+    // L1 Cache, megamorphic sites end up here
     mov(rcx, ThreadState->LookupCache->GetL1Pointer());
     mov(rax, RipReg);
 
-    and_(rax, LookupCache::L1_ENTRIES_MASK);
+    and_(rax, qword[rcx + LookupCache::L1_MASK_OFFSET]);
     shl(rax, 4);
 
     Xbyak::RegExp LookupBase = rcx + rax;
@@ -121,10 +148,80 @@ DEF_OP(ExitFunction) {
     mov(qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, State.rip)], RipReg);
     jmp(rax);
   }
+}
+
+DEF_OP(ExitFunction) {
+  auto Op = IROp->C<IR::IROp_ExitFunction>();
 
-#ifdef BLOCKSTATS
-  ExitBlock();
-#endif
+  if (SpillSlots) {
+    add(rsp, SpillSlots * 16);
+  }
+
+  EmitBlockExit(Op->NewRIP);
+}
+
+DEF_OP(GuestCall) {
+  auto Op = IROp->C<IR::IROp_GuestCall>();
+
+  if (SpillSlots) {
+    add(rsp, SpillSlots * 16);
+  }
+
+  Label l_ReturnRecord;
+  uint64_t ReturnRIP;
+  const bool HasReturnRecord = IsInlineConstant(Op->ReturnRIP, &ReturnRIP) || IsInlineEntrypointOffset(Op->ReturnRIP, &ReturnRIP);
+
+  if (HasReturnRecord) {
+    // Push the return address' link record on to the return stack
+    // A single store so a signal arriving mid push can't leave a torn entry
+    mov(rcx, qword[STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)]);
+    lea(rax, ptr[rip + l_ReturnRecord]);
+    mov(qword[STATE + rcx + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack)], rax);
+    add(rcx, sizeof(uint64_t));
+    and_(rcx, FEXCore::Core::CpuStateFrame::RETURN_STACK_MASK);
+    mov(qword[STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)], rcx);
+  }
+
+  EmitBlockExit(Op->NewRIP);
+
+  if (HasReturnRecord) {
+    // Never executed, only jumped through by the matching return
+    // The jump in front of it is there so the linker can treat it like any other record
+    EmitLinkRecord(l_ReturnRecord, ReturnRIP);
+  }
+}
+
+DEF_OP(GuestReturn) {
+  auto Op = IROp->C<IR::IROp_GuestReturn>();
+
+  if (SpillSlots) {
+    add(rsp, SpillSlots * 16);
+  }
+
+  if (!IsInlineConstant(Op->NewRIP) && !IsInlineEntrypointOffset(Op->NewRIP, nullptr)) {
+    Label ReturnStackMiss;
+    Xbyak::Reg RipReg = GetSrc<RA_64>(Op->NewRIP.ID());
+
+    // Pop the return stack, the entry is consumed even if it doesn't match
+    mov(rcx, qword[STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)]);
+    sub(rcx, sizeof(uint64_t));
+    and_(rcx, FEXCore::Core::CpuStateFrame::RETURN_STACK_MASK);
+    mov(qword[STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackOffset)], rcx);
+
+    mov(rax, qword[STATE + rcx + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack)]);
+    test(rax, rax);
+    jz(ReturnStackMiss);
+
+    // The record knows which RIP it was pushed for
+    // On a hit rax already holds the record as the linker expects
+    cmp(qword[rax + 8], RipReg);
+    jne(ReturnStackMiss);
+    jmp(qword[rax]);
+
+    L(ReturnStackMiss);
+  }
+
+  EmitBlockExit(Op->NewRIP);
 }
 
 DEF_OP(Jump) {
@@ -158,7 +255,21 @@ DEF_OP(CondJump) {
 
   auto [_, __, JCC] = GetCC(Op->Cond);
 
-  (this->*JCC)(*TrueTargetLabel, T_NEAR);
+  uint64_t TrueRIP;
+  if (!SpillSlots && IsConstantExitBlock(Op->TrueBlock, &TrueRIP)) {
+    // Branch to an out of line exit that links this jcc as well, so both successors are direct jumps
+    // The rel32 is kept aligned so linking can update it with a single store
+    while ((getCurr<uintptr_t>() + 2) % 4) {
+      nop();
+    }
+
+    auto &Exit = ConditionalExits.emplace_back();
+    Exit.GuestRIP = TrueRIP;
+    (this->*JCC)(Exit.l_Stub, T_NEAR);
+    Exit.BranchSite = getCurr<uint64_t>();
+  } else {
+    (this->*JCC)(*TrueTargetLabel, T_NEAR);
+  }
 
   PendingTargetLabel = &JumpTargets.try_emplace(Op->FalseBlock.ID()).first->second;
 }
@@ -340,8 +451,7 @@ DEF_OP(CPUID) {
 #undef DEF_OP
 void X86JITCore::RegisterBranchHandlers() {
 #define REGISTER_OP(op, x) OpHandlers[FEXCore::IR::IROps::OP_##op] = &X86JITCore::Op_##x
-  REGISTER_OP(GUESTCALLDIRECT,   GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT, GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,         GuestCall);
   REGISTER_OP(GUESTRETURN,       GuestReturn);
   REGISTER_OP(SIGNALRETURN,      SignalReturn);
   REGISTER_OP(CALLBACKRETURN,    CallbackReturn);
@@ -6,6 +6,8 @@ $end_info$
 */
 
 #include "Interface/Context/Context.h"
+#include "Interface/Core/BlockProfiler.h"
+#include "Interface/Core/CodeStats.h"
 #include "Interface/Core/LookupCache.h"
 
 #include "Interface/Core/Dispatcher/Dispatcher.h"
@@ -27,7 +29,10 @@ $end_info$
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <bits/types/stack_t.h>
+#include <cstring>
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
@@ -316,6 +321,8 @@ X86JITCore::X86JITCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalTh
   , CTX {ctx}
   , ThreadState {Thread}
   , InitialCodeBuffer {Buffer}
+  , IsCompileThread {CompileThread}
+  , EmitterBufferSize {Buffer.Size}
 {
   CurrentCodeBuffer = &InitialCodeBuffer;
 
@@ -350,6 +357,7 @@ X86JITCore::X86JITCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalTh
     DispatcherConfig config;
     config.ExitFunctionLink = reinterpret_cast<uintptr_t>(&ExitFunctionLink);
     config.ExitFunctionLinkThis = reinterpret_cast<uintptr_t>(this);
+    config.InlineCacheMiss = reinterpret_cast<uintptr_t>(&InlineCacheMiss);
 
     Dispatcher = std::make_unique<X86Dispatcher>(CTX, ThreadState, config);
     DispatchPtr = Dispatcher->DispatchPtr;
@@ -405,7 +413,7 @@ void X86JITCore::ClearCache() {
       CodeBuffers.clear();
 
       // Set the current code buffer to the initial
-      setNewBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
+      SetEmitterBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
       CurrentCodeBuffer = &InitialCodeBuffer;
     }
 
@@ -421,7 +429,13 @@ void X86JITCore::ClearCache() {
       CurrentCodeBuffer->Size = std::min(CurrentCodeBuffer->Size, MAX_CODE_SIZE);
 
       InitialCodeBuffer = AllocateNewCodeBuffer(CTX, CurrentCodeBuffer->Size);
-      setNewBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
+      SetEmitterBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
+    }
+
+    if (UsingCodeSegments()) {
+      // Can't grow any more, from now on fill one segment at a time
+      CurrentCodeSegment = 0;
+      SetEmitterBuffer(InitialCodeBuffer.Ptr, CODE_SEGMENT_SIZE);
     }
   }
   else {
@@ -430,10 +444,43 @@ void X86JITCore::ClearCache() {
     // Allocate some new code buffers that we can switch over to instead
     auto NewCodeBuffer = AllocateNewCodeBuffer(CTX, X86JITCore::INITIAL_CODE_SIZE);
     EmplaceNewCodeBuffer(NewCodeBuffer);
-    setNewBuffer(NewCodeBuffer.Ptr, NewCodeBuffer.Size);
+    SetEmitterBuffer(NewCodeBuffer.Ptr, NewCodeBuffer.Size);
   }
 }
 
+void X86JITCore::ResetCache() {
+  if (*ThreadSharedData.SignalHandlerRefCounterPtr != 0) {
+    ClearCache();
+    return;
+  }
+
+  for (auto CodeBuffer : CodeBuffers) {
+    FreeCodeBuffer(CodeBuffer);
+  }
+  CodeBuffers.clear();
+  CurrentCodeBuffer = &InitialCodeBuffer;
+  CurrentCodeSegment = 0;
+
+  // Keep the buffer at the size it grew to, but give its pages back until the next thread writes code
+  madvise(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size, MADV_DONTNEED);
+  SetEmitterBuffer(InitialCodeBuffer.Ptr, UsingCodeSegments() ? CODE_SEGMENT_SIZE : InitialCodeBuffer.Size);
+}
+
+bool X86JITCore::EvictNextCodeSegment() {
+  // Code in any segment might be live under a signal frame, only a full clear knows how to deal with that
+  if (!UsingCodeSegments() || *ThreadSharedData.SignalHandlerRefCounterPtr != 0) {
+    return false;
+  }
+
+  // Oldest segment is the one after the current
+  CurrentCodeSegment = (CurrentCodeSegment + 1) % NUM_CODE_SEGMENTS;
+  auto SegmentBegin = InitialCodeBuffer.Ptr + CurrentCodeSegment * CODE_SEGMENT_SIZE;
+
+  CTX->EvictCodeRange(ThreadState, reinterpret_cast<uintptr_t>(SegmentBegin), reinterpret_cast<uintptr_t>(SegmentBegin) + CODE_SEGMENT_SIZE);
+  SetEmitterBuffer(SegmentBegin, CODE_SEGMENT_SIZE);
+  return true;
+}
+
 IR::PhysicalRegister X86JITCore::GetPhys(IR::NodeID Node) const {
   auto PhyReg = RAData->GetNodeRegister(Node);
 
@@ -601,14 +648,17 @@ std::tuple<X86JITCore::SetCC, X86JITCore::CMovCC, X86JITCore::JCC> X86JITCore::G
 
 void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRListView const *IR, [[maybe_unused]] FEXCore::Core::DebugData *DebugData, FEXCore::IR::RegisterAllocationData *RAData) {
   JumpTargets.clear();
+  ConditionalExits.clear();
   uint32_t SSACount = IR->GetSSACount();
 
   this->Entry = Entry;
   this->RAData = RAData;
+  auto CodeStats = ThreadState->CodeStats.get();
 
   // Fairly excessive buffer range to make sure we don't overflow
   uint32_t BufferRange = SSACount * 16;
-  if ((getSize() + BufferRange) > CurrentCodeBuffer->Size) {
+  if ((getSize() + BufferRange) > EmitterBufferSize &&
+      !EvictNextCodeSegment()) {
     ThreadState->CTX->ClearCodeCache(ThreadState, false);
   }
 
@@ -642,48 +692,26 @@ void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRLi
     sub(rsp, SpillSlots * 16);
   }
 
-#ifdef BLOCKSTATS
-  BlockSamplingData::BlockData *SamplingData = CTX->BlockData->GetBlockData(Entry);
-  if (GetSamplingData) {
-    mov(rcx, reinterpret_cast<uintptr_t>(SamplingData));
-    rdtsc();
-    shl(rdx, 32);
-    or_(rax, rdx);
-    mov(qword [rcx + offsetof(BlockSamplingData::BlockData, Start)], rax);
-  }
+  if (ThreadState->BlockProfiler) {
+    if (auto Counters = ThreadState->BlockProfiler->GetCounters(Entry)) {
+      using Header = FEXCore::BlockProfilerThread::Header;
 
-  auto ExitBlock = [&]() {
-    if (GetSamplingData) {
-      mov(rcx, reinterpret_cast<uintptr_t>(SamplingData));
-      // Get time
+      // Charge the time since the last block entry to the last block and become the last block
+      mov(rcx, reinterpret_cast<uintptr_t>(ThreadState->BlockProfiler->GetHeader()));
       rdtsc();
       shl(rdx, 32);
       or_(rax, rdx);
-
-      // Calculate time spent in block
-      mov(rdx, qword [rcx + offsetof(BlockSamplingData::BlockData, Start)]);
-      sub(rax, rdx);
-
-      // Add time to total time
-      add(qword [rcx + offsetof(BlockSamplingData::BlockData, TotalTime)], rax);
-
-      // Increment call count
-      inc(qword [rcx + offsetof(BlockSamplingData::BlockData, TotalCalls)]);
-
-      // Calculate min
-      mov(rdx, qword [rcx + offsetof(BlockSamplingData::BlockData, Min)]);
-      cmp(rdx, rax);
-      cmova(rdx, rax);
-      mov(qword [rcx + offsetof(BlockSamplingData::BlockData, Min)], rdx);
-
-      // Calculate max
-      mov(rdx, qword [rcx + offsetof(BlockSamplingData::BlockData, Max)]);
-      cmp(rdx, rax);
-      cmovb(rdx, rax);
-      mov(qword [rcx + offsetof(BlockSamplingData::BlockData, Max)], rdx);
+      mov(rdx, rax);
+      sub(rax, qword [rcx + offsetof(Header, LastTimestamp)]);
+      mov(qword [rcx + offsetof(Header, LastTimestamp)], rdx);
+      mov(rdx, qword [rcx + offsetof(Header, LastCounters)]);
+      add(qword [rdx + offsetof(FEXCore::BlockProfileCounters, Cycles)], rax);
+
+      mov(rdx, reinterpret_cast<uintptr_t>(Counters));
+      mov(qword [rcx + offsetof(Header, LastCounters)], rdx);
+      inc(qword [rdx + offsetof(FEXCore::BlockProfileCounters, Calls)]);
     }
-  };
-#endif
+  }
 
   PendingTargetLabel = nullptr;
 
@@ -747,7 +775,12 @@ void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRLi
 
       // Execute handler
       OpHandler Handler = OpHandlers[IROp->Op];
+      const auto OpStart = getSize();
       (this->*Handler)(IROp, ID);
+
+      if (CodeStats) {
+        CodeStats->RecordHostCode(IROp->Op, getSize() - OpStart);
+      }
     }
   }
 
@@ -758,6 +791,14 @@ void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRLi
   }
   PendingTargetLabel = nullptr;
 
+  for (auto &Exit : ConditionalExits) {
+    Label l_Record;
+    align(8);
+    L(Exit.l_Stub);
+    EmitLinkRecord(l_Record, Exit.GuestRIP, Exit.BranchSite);
+  }
+  ConditionalExits.clear();
+
   void *GuestExit = getCurr<void*>();
   this->IR = nullptr;
 
@@ -780,13 +821,77 @@ uint64_t X86JITCore::ExitFunctionLink(X86JITCore *core, FEXCore::Core::CpuStateF
     return core->ThreadSharedData.Dispatcher->AbsoluteLoopTopAddress;
   }
 
+  // Guest signal handlers run on this thread's code too, so every patch is a single aligned store
+  // See EmitLinkRecord for the layout
+  auto Branch = record - 2;
+  const uint64_t OriginalBranch = *Branch;
+  const uint64_t BranchSite = record[2];
+  const uint32_t OriginalSite = BranchSite ? *reinterpret_cast<uint32_t*>(BranchSite - 4) : 0;
+
+  // The return stack always goes through the record
+  record[0] = HostCode;
+
+  // jmp rel32 over the start of the lea
+  const int64_t BranchOffset = HostCode - (reinterpret_cast<uintptr_t>(Branch) + 5);
+  if (BranchOffset == static_cast<int32_t>(BranchOffset)) {
+    const int32_t Rel32 = BranchOffset;
+    std::array<uint8_t, 8> Code;
+    memcpy(Code.data(), &OriginalBranch, sizeof(OriginalBranch));
+    Code[0] = 0xE9;
+    memcpy(&Code[1], &Rel32, sizeof(Rel32));
+    std::atomic_ref(*Branch).store(std::bit_cast<uint64_t>(Code), std::memory_order_relaxed);
+  }
+
+  const int64_t SiteOffset = HostCode - BranchSite;
+  if (BranchSite && SiteOffset == static_cast<int32_t>(SiteOffset)) {
+    std::atomic_ref(*reinterpret_cast<uint32_t*>(BranchSite - 4)).store(static_cast<uint32_t>(SiteOffset), std::memory_order_relaxed);
+  }
+
   auto LinkerAddress = core->ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress;
-  Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [record, LinkerAddress]{
+  Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [record, LinkerAddress, Branch, OriginalBranch, BranchSite, OriginalSite]{
     // undo the link
     record[0] = LinkerAddress;
+    std::atomic_ref(*Branch).store(OriginalBranch, std::memory_order_relaxed);
+    if (BranchSite) {
+      std::atomic_ref(*reinterpret_cast<uint32_t*>(BranchSite - 4)).store(OriginalSite, std::memory_order_relaxed);
+    }
   });
 
-  record[0] = HostCode;
+  return HostCode;
+}
+
+uint64_t X86JITCore::InlineCacheMiss(X86JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *Cache, uint64_t GuestRip) {
+  auto Thread = Frame->Thread;
+
+  auto HostCode = Thread->LookupCache->FindBlock(GuestRip);
+
+  if (!HostCode) {
+    Thread->CurrentFrame->State.rip = GuestRip;
+    return core->ThreadSharedData.Dispatcher->AbsoluteLoopTopAddress;
+  }
+
+  auto MissAddress = core->ThreadSharedData.Dispatcher->InlineCacheMissAddress;
+  for (size_t i = 0; i < Dispatcher::INLINE_CACHE_ENTRIES; ++i) {
+    auto Entry = &Cache[i * 2];
+    if (Entry[0] != MissAddress) {
+      continue;
+    }
+
+    // The RIP first so a half filled entry only ever leads back here
+    Entry[1] = GuestRip;
+    Entry[0] = HostCode;
+
+    Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)Entry, [Entry, MissAddress]{
+      // Empty the entry again, it can be reused as long as the site isn't megamorphic
+      Entry[0] = MissAddress;
+      Entry[1] = Dispatcher::INLINE_CACHE_EMPTY_RIP;
+    });
+
+    return HostCode;
+  }
+
+  // Every entry is in use, stop coming here and use the L1 cache lookup that follows the cache
+  Cache[Dispatcher::INLINE_CACHE_ENTRIES * 2] = reinterpret_cast<uint64_t>(&Cache[Dispatcher::INLINE_CACHE_ENTRIES * 2 + 1]);
   return HostCode;
 }
 
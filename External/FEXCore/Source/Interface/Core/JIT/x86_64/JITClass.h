@@ -6,7 +6,6 @@ $end_info$
 
 #pragma once
 
-#include "Interface/Core/BlockSamplingData.h"
 #include "Interface/Core/Dispatcher/Dispatcher.h"
 
 #define XBYAK64
@@ -21,6 +20,7 @@ using namespace Xbyak;
 #include <FEXCore/Utils/MathUtils.h>
 #include "Interface/IR/Passes/RegisterAllocationPass.h"
 
+#include <deque>
 #include <tuple>
 
 namespace FEXCore::CPU {
@@ -74,6 +74,7 @@ public:
   [[nodiscard]] bool NeedsOpDispatch() override { return true; }
 
   void ClearCache() override;
+  void ResetCache() override;
 
   static constexpr size_t INITIAL_CODE_SIZE = 1024 * 1024 * 16;
   static constexpr size_t MAX_CODE_SIZE = 1024 * 1024 * 256;
@@ -92,6 +93,15 @@ private:
   uint64_t Entry;
 
   std::unordered_map<IR::NodeID, Label> JumpTargets;
+
+  // Conditional branches straight to an exit, their link stubs are placed after the block
+  struct ConditionalExit {
+    Label l_Stub;
+    uint64_t GuestRIP;
+    // Address right after the jcc
+    uint64_t BranchSite;
+  };
+  std::deque<ConditionalExit> ConditionalExits;
   Xbyak::util::Cpu Features{};
 
   bool MemoryDebug = false;
@@ -142,15 +152,26 @@ private:
   IR::RegisterAllocationPass *RAPass;
   FEXCore::IR::RegisterAllocationData *RAData;
 
-#ifdef BLOCKSTATS
-  bool GetSamplingData {true};
-#endif
-
   void EmplaceNewCodeBuffer(CodeBuffer Buffer) {
     CurrentCodeBuffer = &CodeBuffers.emplace_back(Buffer);
   }
 
   static uint64_t ExitFunctionLink(X86JITCore* code, FEXCore::Core::CpuStateFrame *Frame, uint64_t *record);
+  static uint64_t InlineCacheMiss(X86JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *Cache, uint64_t GuestRip);
+
+  /**
+   * @name Block exits
+   *
+   * Shared between ExitFunction and the guest call/return exits
+   * @{ */
+  // Leaves the block to NewRIP through a link record or the L1 cache
+  void EmitBlockExit(IR::OrderedNodeWrapper NewRIP);
+  // Emits the jump through a {HostCode, GuestRIP, BranchSite} link record and the record at the label
+  // Linking replaces the jump and the jcc ending at BranchSite, if any, with direct jumps
+  void EmitLinkRecord(Label &l_Record, uint64_t GuestRIP, uint64_t BranchSite = 0);
+  // Checks if the block does nothing but leave to a constant RIP
+  [[nodiscard]] bool IsConstantExitBlock(IR::OrderedNodeWrapper Block, uint64_t *NewRIP) const;
+  /**  @} */
 
   // This is the initial code buffer that we will fall back to
   // In a program without signals and code clearing, we will typically
@@ -164,6 +185,38 @@ private:
   // This is the current code buffer that we are tracking
   CodeBuffer *CurrentCodeBuffer{};
 
+  /**
+   * @name Code segments
+   *
+   * Once the initial code buffer has grown to MAX_CODE_SIZE, code is emitted in to one segment of it at a time.
+   * When a segment fills up the oldest one is evicted and reused instead of clearing the whole code cache.
+   * @{ */
+  constexpr static size_t NUM_CODE_SEGMENTS = 8;
+  constexpr static size_t CODE_SEGMENT_SIZE = MAX_CODE_SIZE / NUM_CODE_SEGMENTS;
+  size_t CurrentCodeSegment{};
+
+  // Compile threads emit code for another thread's block cache, they can't evict from it
+  bool const IsCompileThread;
+
+  [[nodiscard]] bool UsingCodeSegments() const {
+    return !IsCompileThread && CurrentCodeBuffer == &InitialCodeBuffer && InitialCodeBuffer.Size == MAX_CODE_SIZE;
+  }
+
+  /**
+   * @brief Moves the emitter to the next segment in FIFO order, evicting every block in it
+   *
+   * @return false if a full clear is needed instead
+   */
+  bool EvictNextCodeSegment();
+  /**  @} */
+
+  // Size of the region the emitter is currently writing in to
+  size_t EmitterBufferSize{};
+  void SetEmitterBuffer(uint8_t *Ptr, size_t Size) {
+    setNewBuffer(Ptr, Size);
+    EmitterBufferSize = Size;
+  }
+
   struct CompilerSharedData {
     uint64_t SignalHandlerReturnAddress{};
     uint64_t UnimplementedInstructionAddress{};
@@ -274,8 +327,7 @@ private:
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(GuestReturn);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
@@ -0,0 +1,117 @@
+/*
+$info$
+tags: glue|block-database
+desc: Bounded per thread cache of the IR for compiled blocks
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/LocalIRCache.h"
+
+#include <FEXCore/Config/Config.h>
+#include <FEXCore/IR/IntrusiveIRList.h>
+#include <FEXCore/IR/RegisterAllocationData.h>
+
+namespace FEXCore {
+LocalIRCache::LocalIRCache(FEXCore::Context::Context *CTX) {
+  RetainAll = CTX->Config.Core == FEXCore::Config::CONFIG_INTERPRETER ||
+              CTX->Config.AOTIRCapture() ||
+              CTX->Config.AOTIRGenerate() ||
+              CTX->RetainsDebugData();
+
+  MaxSize = static_cast<size_t>(CTX->Config.IRCacheSize()) * 1024 * 1024;
+}
+
+size_t LocalIRCache::GetEntrySize(FEXCore::Core::LocalIREntry const &Entry) {
+  size_t Size{};
+
+  // Shared IR and RA data live in an AOT cache file and aren't ours
+  if (Entry.IR && Entry.IR->IsCopy()) {
+    Size += Entry.IR->GetInlineSize();
+  }
+
+  if (Entry.RAData && !Entry.RAData->IsShared) {
+    Size += FEXCore::IR::RegisterAllocationData::Size(Entry.RAData->MapCount);
+  }
+
+  if (Entry.DebugData) {
+    Size += sizeof(FEXCore::Core::DebugData) + Entry.DebugData->Subblocks.capacity() * sizeof(FEXCore::Core::DebugDataSubblock);
+  }
+
+  return Size;
+}
+
+FEXCore::Core::LocalIREntry *LocalIRCache::Find(uint64_t GuestRIP) {
+  auto it = Entries.find(GuestRIP);
+  if (it == Entries.end()) {
+    return nullptr;
+  }
+
+  if (!it->second.Pinned && !RetainAll) {
+    LRU.splice(LRU.begin(), LRU, it->second.LRUPosition);
+  }
+
+  return &it->second.Entry;
+}
+
+void LocalIRCache::Insert(uint64_t GuestRIP, FEXCore::Core::LocalIREntry &&Entry, bool Pinned) {
+  Pinned |= RetainAll;
+
+  if (!Pinned && MaxSize == 0) {
+    // Nothing needs it, Entry frees everything on the way out
+    return;
+  }
+
+  if (Entry.DebugData) {
+    // Backends fill this while compiling, trim what they reserved
+    Entry.DebugData->Subblocks.shrink_to_fit();
+  }
+
+  const size_t Size = GetEntrySize(Entry);
+
+  if (!Pinned) {
+    if (Size > MaxSize) {
+      return;
+    }
+    EvictToSize(MaxSize - Size);
+  }
+
+  auto [it, Inserted] = Entries.try_emplace(GuestRIP, CacheEntry{std::move(Entry), Size, Pinned, {}});
+  if (!Inserted) {
+    // Matches the unordered_map::insert this replaced, the existing entry wins
+    return;
+  }
+
+  if (!Pinned) {
+    LRU.push_front(GuestRIP);
+    it->second.LRUPosition = LRU.begin();
+    CurrentSize += Size;
+  }
+}
+
+void LocalIRCache::Erase(uint64_t GuestRIP) {
+  auto it = Entries.find(GuestRIP);
+  if (it == Entries.end()) {
+    return;
+  }
+
+  if (!it->second.Pinned) {
+    LRU.erase(it->second.LRUPosition);
+    CurrentSize -= it->second.Size;
+  }
+
+  Entries.erase(it);
+}
+
+void LocalIRCache::Clear() {
+  Entries.clear();
+  LRU.clear();
+  CurrentSize = 0;
+}
+
+void LocalIRCache::EvictToSize(size_t Size) {
+  while (CurrentSize > Size && !LRU.empty()) {
+    Erase(LRU.back());
+  }
+}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <cstdint>
+#include <list>
+#include <stddef.h>
+#include <unordered_map>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+
+/**
+ * @brief Per thread cache of the IR, RA data and debug data of compiled blocks
+ *
+ * Some users need the IR of every block for as long as the block exists
+ *  - The interpreter executes the IR directly
+ *  - AOT IR capture writes the IR out asynchronously
+ *  - Blocks loaded through the IR loader have no guest code to generate IR from
+ *  - The debugger and GDB server look up the debug data of any block
+ *
+ * If nothing needs it the IR is only kept to make recompiling evicted blocks cheaper.
+ * That is bounded by the IRCacheSize option and the least recently used blocks are dropped first.
+ */
+class LocalIRCache final {
+public:
+  LocalIRCache(FEXCore::Context::Context *CTX);
+
+  /**
+   * @brief Finds the entry for a block and marks it as recently used
+   *
+   * The entry stays valid until the next Insert, Erase or Clear
+   */
+  FEXCore::Core::LocalIREntry *Find(uint64_t GuestRIP);
+
+  /**
+   * @brief Takes ownership of a block's IR
+   *
+   * The IR is freed immediately if nothing needs it
+   *
+   * @param Pinned The entry is only ever removed by Erase or Clear
+   */
+  void Insert(uint64_t GuestRIP, FEXCore::Core::LocalIREntry &&Entry, bool Pinned = false);
+
+  void Erase(uint64_t GuestRIP);
+  void Clear();
+
+  bool Empty() const { return Entries.empty(); }
+  size_t GetSize() const { return CurrentSize; }
+
+private:
+  struct CacheEntry {
+    FEXCore::Core::LocalIREntry Entry;
+    size_t Size;
+    bool Pinned;
+    // Only valid for entries that aren't pinned
+    std::list<uint64_t>::iterator LRUPosition;
+  };
+
+  static size_t GetEntrySize(FEXCore::Core::LocalIREntry const &Entry);
+  void EvictToSize(size_t Size);
+
+  // Every entry is kept and nothing is evicted
+  bool RetainAll{};
+  // Only applies to entries that aren't pinned
+  size_t MaxSize{};
+  size_t CurrentSize{};
+
+  std::unordered_map<uint64_t, CacheEntry> Entries;
+  // Most recently used at the front
+  std::list<uint64_t> LRU;
+};
+}
@@ -11,11 +11,55 @@ $end_info$
 #include "Interface/Context/Context.h"
 #include "Interface/Core/LookupCache.h"
 
+#include <algorithm>
+#include <bit>
 #include <sys/mman.h>
 
 namespace FEXCore {
+LookupCachePagePool::LookupCachePagePool(size_t PageSize)
+  : PageSize {PageSize} {
+  // Only reserved, pages are only backed once a thread writes to its tables
+  Memory = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, POOL_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+  LOGMAN_THROW_A_FMT(Memory != -1ULL, "Failed to allocate L2 page pool");
+}
+
+LookupCachePagePool::~LookupCachePagePool() {
+  FEXCore::Allocator::munmap(reinterpret_cast<void*>(Memory), POOL_SIZE);
+}
+
+uintptr_t LookupCachePagePool::Allocate() {
+  {
+    std::unique_lock lk(FreePagesMutex, std::try_to_lock);
+    if (lk.owns_lock() && !FreePages.empty()) {
+      auto Page = FreePages.back();
+      FreePages.pop_back();
+      return Page;
+    }
+  }
+
+  auto Offset = AllocateOffset.fetch_add(PageSize);
+  if (Offset + PageSize > POOL_SIZE) {
+    // Leave it saturated so this keeps failing
+    AllocateOffset.store(POOL_SIZE);
+    return 0;
+  }
+
+  return Memory + Offset;
+}
+
+void LookupCachePagePool::Release(std::vector<uintptr_t> const &Pages) {
+  std::unique_lock lk(FreePagesMutex, std::try_to_lock);
+  if (!lk.owns_lock()) {
+    // The tables are already zeroed and released to the kernel, losing them only costs VA
+    return;
+  }
+
+  FreePages.insert(FreePages.end(), Pages.begin(), Pages.end());
+}
+
 LookupCache::LookupCache(FEXCore::Context::Context *CTX)
-  : ctx {CTX} {
+  : PagePool {CTX->L2PagePool.get()}
+  , ctx {CTX} {
 
   // Block cache ends up looking like this
   // PageMemoryMap[VirtualMemoryRegion >> 12]
@@ -31,25 +75,70 @@ LookupCache::LookupCache(FEXCore::Context::Context *CTX)
   // At 64GB of virtual memory this will allocate 128MB of virtual memory space
   PagePointer = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, ctx->Config.VirtualMemSize / 4096 * 8, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
 
-  // Allocate our memory backing our pages
+  // The memory backing our pages comes from the shared pool
   // We need 32KB per guest page (One pointer per byte)
   // XXX: We can drop down to 16KB if we store 4byte offsets from the code base
-  // We currently limit to 128MB of real memory for caching for the total cache size.
+  // We currently limit each thread to 128MB of real memory for caching for the total cache size.
   // Can end up being inefficient if we compile a small number of blocks per page
-  PageMemory = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-  LOGMAN_THROW_A_FMT(PageMemory != -1ULL, "Failed to allocate page memory");
 
   // L1 Cache
-  L1Pointer = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, L1_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-  LOGMAN_THROW_A_FMT(L1Pointer != -1ULL, "Failed to allocate L1Pointer");
+  // Reserve space for the largest it can grow to, only the part in use ever gets touched
+  L1MaxEntries = std::max<size_t>(std::bit_floor<size_t>(ctx->Config.LookupCacheL1MaxEntries()), L1_INITIAL_ENTRIES);
+  uintptr_t L1Base = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, L1_HEADER_SIZE + L1MaxEntries * sizeof(LookupCacheEntry), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+  LOGMAN_THROW_A_FMT(L1Base != -1ULL, "Failed to allocate L1Pointer");
+  L1Pointer = L1Base + L1_HEADER_SIZE;
+  ResetL1();
 
   VirtualMemSize = ctx->Config.VirtualMemSize;
 }
 
 LookupCache::~LookupCache() {
+  // Hand our L2 tables to the next thread
+  ClearL2Cache();
+  PagePool->Release(Pages);
+
   FEXCore::Allocator::munmap(reinterpret_cast<void*>(PagePointer), ctx->Config.VirtualMemSize / 4096 * 8);
-  FEXCore::Allocator::munmap(reinterpret_cast<void*>(PageMemory), CODE_SIZE);
-  FEXCore::Allocator::munmap(reinterpret_cast<void*>(L1Pointer), L1_SIZE);
+  FEXCore::Allocator::munmap(reinterpret_cast<void*>(L1Pointer - L1_HEADER_SIZE), L1_HEADER_SIZE + L1MaxEntries * sizeof(LookupCacheEntry));
+}
+
+void LookupCache::ResetL1() {
+  madvise(reinterpret_cast<void*>(L1Pointer), L1MaxEntries * sizeof(LookupCacheEntry), MADV_DONTNEED);
+  L1Mask() = L1_INITIAL_ENTRIES - 1;
+  L1MissBudget() = L1_MISS_BUDGET;
+  L1BudgetStart = std::chrono::steady_clock::now();
+}
+
+void LookupCache::CheckL1Size() {
+  if (L1MissBudget() >= 0) {
+    return;
+  }
+
+  auto Now = std::chrono::steady_clock::now();
+  const size_t Entries = L1Mask() + 1;
+
+  if (Now - L1BudgetStart < L1_MISS_WINDOW && Entries < L1MaxEntries) {
+    // Missing too often, double the L1
+    // Entries that now belong in the upper half are moved there before the mask changes
+    // so lookups from either mask keep finding them
+    auto L1 = reinterpret_cast<LookupCacheEntry*>(L1Pointer);
+    for (size_t i = 0; i < Entries; ++i) {
+      if (L1[i].GuestCode & Entries) {
+        L1[i + Entries] = L1[i];
+      }
+    }
+
+    L1Mask() = Entries * 2 - 1;
+
+    // Leftovers in the lower half could never match but Erase would no longer find them
+    for (size_t i = 0; i < Entries; ++i) {
+      if (L1[i].GuestCode & Entries) {
+        L1[i].GuestCode = L1[i].HostCode = 0;
+      }
+    }
+  }
+
+  L1MissBudget() = L1_MISS_BUDGET;
+  L1BudgetStart = Now;
 }
 
 void LookupCache::HintUsedRange(uint64_t Address, uint64_t Size) {
@@ -63,19 +152,62 @@ void LookupCache::HintUsedRange(uint64_t Address, uint64_t Size) {
 void LookupCache::ClearL2Cache() {
   // Clear out the page memory
   madvise(reinterpret_cast<void*>(PagePointer), ctx->Config.VirtualMemSize / 4096 * 8, MADV_DONTNEED);
-  madvise(reinterpret_cast<void*>(PageMemory), CODE_SIZE, MADV_DONTNEED);
-  AllocateOffset = 0;
+
+  // Our tables are mostly contiguous in the pool, release them in runs
+  std::sort(Pages.begin(), Pages.end());
+  for (size_t i = 0; i < Pages.size(); ) {
+    size_t RunEnd = i + 1;
+    while (RunEnd < Pages.size() && Pages[RunEnd] == Pages[RunEnd - 1] + SIZE_PER_PAGE) {
+      ++RunEnd;
+    }
+    madvise(reinterpret_cast<void*>(Pages[i]), (RunEnd - i) * SIZE_PER_PAGE, MADV_DONTNEED);
+    i = RunEnd;
+  }
+  PagesInUse = 0;
 }
 
 void LookupCache::ClearCache() {
-  // Clear L1
-  madvise(reinterpret_cast<void*>(L1Pointer), L1_SIZE, MADV_DONTNEED);
+  // Clear L1 and start it small again
+  ResetL1();
   // Clear L2
   ClearL2Cache();
   // All code is gone, remove links
   BlockLinks.clear();
   // All code is gone, clear the block list
   BlockList.clear();
+  // Anything compiled from here on is a cold compile
+  EvictedBlocks.clear();
+}
+
+size_t LookupCache::EraseHostCodeRange(uintptr_t HostStart, uintptr_t HostEnd) {
+  auto InRange = [HostStart, HostEnd](uintptr_t HostCode) {
+    return HostCode >= HostStart && HostCode < HostEnd;
+  };
+
+  // Links living in the evicted code are about to be overwritten
+  // Drop them first so nothing writes to that code when their destination goes away later
+  std::erase_if(BlockLinks, [&InRange](auto const &Link) {
+    return InRange(Link.first.HostLink);
+  });
+
+  std::vector<uint64_t> Evicted;
+  for (auto [GuestCode, HostCode] : BlockList) {
+    if (InRange(HostCode)) {
+      Evicted.push_back(GuestCode);
+    }
+  }
+
+  if (EvictedBlocks.size() + Evicted.size() > MAX_EVICTED_BLOCKS) {
+    // Blocks that were evicted long ago and come back now count as cold compiles
+    EvictedBlocks.clear();
+  }
+
+  for (auto GuestCode : Evicted) {
+    Erase(GuestCode);
+    EvictedBlocks.insert(GuestCode);
+  }
+
+  return Evicted.size();
 }
 
 }
@@ -1,10 +1,14 @@
 #pragma once
 #include <FEXCore/Utils/LogManager.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <stddef.h>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,6 +17,43 @@ namespace Context {
   struct Context;
 }
 
+/**
+ * @brief Process wide pool of the page sized tables backing each thread's L2 lookup cache
+ *
+ * Blocks are compiled per thread so the L2 contents can't be shared, but the memory behind it can.
+ * Each thread takes tables from here as it needs them and hands them back when it exits,
+ * instead of every thread reserving the worst case up front.
+ *
+ * Never blocks, so it is safe to use from a signal handler that interrupted another user of the pool.
+ */
+class LookupCachePagePool final {
+public:
+  LookupCachePagePool(size_t PageSize);
+  ~LookupCachePagePool();
+
+  /**
+   * @brief Takes a zeroed table from the pool
+   *
+   * @return The table or zero if the pool is exhausted
+   */
+  uintptr_t Allocate();
+
+  /**
+   * @brief Returns zeroed tables to the pool
+   */
+  void Release(std::vector<uintptr_t> const &Pages);
+
+private:
+  constexpr static size_t POOL_SIZE = 1024 * 1024 * 1024;
+
+  size_t const PageSize;
+  uintptr_t Memory{};
+  std::atomic<size_t> AllocateOffset{};
+
+  std::mutex FreePagesMutex;
+  std::vector<uintptr_t> FreePages;
+};
+
 class LookupCache {
 public:
 
@@ -58,7 +99,7 @@ public:
 
     // There is no need to update L1 or L2, they will get updated on first lookup
     // However, adding to L1 here increases performance
-    auto &L1Entry = reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1_ENTRIES_MASK];
+    auto &L1Entry = GetL1Entry(Address);
     L1Entry.GuestCode = Address;
     L1Entry.HostCode = (uintptr_t)HostCode;
   }
@@ -76,7 +117,7 @@ public:
     BlockList.erase(Address);
 
     // Do L1
-    auto &L1Entry = reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1_ENTRIES_MASK];
+    auto &L1Entry = GetL1Entry(Address);
     if (L1Entry.GuestCode == Address) {
       L1Entry.GuestCode = L1Entry.HostCode = 0;
     }
@@ -104,22 +145,72 @@ public:
     BlockLinks.insert({{GuestDestination, HostLink}, delinker});
   }
 
+  /**
+   * @brief Removes every block with host code in [HostStart, HostEnd)
+   *
+   * Used when the backend is about to reuse that part of its code buffer.
+   * Links in to the removed blocks are undone, links from the removed code are dropped without touching it.
+   *
+   * @return How many blocks were removed
+   */
+  size_t EraseHostCodeRange(uintptr_t HostStart, uintptr_t HostEnd);
+
+  /**
+   * @brief Checks if a block was removed by `EraseHostCodeRange` and forgets about it
+   */
+  bool WasEvicted(uint64_t Address) {
+    return EvictedBlocks.erase(Address) != 0;
+  }
+
   void ClearCache();
   void ClearL2Cache();
 
+  /**
+   * @brief Grows the L1 if the backends ran out of their L1 miss budget too quickly
+   *
+   * Backends jump to the block compiler once the budget goes negative, which must call this.
+   */
+  void CheckL1Size();
+
   void HintUsedRange(uint64_t Address, uint64_t Size);
 
   uintptr_t GetL1Pointer() const { return L1Pointer; }
   uintptr_t GetPagePointer() const { return PagePointer; }
   uintptr_t GetVirtualMemorySize() const { return VirtualMemSize; }
 
-  constexpr static size_t L1_ENTRIES = 1 * 1024 * 1024; // Must be a power of 2
-  constexpr static size_t L1_ENTRIES_MASK = L1_ENTRIES - 1;
+  /**
+   * @name L1 header
+   *
+   * The L1 changes size at runtime so backends load its mask from in front of the L1 instead of embedding it.
+   * Backends decrement the miss budget every time an L1 miss is served from the L2 and
+   * go through the block compiler once it goes negative.
+   * @{ */
+  constexpr static int32_t L1_MASK_OFFSET = -8;
+  constexpr static int32_t L1_MISS_BUDGET_OFFSET = -16;
+  /**  @} */
+
+  constexpr static size_t L1_INITIAL_ENTRIES = 16 * 1024; // Must be a power of 2
+  // Size of each L2 table, one entry per byte of a guest page
+  constexpr static size_t SIZE_PER_PAGE = 4096 * sizeof(LookupCacheEntry);
 
 private:
+  void ResetL1();
+
+  uint64_t &L1Mask() const {
+    return *reinterpret_cast<uint64_t*>(L1Pointer + L1_MASK_OFFSET);
+  }
+
+  int64_t &L1MissBudget() const {
+    return *reinterpret_cast<int64_t*>(L1Pointer + L1_MISS_BUDGET_OFFSET);
+  }
+
+  LookupCacheEntry &GetL1Entry(uint64_t Address) const {
+    return reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1Mask()];
+  }
+
   void CacheBlockMapping(uint64_t Address, uintptr_t HostCode) { 
     // Do L1
-    auto &L1Entry = reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1_ENTRIES_MASK];
+    auto &L1Entry = GetL1Entry(Address);
     L1Entry.GuestCode = Address;
     L1Entry.HostCode = HostCode;
 
@@ -138,8 +229,11 @@ private:
       if (!NewPageBacking) {
         // Couldn't allocate, clear L2 and retry
         ClearL2Cache();
-        CacheBlockMapping(Address, HostCode);
-        return;
+        NewPageBacking = AllocateBackingForPage();
+        if (!NewPageBacking) {
+          // Pool is exhausted and this thread has nothing to reuse, the block stays L1 and L3 only
+          return;
+        }
       }
       Pointers[Address] = NewPageBacking;
       LocalPagePointer = NewPageBacking;
@@ -154,23 +248,29 @@ private:
   }
 
   uintptr_t AllocateBackingForPage() {
-    uintptr_t NewBase = AllocateOffset;
-    uintptr_t NewEnd = AllocateOffset + SIZE_PER_PAGE;
+    // Tables kept from before the last L2 clear get reused first
+    if (PagesInUse < Pages.size()) {
+      return Pages[PagesInUse++];
+    }
 
-    if (NewEnd >= CODE_SIZE) {
+    if (Pages.size() >= MAX_PAGES) {
       // We ran out of block backing space. Need to clear the block cache and tell the JIT cores to clear their caches as well
       // Tell whatever is calling this that it needs to do it.
       return 0;
     }
 
-    AllocateOffset = NewEnd;
-    return PageMemory + NewBase;
+    uintptr_t NewPage = PagePool->Allocate();
+    if (NewPage) {
+      Pages.push_back(NewPage);
+      ++PagesInUse;
+    }
+    return NewPage;
   }
 
   uintptr_t FindCodePointerForAddress(uint64_t Address) {
     
     // Do L1
-    auto &L1Entry = reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1_ENTRIES_MASK];
+    auto &L1Entry = GetL1Entry(Address);
     if (L1Entry.GuestCode == Address) {
       return L1Entry.HostCode;
     }
@@ -200,9 +300,13 @@ private:
   }
 
   uintptr_t PagePointer;
-  uintptr_t PageMemory;
   uintptr_t L1Pointer;
 
+  // L2 tables taken from the pool, the first PagesInUse of them are live
+  LookupCachePagePool *PagePool;
+  std::vector<uintptr_t> Pages;
+  size_t PagesInUse{};
+
   struct BlockLinkTag {
     uint64_t GuestDestination;
     uintptr_t HostLink;
@@ -220,12 +324,24 @@ private:
 
   std::map<BlockLinkTag, std::function<void()>> BlockLinks;
   std::map<uint64_t, uint64_t> BlockList;
+  // Guest addresses of evicted blocks that haven't been compiled again
+  // Only feeds the recompile stat, so it gets dropped rather than growing past the limit
+  std::unordered_set<uint64_t> EvictedBlocks;
+  constexpr static size_t MAX_EVICTED_BLOCKS = 64 * 1024;
 
   constexpr static size_t CODE_SIZE = 128 * 1024 * 1024;
-  constexpr static size_t SIZE_PER_PAGE = 4096 * sizeof(LookupCacheEntry);
-  constexpr static size_t L1_SIZE = L1_ENTRIES * sizeof(LookupCacheEntry);
+  constexpr static size_t MAX_PAGES = CODE_SIZE / SIZE_PER_PAGE;
+
+  // Header lives in its own page directly in front of the L1
+  constexpr static size_t L1_HEADER_SIZE = 4096;
+
+  // The L1 doubles if the budget runs out in less than this
+  constexpr static int64_t L1_MISS_BUDGET = 4096;
+  constexpr static std::chrono::milliseconds L1_MISS_WINDOW {10};
 
-  size_t AllocateOffset {};
+  // Entries reserved for the L1, it never grows past this
+  size_t L1MaxEntries{};
+  std::chrono::steady_clock::time_point L1BudgetStart{};
 
   FEXCore::Context::Context *ctx;
   uint64_t VirtualMemSize{};
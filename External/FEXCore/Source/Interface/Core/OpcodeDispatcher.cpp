@@ -7,6 +7,7 @@ $end_info$
 
 #include "Interface/Context/Context.h"
 #include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/ReadOnlyRegions.h"
 
 #include <FEXCore/Config/Config.h>
 #include <FEXCore/Core/Context.h>
@@ -22,6 +23,7 @@ $end_info$
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <tuple>
 
 namespace FEXCore::IR {
@@ -138,7 +140,7 @@ void OpDispatchBuilder::ThunkOp(OpcodeArgs) {
   _StoreContext(GPRClass, GPRSize, RSPOffset, NewSP);
 
   // Store the new RIP
-  _ExitFunction(NewRIP);
+  _GuestReturn(NewRIP);
   BlockSetRIP = true;
 }
 
@@ -194,7 +196,7 @@ void OpDispatchBuilder::RETOp(OpcodeArgs) {
   _StoreContext(GPRClass, GPRSize, RSPOffset, NewSP);
 
   // Store the new RIP
-  _ExitFunction(NewRIP);
+  _GuestReturn(NewRIP);
   BlockSetRIP = true;
 }
 
@@ -752,8 +754,16 @@ void OpDispatchBuilder::CALLOp(OpcodeArgs) {
 
   _StoreMem(GPRClass, GPRSize, NewSP, ConstantPCReturn, GPRSize);
 
+  // Calls through a PLT stub go straight to what its GOT slot points at
+  uint64_t Slot{};
+  if (Op->Src[0].IsLiteral() &&
+      FindPLTSlot(Op->PC + Op->InstSize + Op->Src[0].Data.Literal.Value, &Slot) &&
+      BranchThroughSlot(Slot, ConstantPCReturn)) {
+    return;
+  }
+
   // Store the RIP
-  _ExitFunction(NewRIP); // If we get here then leave the function now
+  _GuestCall(NewRIP, ConstantPCReturn); // If we get here then leave the function now
 }
 
 void OpDispatchBuilder::CALLAbsoluteOp(OpcodeArgs) {
@@ -780,8 +790,13 @@ void OpDispatchBuilder::CALLAbsoluteOp(OpcodeArgs) {
 
   _StoreMem(GPRClass, Size, NewSP, ConstantPCReturn, Size);
 
+  uint64_t Slot{};
+  if (GetRIPRelativeSlot(Op, &Slot) && BranchThroughSlot(Slot, ConstantPCReturn)) {
+    return;
+  }
+
   // Store the RIP
-  _ExitFunction(JMPPCOffset); // If we get here then leave the function now
+  _GuestCall(JMPPCOffset, ConstantPCReturn); // If we get here then leave the function now
 }
 
 OrderedNode *OpDispatchBuilder::SelectCC(uint8_t OP, OrderedNode *TrueValue, OrderedNode *FalseValue) {
@@ -1282,6 +1297,14 @@ void OpDispatchBuilder::JUMPOp(OpcodeArgs) {
     TargetRIP &= 0xFFFFFFFFU;
   }
 
+  // Tail calls through a PLT stub that isn't part of this function
+  uint64_t Slot{};
+  if (JumpTargets.find(TargetRIP) == JumpTargets.end() &&
+      FindPLTSlot(TargetRIP, &Slot) &&
+      BranchThroughSlot(Slot, nullptr)) {
+    return;
+  }
+
   // This is just an unconditional relative literal jump
   if (Multiblock) {
     auto JumpBlock = JumpTargets.find(TargetRIP);
@@ -1316,6 +1339,16 @@ void OpDispatchBuilder::JUMPAbsoluteOp(OpcodeArgs) {
   CalculateDeferredFlags();
 
   BlockSetRIP = true;
+
+  uint64_t Slot{};
+  if (GetRIPRelativeSlot(Op, &Slot) && BranchThroughSlot(Slot, nullptr)) {
+    return;
+  }
+
+  if (JumpThroughReadOnlyTable(Op)) {
+    return;
+  }
+
   // This is just an unconditional jump
   // This uses ModRM to determine its location
   // No way to use this effectively in multiblock
@@ -4460,6 +4493,7 @@ void OpDispatchBuilder::CreateJumpBlocks(std::vector<FEXCore::Frontend::Decoder:
 
 void OpDispatchBuilder::BeginFunction(uint64_t RIP, std::vector<FEXCore::Frontend::Decoder::DecodedBlocks> const *Blocks) {
   Entry = RIP;
+  ReadOnlyPages.clear();
   auto IRHeader = _IRHeader(InvalidNode, 0);
   Current_Header = IRHeader.first;
   Current_HeaderNode = IRHeader;
@@ -4603,6 +4637,9 @@ OrderedNode *OpDispatchBuilder::LoadSource_WithOpSize(FEXCore::IR::RegisterClass
   OrderedNode *Src {nullptr};
   bool LoadableType = false;
   bool StackAccess = false;
+  // The address is known at compile time
+  bool StaticAddress = false;
+  uint64_t Address{};
   const uint8_t GPRSize = CTX->GetGPRSize();
   const uint32_t AddrSize = (Op->Flags & X86Tables::DecodeFlags::FLAG_ADDRESS_SIZE) != 0 ? (GPRSize >> 1) : GPRSize;
 
@@ -4645,6 +4682,8 @@ OrderedNode *OpDispatchBuilder::LoadSource_WithOpSize(FEXCore::IR::RegisterClass
   else if (Operand.IsRIPRelative()) {
     if (CTX->Config.Is64BitMode) {
       Src = GetRelocatedPC(Op, Operand.Data.RIPLiteral.Value.s);
+      StaticAddress = true;
+      Address = Op->PC + Op->InstSize + Operand.Data.RIPLiteral.Value.s;
     }
     else {
       // 32bit this isn't RIP relative but instead absolute
@@ -4683,6 +4722,9 @@ OrderedNode *OpDispatchBuilder::LoadSource_WithOpSize(FEXCore::IR::RegisterClass
       }
       else {
         Src = _Constant(GPRSize * 8, Operand.Data.SIB.Offset);
+        // 32bit has segment bases to apply
+        StaticAddress = CTX->Config.Is64BitMode;
+        Address = static_cast<int64_t>(Operand.Data.SIB.Offset);
       }
     }
     else {
@@ -4707,6 +4749,14 @@ OrderedNode *OpDispatchBuilder::LoadSource_WithOpSize(FEXCore::IR::RegisterClass
   }
 
   if ((LoadableType && LoadData) || ForceLoad) {
+    if (StaticAddress && Class == GPRClass && AddrSize == GPRSize &&
+        !(Flags & (FEXCore::X86Tables::DecodeFlags::FLAG_FS_PREFIX | FEXCore::X86Tables::DecodeFlags::FLAG_GS_PREFIX))) {
+      // Memory that can't change doesn't need loading at runtime
+      if (auto Constant = LoadReadOnlyConstant(Address, OpSize)) {
+        return Constant;
+      }
+    }
+
     Src = AppendSegmentOffset(Src, Flags);
 
     if (StackAccess) {
@@ -4724,6 +4774,190 @@ OrderedNode *OpDispatchBuilder::GetRelocatedPC(FEXCore::X86Tables::DecodedOp con
   return _EntrypointOffset(Op->PC + Op->InstSize + Offset - Entry, GPRSize);
 }
 
+bool OpDispatchBuilder::ReadReadOnlyMemory(uint64_t Address, void *Data, size_t Size) {
+  if (!CTX->ReadOnlyRegions || !CTX->ReadOnlyRegions->Read(Address, Data, Size)) {
+    return false;
+  }
+
+  AddReadOnlyPages(Address, Size);
+  return true;
+}
+
+void OpDispatchBuilder::AddReadOnlyPages(uint64_t Address, size_t Size) {
+  for (uint64_t Page = Address >> 12, EndPage = (Address + Size - 1) >> 12; Page <= EndPage; ++Page) {
+    if (std::find(ReadOnlyPages.begin(), ReadOnlyPages.end(), Page) == ReadOnlyPages.end()) {
+      ReadOnlyPages.emplace_back(Page);
+    }
+  }
+}
+
+OrderedNode *OpDispatchBuilder::LoadReadOnlyConstant(uint64_t Address, uint8_t Size) {
+  if (Size != 1 && Size != 2 && Size != 4 && Size != 8) {
+    return nullptr;
+  }
+
+  uint64_t Value{};
+  if (!ReadReadOnlyMemory(Address, &Value, Size)) {
+    return nullptr;
+  }
+
+  return _Constant(Size * 8, Value);
+}
+
+bool OpDispatchBuilder::JumpThroughReadOnlyTable(OpcodeArgs) {
+  // Switch statements past this many cases go through the indirect jump for the rest
+  constexpr size_t MAX_TABLE_ENTRIES = 8;
+
+  auto const &Src = Op->Src[0];
+  if (!CTX->ReadOnlyRegions || !Src.IsSIB() ||
+      Src.Data.SIB.Index == FEXCore::X86State::REG_INVALID ||
+      Src.Data.SIB.Base != FEXCore::X86State::REG_INVALID ||
+      Src.Data.SIB.Scale != 8 ||
+      GetSrcSize(Op) != 8 ||
+      (Op->Flags & (FEXCore::X86Tables::DecodeFlags::FLAG_ADDRESS_SIZE |
+                    FEXCore::X86Tables::DecodeFlags::FLAG_FS_PREFIX |
+                    FEXCore::X86Tables::DecodeFlags::FLAG_GS_PREFIX))) {
+    return false;
+  }
+
+  const uint64_t Table = static_cast<int64_t>(Src.Data.SIB.Offset);
+  std::array<uint64_t, MAX_TABLE_ENTRIES> Targets;
+  size_t NumTargets{};
+  for (; NumTargets < Targets.size(); ++NumTargets) {
+    uint64_t Target{};
+    // The table ends at the first entry that doesn't point at read-only memory
+    // Reading past the end is fine, the branch for an index is only taken where the load gives the same target
+    if (!ReadReadOnlyMemory(Table + NumTargets * 8, &Target, 8) ||
+        !CTX->ReadOnlyRegions->Contains(Target, 1)) {
+      break;
+    }
+    Targets[NumTargets] = Target;
+  }
+
+  if (NumTargets == 0) {
+    return false;
+  }
+
+  auto Index = _LoadContext(8, offsetof(FEXCore::Core::CPUState, gregs[Src.Data.SIB.Index]), GPRClass);
+  auto CurrentBlock = GetCurrentBlock();
+
+  for (size_t i = 0; i < NumTargets; ++i) {
+    auto CondJump = _CondJump(Index, _Constant(i), InvalidNode, InvalidNode, {COND_EQ}, 8);
+
+    auto TargetBlock = JumpTargets.find(Targets[i]);
+    if (TargetBlock != JumpTargets.end()) {
+      SetTrueJumpTarget(CondJump, TargetBlock->second.BlockEntry);
+    }
+    else {
+      auto JumpTarget = CreateNewCodeBlockAtEnd();
+      SetTrueJumpTarget(CondJump, JumpTarget);
+      SetCurrentCodeBlock(JumpTarget);
+
+      _ExitFunction(_EntrypointOffset(Targets[i] - Entry, 8));
+    }
+
+    auto NextBlock = CreateNewCodeBlockAfter(CurrentBlock);
+    SetFalseJumpTarget(CondJump, NextBlock);
+    SetCurrentCodeBlock(NextBlock);
+    CurrentBlock = NextBlock;
+  }
+
+  // Entries past the ones we read load the target at runtime
+  auto RIPOffset = LoadSource(GPRClass, Op, Src, Op->Flags, -1);
+  _ExitFunction(RIPOffset);
+  return true;
+}
+
+bool OpDispatchBuilder::FindPLTSlot(uint64_t Target, uint64_t *Slot) {
+  // Long enough for `endbr64; bnd jmp [rip + disp32]`
+  std::array<uint8_t, 11> Code{};
+  // Most targets aren't stubs, their pages only get recorded once the stub matched
+  if (!CTX->ReadOnlyRegions || !CTX->ReadOnlyRegions->Read(Target, Code.data(), Code.size())) {
+    return false;
+  }
+
+  size_t Offset{};
+  // endbr64 in IBT enabled stubs
+  if (Code[0] == 0xF3 && Code[1] == 0x0F && Code[2] == 0x1E && Code[3] == 0xFA) {
+    Offset += 4;
+  }
+  // bnd prefix from MPX enabled toolchains
+  if (Code[Offset] == 0xF2) {
+    ++Offset;
+  }
+  // jmp [rip + disp32]
+  if (Code[Offset] != 0xFF || Code[Offset + 1] != 0x25) {
+    return false;
+  }
+
+  int32_t Displacement{};
+  memcpy(&Displacement, &Code[Offset + 2], sizeof(Displacement));
+  *Slot = Target + Offset + 6 + Displacement;
+  AddReadOnlyPages(Target, Offset + 6);
+  return true;
+}
+
+bool OpDispatchBuilder::GetRIPRelativeSlot(OpcodeArgs, uint64_t *Slot) {
+  auto const &Src = Op->Src[0];
+  if (!CTX->Config.Is64BitMode || !Src.IsRIPRelative() || GetSrcSize(Op) != 8 ||
+      (Op->Flags & (FEXCore::X86Tables::DecodeFlags::FLAG_ADDRESS_SIZE |
+                    FEXCore::X86Tables::DecodeFlags::FLAG_FS_PREFIX |
+                    FEXCore::X86Tables::DecodeFlags::FLAG_GS_PREFIX))) {
+    return false;
+  }
+
+  *Slot = Op->PC + Op->InstSize + Src.Data.RIPLiteral.Value.s;
+  return true;
+}
+
+bool OpDispatchBuilder::BranchThroughSlot(uint64_t Slot, OrderedNode *ReturnRIP) {
+  const auto Exit = [this, ReturnRIP](OrderedNode *NewRIP) {
+    if (ReturnRIP) {
+      _GuestCall(NewRIP, ReturnRIP);
+    }
+    else {
+      _ExitFunction(NewRIP);
+    }
+  };
+
+  // Bound at load time, or made read-only by RELRO
+  if (auto Target = LoadReadOnlyConstant(Slot, 8)) {
+    Exit(Target);
+    return true;
+  }
+
+  uint64_t Guess{};
+  if (!CTX->ReadOnlyRegions || !CTX->ReadOnlyRegions->ReadCurrent(Slot, &Guess, sizeof(Guess))) {
+    return false;
+  }
+
+  // Slots that lazy binding hasn't resolved yet point at `push <index>; jmp <resolver>` in the PLT,
+  // which is the wrong guess for every call after the first
+  std::array<uint8_t, 5> Code{};
+  if (!CTX->ReadOnlyRegions->Read(Guess, Code.data(), Code.size())) {
+    return false;
+  }
+  const bool HasEndbr = Code[0] == 0xF3 && Code[1] == 0x0F && Code[2] == 0x1E && Code[3] == 0xFA;
+  if (Code[HasEndbr ? 4 : 0] == 0x68) {
+    return false;
+  }
+
+  auto CondJump = _CondJump(_LoadMemAutoTSO(GPRClass, 8, _Constant(Slot), 8), _Constant(Guess), InvalidNode, InvalidNode, {COND_EQ}, 8);
+
+  // Placed after this block for fallthrough
+  auto GuessBlock = CreateNewCodeBlockAfter(GetCurrentBlock());
+  SetTrueJumpTarget(CondJump, GuessBlock);
+  SetCurrentCodeBlock(GuessBlock);
+  Exit(_EntrypointOffset(Guess - Entry, 8));
+
+  // The slot changed since, reloaded rather than carrying the value across blocks
+  auto MissBlock = CreateNewCodeBlockAtEnd();
+  SetFalseJumpTarget(CondJump, MissBlock);
+  SetCurrentCodeBlock(MissBlock);
+  Exit(_LoadMemAutoTSO(GPRClass, 8, _Constant(Slot), 8));
+  return true;
+}
+
 OrderedNode *OpDispatchBuilder::LoadSource(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint32_t Flags, int8_t Align, bool LoadData, bool ForceLoad) {
   const uint8_t OpSize = GetSrcSize(Op);
   return LoadSource_WithOpSize(Class, Op, Operand, OpSize, Flags, Align, LoadData, ForceLoad);
@@ -155,6 +155,8 @@ public:
   void BeginFunction(uint64_t RIP, std::vector<FEXCore::Frontend::Decoder::DecodedBlocks> const *Blocks);
   void Finalize();
 
+  std::vector<uint64_t> const &GetReadOnlyPages() const { return ReadOnlyPages; }
+
   // Dispatch builder functions
 #define OpcodeArgs [[maybe_unused]] FEXCore::X86Tables::DecodedOp Op
   void UnhandledOp(OpcodeArgs);
@@ -562,6 +564,36 @@ private:
   OrderedNode *AppendSegmentOffset(OrderedNode *Value, uint32_t Flags, uint32_t DefaultPrefix = 0, bool Override = false);
 
   OrderedNode *GetRelocatedPC(FEXCore::X86Tables::DecodedOp const& Op, int64_t Offset = 0);
+
+  /**
+   * @brief Reads guest memory at compile time if it can't change while the code exists
+   *
+   * The pages read are recorded so the code gets invalidated along with the memory.
+   */
+  bool ReadReadOnlyMemory(uint64_t Address, void *Data, size_t Size);
+  // The code gets invalidated along with these pages
+  void AddReadOnlyPages(uint64_t Address, size_t Size);
+  // nullptr if the memory could change
+  OrderedNode *LoadReadOnlyConstant(uint64_t Address, uint8_t Size);
+  // Turns `jmp [table + index * 8]` in to a direct branch per table entry, false if the table isn't read-only
+  bool JumpThroughReadOnlyTable(FEXCore::X86Tables::DecodedOp Op);
+
+  // Finds the GOT slot a PLT stub at Target jumps through
+  bool FindPLTSlot(uint64_t Target, uint64_t *Slot);
+  // The code pointer a `jmp/call [rip + disp]` goes through
+  bool GetRIPRelativeSlot(FEXCore::X86Tables::DecodedOp Op, uint64_t *Slot);
+
+  /**
+   * @brief Leaves the block through the code pointer at Slot with a direct exit where possible
+   *
+   * Read-only slots give a constant target. Writable ones, like GOT slots with lazy binding, compare
+   * against the target they have now and only take the indirect exit when that changed.
+   *
+   * @param ReturnRIP Leaves through a GuestCall when set
+   *
+   * @return false without emitting anything if the target can't be known
+   */
+  bool BranchThroughSlot(uint64_t Slot, OrderedNode *ReturnRIP);
   OrderedNode *LoadSource(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint32_t Flags, int8_t Align, bool LoadData = true, bool ForceLoad = false);
   OrderedNode *LoadSource_WithOpSize(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint8_t OpSize, uint32_t Flags, int8_t Align, bool LoadData = true, bool ForceLoad = false);
   void StoreResult_WithOpSize(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp Op, FEXCore::X86Tables::DecodedOperand const& Operand, OrderedNode *const Src, uint8_t OpSize, int8_t Align);
@@ -1133,6 +1165,8 @@ private:
 
   bool Multiblock{};
   uint64_t Entry;
+  // Pages of read-only memory the current function folded loads from
+  std::vector<uint64_t> ReadOnlyPages;
 
   OrderedNode* _StoreMemAutoTSO(FEXCore::IR::RegisterClassType Class, uint8_t Size, OrderedNode *ssa0, OrderedNode *ssa1, uint8_t Align = 1) {
     if (CTX->Config.TSOEnabled)
@@ -0,0 +1,195 @@
+/*
+$info$
+tags: glue|memory
+desc: Tracks the guest memory that can't change for folding loads in to code
+$end_info$
+*/
+
+#include "Interface/Core/ReadOnlyRegions.h"
+
+#include <FEXCore/Utils/MathUtils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <sys/mman.h>
+#include <utility>
+
+namespace FEXCore {
+  constexpr uintptr_t PAGE_SIZE = 4096;
+
+  static std::pair<uintptr_t, uintptr_t> GetPageRange(uintptr_t Base, uintptr_t Size) {
+    const uintptr_t Start = AlignDown(Base, PAGE_SIZE);
+    constexpr uintptr_t LastPage = AlignDown(std::numeric_limits<uintptr_t>::max(), PAGE_SIZE);
+    // Ranges that wrap can't be mapped, cover everything after the start
+    if (Size > LastPage - Base) {
+      return {Start, LastPage};
+    }
+    return {Start, AlignUp(Base + Size, PAGE_SIZE)};
+  }
+
+  void ReadOnlyRegions::Insert(RangeMap *Ranges, uintptr_t Start, uintptr_t End) {
+    auto It = Ranges->upper_bound(Start);
+    if (It != Ranges->begin()) {
+      auto Prev = std::prev(It);
+      if (Prev->second >= Start) {
+        Start = Prev->first;
+        End = std::max(End, Prev->second);
+        Ranges->erase(Prev);
+      }
+    }
+
+    while (It != Ranges->end() && It->first <= End) {
+      End = std::max(End, It->second);
+      It = Ranges->erase(It);
+    }
+
+    Ranges->emplace(Start, End);
+  }
+
+  void ReadOnlyRegions::Erase(RangeMap *Ranges, uintptr_t Start, uintptr_t End) {
+    auto It = Ranges->upper_bound(Start);
+    if (It != Ranges->begin()) {
+      auto Prev = std::prev(It);
+      if (Prev->second > Start) {
+        const auto [PrevStart, PrevEnd] = *Prev;
+        Ranges->erase(Prev);
+        if (PrevStart < Start) {
+          Ranges->emplace(PrevStart, Start);
+        }
+        if (PrevEnd > End) {
+          Ranges->emplace(End, PrevEnd);
+          return;
+        }
+      }
+    }
+
+    while (It != Ranges->end() && It->first < End) {
+      const auto ItEnd = It->second;
+      It = Ranges->erase(It);
+      if (ItEnd > End) {
+        Ranges->emplace(End, ItEnd);
+        break;
+      }
+    }
+  }
+
+  bool ReadOnlyRegions::Covers(RangeMap const &Ranges, uintptr_t Start, uintptr_t End) {
+    auto It = Ranges.upper_bound(Start);
+    if (It == Ranges.begin()) {
+      return false;
+    }
+    --It;
+    // Touching ranges are merged so one range has to cover all of it
+    return It->first <= Start && It->second >= End;
+  }
+
+  static bool IsReadOnly(int Prot) {
+    return (Prot & PROT_READ) && !(Prot & PROT_WRITE);
+  }
+
+  void ReadOnlyRegions::AddMapping(uintptr_t Base, uintptr_t Size, bool PrivateFile, int Prot) {
+    const auto [Start, End] = GetPageRange(Base, Size);
+
+    std::unique_lock lk(Mutex);
+    // A new mapping replaces whatever was there before
+    Erase(&PrivateFileRanges, Start, End);
+    Erase(&ReadableRanges, Start, End);
+    Erase(&ReadOnlyRanges, Start, End);
+
+    if (PrivateFile) {
+      Insert(&PrivateFileRanges, Start, End);
+      if (Prot & PROT_READ) {
+        Insert(&ReadableRanges, Start, End);
+      }
+      if (IsReadOnly(Prot)) {
+        Insert(&ReadOnlyRanges, Start, End);
+      }
+    }
+  }
+
+  void ReadOnlyRegions::RemoveMapping(uintptr_t Base, uintptr_t Size) {
+    const auto [Start, End] = GetPageRange(Base, Size);
+
+    std::unique_lock lk(Mutex);
+    Erase(&PrivateFileRanges, Start, End);
+    Erase(&ReadableRanges, Start, End);
+    Erase(&ReadOnlyRanges, Start, End);
+  }
+
+  void ReadOnlyRegions::ProtectMapping(uintptr_t Base, uintptr_t Size, int Prot) {
+    const auto [Start, End] = GetPageRange(Base, Size);
+
+    std::unique_lock lk(Mutex);
+    if (!(Prot & PROT_READ)) {
+      Erase(&ReadableRanges, Start, End);
+    }
+    if (!IsReadOnly(Prot)) {
+      Erase(&ReadOnlyRanges, Start, End);
+    }
+    if (!(Prot & PROT_READ)) {
+      return;
+    }
+
+    // Only the private file mapped parts of the range
+    auto It = PrivateFileRanges.upper_bound(Start);
+    if (It != PrivateFileRanges.begin()) {
+      --It;
+    }
+    for (; It != PrivateFileRanges.end() && It->first < End; ++It) {
+      const auto PartStart = std::max(Start, It->first);
+      const auto PartEnd = std::min(End, It->second);
+      if (PartStart < PartEnd) {
+        Insert(&ReadableRanges, PartStart, PartEnd);
+        if (IsReadOnly(Prot)) {
+          Insert(&ReadOnlyRanges, PartStart, PartEnd);
+        }
+      }
+    }
+  }
+
+  bool ReadOnlyRegions::Read(uintptr_t Address, void *Data, size_t Size) const {
+    if (Size > std::numeric_limits<uintptr_t>::max() - Address) {
+      return false;
+    }
+
+    // Held while copying so the range can't be unmapped underneath us
+    std::shared_lock lk(Mutex);
+    if (!Covers(ReadOnlyRanges, Address, Address + Size)) {
+      return false;
+    }
+
+    memcpy(Data, reinterpret_cast<const void*>(Address), Size);
+    return true;
+  }
+
+  bool ReadOnlyRegions::ReadCurrent(uintptr_t Address, void *Data, size_t Size) const {
+    if (Size > std::numeric_limits<uintptr_t>::max() - Address) {
+      return false;
+    }
+
+    std::shared_lock lk(Mutex);
+    if (!Covers(ReadableRanges, Address, Address + Size)) {
+      return false;
+    }
+
+    memcpy(Data, reinterpret_cast<const void*>(Address), Size);
+    return true;
+  }
+
+  bool ReadOnlyRegions::Contains(uintptr_t Address, size_t Size) const {
+    if (Size > std::numeric_limits<uintptr_t>::max() - Address) {
+      return false;
+    }
+
+    std::shared_lock lk(Mutex);
+    return Covers(ReadOnlyRanges, Address, Address + Size);
+  }
+
+  void ReadOnlyRegions::CleanupAfterFork() {
+    // Another thread may have held this at the time of the fork
+    new (&Mutex) std::shared_mutex{};
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+
+namespace FEXCore {
+/**
+ * @brief Tracks which guest memory can't change while it stays mapped
+ *
+ * Only private file mappings without write permission count. The frontend reports every mapping
+ * change, and has to remove a range before the host mapping goes away or loses permissions so a
+ * compile in another thread never reads memory that is being changed underneath it.
+ */
+class ReadOnlyRegions final {
+public:
+  void AddMapping(uintptr_t Base, uintptr_t Size, bool PrivateFile, int Prot);
+  void RemoveMapping(uintptr_t Base, uintptr_t Size);
+
+  /**
+   * @brief Changes the protection of part of the tracked mappings
+   *
+   * Only the parts of the range that are private file mappings are affected.
+   */
+  void ProtectMapping(uintptr_t Base, uintptr_t Size, int Prot);
+
+  /**
+   * @brief Copies guest memory out if all of it is read-only
+   *
+   * @return false without touching Data when any of the range could change
+   */
+  bool Read(uintptr_t Address, void *Data, size_t Size) const;
+
+  /**
+   * @brief Copies out readable private file mapped memory, even if it is writable
+   *
+   * The value can change right after, it is only good as a guess that gets checked at runtime.
+   */
+  bool ReadCurrent(uintptr_t Address, void *Data, size_t Size) const;
+
+  bool Contains(uintptr_t Address, size_t Size) const;
+
+  void CleanupAfterFork();
+
+private:
+  // Start -> End of non overlapping ranges, touching ranges get merged
+  using RangeMap = std::map<uintptr_t, uintptr_t>;
+
+  static void Insert(RangeMap *Ranges, uintptr_t Start, uintptr_t End);
+  static void Erase(RangeMap *Ranges, uintptr_t Start, uintptr_t End);
+  static bool Covers(RangeMap const &Ranges, uintptr_t Start, uintptr_t End);
+
+  mutable std::shared_mutex Mutex;
+  RangeMap PrivateFileRanges;
+  // Subsets of the private file mappings
+  RangeMap ReadableRanges;
+  RangeMap ReadOnlyRanges;
+};
+}
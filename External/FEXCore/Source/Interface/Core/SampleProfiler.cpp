@@ -0,0 +1,312 @@
+/*
+$info$
+tags: glue|profiling
+desc: Samples guest threads on a CPU time timer and writes folded guest call stacks at exit
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/ArchHelpers/MContext.h"
+#include "Interface/Core/GuestSymbols.h"
+#include "Interface/Core/SampleProfiler.h"
+
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/SignalDelegator.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+#include <FEXHeaderUtils/Syscalls.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace FEXCore {
+  SampleProfilerThread::SampleProfilerThread() {
+    // Only the pages of stacks that get hit are ever touched
+    void *Ptr = FEXCore::Allocator::mmap(nullptr, TABLE_SIZE * sizeof(StackEntry), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (Ptr != MAP_FAILED) {
+      Table = reinterpret_cast<StackEntry*>(Ptr);
+    }
+  }
+
+  SampleProfilerThread::~SampleProfilerThread() {
+    // Timers aren't inherited across fork, so the timer is only deleted through Stop
+    if (Table) {
+      FEXCore::Allocator::munmap(Table, TABLE_SIZE * sizeof(StackEntry));
+    }
+  }
+
+  void SampleProfilerThread::Start(uint32_t Frequency) {
+    if (!Table || Frequency == 0) {
+      return;
+    }
+
+    struct sigevent Event{};
+    Event.sigev_notify = SIGEV_THREAD_ID;
+    Event.sigev_signo = SignalDelegator::SIGNAL_FOR_PROFILER;
+    Event._sigev_un._tid = FHU::Syscalls::gettid();
+
+    // Raw syscalls so glibc doesn't get involved with SIGEV_THREAD_ID bookkeeping
+    int NewTimer{};
+    if (::syscall(SYS_timer_create, CLOCK_THREAD_CPUTIME_ID, &Event, &NewTimer) != 0) {
+      LogMan::Msg::EFmt("Couldn't create the sampling profiler timer: {}", strerror(errno));
+      return;
+    }
+
+    const uint64_t Interval = std::max<uint64_t>(1'000'000'000ULL / Frequency, 1);
+    struct itimerspec Spec{};
+    Spec.it_interval.tv_sec = Interval / 1'000'000'000ULL;
+    Spec.it_interval.tv_nsec = Interval % 1'000'000'000ULL;
+    Spec.it_value = Spec.it_interval;
+
+    TimerID = NewTimer;
+    Active.store(true);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    if (::syscall(SYS_timer_settime, TimerID, 0, &Spec, nullptr) != 0) {
+      LogMan::Msg::EFmt("Couldn't arm the sampling profiler timer: {}", strerror(errno));
+      Stop();
+    }
+  }
+
+  void SampleProfilerThread::Stop() {
+    if (TimerID != -1) {
+      ::syscall(SYS_timer_delete, TimerID);
+      TimerID = -1;
+    }
+
+    // A signal could still be pending from before the delete
+    Active.store(false);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+
+  void SampleProfilerThread::Reset() {
+    if (Table) {
+      memset(Table, 0, TABLE_SIZE * sizeof(StackEntry));
+    }
+    DroppedSamples = 0;
+  }
+
+  void SampleProfilerThread::AddBlock(uintptr_t HostCode, size_t HostSize, uint64_t GuestRIP) {
+    Updating.store(true, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    Blocks.insert_or_assign(HostCode, BlockRange{HostCode + HostSize, GuestRIP});
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    Updating.store(false, std::memory_order_relaxed);
+  }
+
+  void SampleProfilerThread::EraseHostCodeRange(uintptr_t HostStart, uintptr_t HostEnd) {
+    Updating.store(true, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    Blocks.erase(Blocks.lower_bound(HostStart), Blocks.lower_bound(HostEnd));
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    Updating.store(false, std::memory_order_relaxed);
+  }
+
+  void SampleProfilerThread::ClearBlocks() {
+    Updating.store(true, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    Blocks.clear();
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    Updating.store(false, std::memory_order_relaxed);
+  }
+
+  void SampleProfilerThread::Sample(FEXCore::Core::CpuStateFrame *Frame, uintptr_t HostPC) {
+    // Only reentrant if the guest asked for SA_NODEFER on our signal
+    if (!Active.load(std::memory_order_relaxed) || InHandler.exchange(true, std::memory_order_relaxed)) {
+      return;
+    }
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    if (Updating.load(std::memory_order_relaxed)) {
+      // The thread is changing its block index, all we know is that it is inside of FEX
+      uint64_t Frames[] = {FEX_FRAME, Frame->State.rip};
+      Record(Frames, 2);
+    }
+    else {
+      SampleStack(Frame, HostPC);
+    }
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    InHandler.store(false, std::memory_order_relaxed);
+  }
+
+  void SampleProfilerThread::SampleStack(FEXCore::Core::CpuStateFrame *Frame, uintptr_t HostPC) {
+    uint64_t Frames[MAX_STACK_DEPTH];
+    uint32_t Depth{};
+
+    auto Block = Blocks.upper_bound(HostPC);
+    if (Block != Blocks.begin() && HostPC < std::prev(Block)->second.HostEnd) {
+      // Attributed to the start of the block, State.rip is stale while blocks are linked
+      Frames[Depth++] = std::prev(Block)->second.GuestRIP;
+    }
+    else {
+      // Dispatcher, compiler or syscall handling, all of which have stored the guest RIP
+      Frames[Depth++] = FEX_FRAME;
+      Frames[Depth++] = Frame->State.rip;
+    }
+
+    // Walk the return stack from the most recent call
+    // Popped entries aren't cleared, so anything older than a wrap or a longjmp is only a best guess
+    uint64_t Offset = Frame->ReturnStackOffset;
+    for (size_t i = 0; i < FEXCore::Core::CpuStateFrame::RETURN_STACK_SIZE && Depth < MAX_STACK_DEPTH; ++i) {
+      Offset = (Offset - sizeof(uint64_t)) & FEXCore::Core::CpuStateFrame::RETURN_STACK_MASK;
+      auto LinkRecord = Frame->ReturnStack[Offset / sizeof(uint64_t)];
+      if (!LinkRecord) {
+        break;
+      }
+
+      // Link records are {HostCode, GuestRIP}
+      Frames[Depth++] = reinterpret_cast<uint64_t const*>(LinkRecord)[1];
+    }
+
+    Record(Frames, Depth);
+  }
+
+  void SampleProfilerThread::Record(uint64_t const *Frames, uint32_t Depth) {
+    uint64_t Hash = Depth;
+    for (uint32_t i = 0; i < Depth; ++i) {
+      Hash = (Hash ^ Frames[i]) * 0x100000001b3ULL;
+    }
+
+    for (size_t Probe = 0; Probe < MAX_PROBE; ++Probe) {
+      auto &Entry = Table[(Hash + Probe) & (TABLE_SIZE - 1)];
+      if (Entry.Count == 0) {
+        Entry.Hash = Hash;
+        Entry.Depth = Depth;
+        memcpy(Entry.Frames, Frames, Depth * sizeof(uint64_t));
+        Entry.Count = 1;
+        return;
+      }
+
+      if (Entry.Hash == Hash &&
+          Entry.Depth == Depth &&
+          memcmp(Entry.Frames, Frames, Depth * sizeof(uint64_t)) == 0) {
+        ++Entry.Count;
+        return;
+      }
+    }
+
+    ++DroppedSamples;
+  }
+
+  SampleProfiler::SampleProfiler(FEXCore::Context::Context *CTX, std::string const &OutputFolder, uint32_t Frequency)
+    : CTX {CTX}
+    , OutputFolder {OutputFolder}
+    , Frequency {Frequency} {
+  }
+
+  void SampleProfiler::RegisterSignalHandler() {
+    CTX->SignalDelegation->RegisterHostSignalHandler(SignalDelegator::SIGNAL_FOR_PROFILER, [](FEXCore::Core::InternalThreadState *Thread, int Signal, void *info, void *ucontext) -> bool {
+      if (Thread->SampleProfiler) {
+        Thread->SampleProfiler->Sample(Thread->CurrentFrame, ArchHelpers::Context::GetPc(ucontext));
+      }
+      // Never the guest's, even if it raced with the thread shutting down
+      return true;
+    }, true);
+  }
+
+  void SampleProfiler::StartThread(FEXCore::Core::InternalThreadState *Thread) {
+    if (!Thread->SampleProfiler) {
+      Thread->SampleProfiler = std::make_unique<SampleProfilerThread>();
+    }
+    Thread->SampleProfiler->Start(Frequency);
+  }
+
+  void SampleProfiler::StopThread(FEXCore::Core::InternalThreadState *Thread) {
+    auto ThreadProfiler = Thread->SampleProfiler.get();
+    if (!ThreadProfiler) {
+      return;
+    }
+
+    ThreadProfiler->Stop();
+
+    std::lock_guard lk(StacksMutex);
+    ThreadProfiler->VisitStacks([this](uint64_t const *Frames, uint32_t Depth, uint64_t Count) {
+      Stacks[std::vector<uint64_t>(Frames, Frames + Depth)] += Count;
+    });
+    DroppedSamples += ThreadProfiler->GetDroppedSamples();
+
+    ThreadProfiler->Reset();
+  }
+
+  void SampleProfiler::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // Another thread may have held these at the time of the fork
+    new (&StacksMutex) std::mutex{};
+
+    Stacks.clear();
+    DroppedSamples = 0;
+
+    if (LiveThread->SampleProfiler) {
+      // Timers don't survive fork, the old id means nothing now
+      LiveThread->SampleProfiler->Stop();
+      LiveThread->SampleProfiler->Reset();
+      LiveThread->SampleProfiler->Start(Frequency);
+    }
+  }
+
+  std::string SampleProfiler::GetFrameName(uint64_t RIP, bool IsReturnAddress) {
+    if (RIP == SampleProfilerThread::FEX_FRAME) {
+      return "[FEX]";
+    }
+
+    auto Name = CTX->GuestSymbols->GetName(RIP, IsReturnAddress);
+
+    // ';' separates frames in the folded format and the count follows the last space
+    std::replace(Name.begin(), Name.end(), ';', ':');
+    std::replace(Name.begin(), Name.end(), ' ', '_');
+    return Name;
+  }
+
+  void SampleProfiler::WriteProfile(std::string const &Application) {
+    std::lock_guard lk(StacksMutex);
+
+    if (Stacks.empty()) {
+      return;
+    }
+
+    const auto Filename = fmt::format("{}/{}-{}.folded", OutputFolder, std::filesystem::path(Application).filename().string(), ::getpid());
+    FILE *fp = fopen(Filename.c_str(), "w");
+    if (!fp) {
+      LogMan::Msg::EFmt("Couldn't open sample profile '{}': {}", Filename, strerror(errno));
+      return;
+    }
+
+    uint64_t TotalSamples{};
+    std::string Line;
+    for (auto const &[Frames, Count] : Stacks) {
+      // Folded stacks go from the outermost caller to the leaf
+      Line.clear();
+      for (size_t i = Frames.size(); i > 0; --i) {
+        const size_t Index = i - 1;
+        // Only frames past the leaf come from the return stack
+        const bool IsReturnAddress = Index != 0 && !(Index == 1 && Frames[0] == SampleProfilerThread::FEX_FRAME);
+        if (!Line.empty()) {
+          Line += ';';
+        }
+        Line += GetFrameName(Frames[Index], IsReturnAddress);
+      }
+
+      fmt::print(fp, "{} {}\n", Line, Count);
+      TotalSamples += Count;
+    }
+
+    fclose(fp);
+
+    LogMan::Msg::IFmt("Sample profile: {} samples written to '{}', {} dropped", TotalSamples, Filename, DroppedSamples);
+  }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+namespace Core {
+  struct CpuStateFrame;
+  struct InternalThreadState;
+}
+
+/**
+ * @brief Per thread side of the sampling profiler
+ *
+ * A CPU time timer on the thread raises SIGNAL_FOR_PROFILER, the handler attributes the interrupted host PC to a guest
+ * block and walks the guest return stack for the callers. Stacks are counted in a fixed size table so the handler
+ * never allocates or takes a lock.
+ *
+ * Everything but `Sample` must only be called from the owning thread.
+ */
+class SampleProfilerThread final {
+public:
+  // Frame recorded for samples that landed outside of JIT code
+  constexpr static uint64_t FEX_FRAME = ~0ULL;
+  constexpr static size_t MAX_STACK_DEPTH = 32;
+
+  SampleProfilerThread();
+  ~SampleProfilerThread();
+
+  SampleProfilerThread(SampleProfilerThread const&) = delete;
+  SampleProfilerThread& operator=(SampleProfilerThread const&) = delete;
+
+  /**
+   * @brief Arms the sampling timer for the calling thread
+   *
+   * @param Frequency Samples per second of thread CPU time
+   */
+  void Start(uint32_t Frequency);
+
+  /**
+   * @brief Disarms the timer, samples stay around until `Reset`
+   */
+  void Stop();
+
+  // Drops all samples
+  void Reset();
+
+  /**
+   * @name Host code to guest block index
+   *
+   * Mirrors the blocks in the backend's code buffers so the handler can find the block a host PC belongs to.
+   * @{ */
+    void AddBlock(uintptr_t HostCode, size_t HostSize, uint64_t GuestRIP);
+    void EraseHostCodeRange(uintptr_t HostStart, uintptr_t HostEnd);
+    void ClearBlocks();
+  /**  @} */
+
+  /**
+   * @brief Records a sample, called from the signal handler
+   *
+   * @param Frame The thread's frame
+   * @param HostPC The interrupted host PC
+   */
+  void Sample(FEXCore::Core::CpuStateFrame *Frame, uintptr_t HostPC);
+
+  /**
+   * @brief Visits every distinct stack that was sampled
+   *
+   * Frames are ordered leaf first. Return addresses are recorded as is for every frame but the leaf.
+   */
+  template<typename Visitor>
+  void VisitStacks(Visitor &&Visit) const {
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+      auto const &Entry = Table[i];
+      if (Entry.Count) {
+        Visit(Entry.Frames, Entry.Depth, Entry.Count);
+      }
+    }
+  }
+
+  uint64_t GetDroppedSamples() const { return DroppedSamples; }
+
+private:
+  constexpr static size_t TABLE_SIZE = 4096; // Must be a power of 2
+  constexpr static size_t MAX_PROBE = 32;
+
+  struct StackEntry {
+    uint64_t Count;
+    uint64_t Hash;
+    uint32_t Depth;
+    uint64_t Frames[MAX_STACK_DEPTH];
+  };
+
+  struct BlockRange {
+    uintptr_t HostEnd;
+    uint64_t GuestRIP;
+  };
+
+  void SampleStack(FEXCore::Core::CpuStateFrame *Frame, uintptr_t HostPC);
+  void Record(uint64_t const *Frames, uint32_t Depth);
+
+  // Kernel timer id, -1 while not armed
+  int TimerID{-1};
+
+  // Handler ignores samples while false
+  std::atomic<bool> Active{};
+  // Set while the thread is changing the block index
+  std::atomic<bool> Updating{};
+  std::atomic<bool> InHandler{};
+
+  // Keyed by host start
+  std::map<uintptr_t, BlockRange> Blocks;
+
+  StackEntry *Table{};
+  uint64_t DroppedSamples{};
+};
+
+/**
+ * @brief Process wide side of the sampling profiler
+ *
+ * Threads hand their samples over when they exit and the merged stacks are written out in the folded format
+ * that flamegraph tools consume.
+ */
+class SampleProfiler final {
+public:
+  SampleProfiler(FEXCore::Context::Context *CTX, std::string const &OutputFolder, uint32_t Frequency);
+
+  void RegisterSignalHandler();
+
+  // Called on the thread itself when it starts and stops executing
+  void StartThread(FEXCore::Core::InternalThreadState *Thread);
+  void StopThread(FEXCore::Core::InternalThreadState *Thread);
+
+  // Only the live thread continues sampling, dead threads' samples belong to the parent
+  void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+  /**
+   * @brief Writes every merged stack to `<OutputFolder>/<Application>-<PID>.folded`
+   */
+  void WriteProfile(std::string const &Application);
+
+private:
+  std::string GetFrameName(uint64_t RIP, bool IsReturnAddress);
+
+  FEXCore::Context::Context *CTX;
+  std::string const OutputFolder;
+  uint32_t const Frequency;
+
+  std::mutex StacksMutex;
+  // Leaf first frames to sample count
+  std::map<std::vector<uint64_t>, uint64_t> Stacks;
+  uint64_t DroppedSamples{};
+};
+}
@@ -1,4 +1,5 @@
 #include "Interface/Context/Context.h"
+#include "Interface/Core/LocalIRCache.h"
 #include "Interface/IR/AOTIR.h"
 
 #include <FEXCore/IR/IntrusiveIRList.h>
@@ -351,7 +352,7 @@ namespace FEXCore::IR {
       if (GeneratedIR) {
         // Add to thread local ir cache
         Core::LocalIREntry Entry = {StartAddr, Length, decltype(Entry.IR)(IRList), decltype(Entry.RAData)(RAData), decltype(Entry.DebugData)(DebugData)};
-        Thread->LocalIRCache.insert({GuestRIP, std::move(Entry)});
+        Thread->LocalIRCache->Insert(GuestRIP, std::move(Entry));
       }
     }
 
@@ -12,6 +12,8 @@ $end_info$
 
 #include <FEXCore/Config/Config.h>
 
+#include <chrono>
+
 namespace FEXCore::IR {
 class IREmitter;
 
@@ -19,31 +21,31 @@ void PassManager::AddDefaultPasses(bool InlineConstants, bool StaticRegisterAllo
   FEX_CONFIG_OPT(DisablePasses, O0);
 
   if (!DisablePasses()) {
-    InsertPass(CreateContextLoadStoreElimination());
+    InsertPass(CreateContextLoadStoreElimination(), "RCLSE");
 
     if (Is64BitMode()) {
       // This needs to run after RCLSE
       // This only matters for 64-bit code since these instructions don't exist in 32-bit
-      InsertPass(CreateLongDivideEliminationPass());
+      InsertPass(CreateLongDivideEliminationPass(), "LongDivideElimination");
     }
 
-    InsertPass(CreateDeadStoreElimination());
-    InsertPass(CreatePassDeadCodeElimination());
-    InsertPass(CreateConstProp(InlineConstants));
+    InsertPass(CreateDeadStoreElimination(), "DSE");
+    InsertPass(CreatePassDeadCodeElimination(), "DCE");
+    InsertPass(CreateConstProp(InlineConstants), "ConstProp");
 
     ////// InsertPass(CreateDeadFlagCalculationEliminination());
 
-    InsertPass(CreateSyscallOptimization());
-    InsertPass(CreatePassDeadCodeElimination());
+    InsertPass(CreateSyscallOptimization(), "SyscallOptimization");
+    InsertPass(CreatePassDeadCodeElimination(), "DCE");
 
     // only do SRA if enabled and JIT
     if (InlineConstants && StaticRegisterAllocation)
-      InsertPass(CreateStaticRegisterAllocationPass());
+      InsertPass(CreateStaticRegisterAllocationPass(), "SRA");
   }
   else {
     // only do SRA if enabled and JIT
     if (InlineConstants && StaticRegisterAllocation)
-      InsertPass(CreateStaticRegisterAllocationPass());
+      InsertPass(CreateStaticRegisterAllocationPass(), "SRA");
   }
 
   // If the IR is compacted post-RA then the node indexing gets messed up and the backend isn't able to find the register assigned to a node
@@ -66,8 +68,20 @@ void PassManager::InsertRegisterAllocationPass(bool OptimizeSRA) {
 
 bool PassManager::Run(IREmitter *IREmit) {
   bool Changed = false;
-  for (auto const &Pass : Passes) {
-    Changed |= Pass->Run(IREmit);
+  if (CollectPassTimings) {
+    // Passes can be inserted after timings were enabled
+    PassTimes.resize(Passes.size());
+
+    for (size_t i = 0; i < Passes.size(); ++i) {
+      const auto Start = std::chrono::steady_clock::now();
+      Changed |= Passes[i]->Run(IREmit);
+      PassTimes[i] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+    }
+  }
+  else {
+    for (auto const &Pass : Passes) {
+      Changed |= Pass->Run(IREmit);
+    }
   }
 
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
@@ -79,4 +93,14 @@ bool PassManager::Run(IREmitter *IREmit) {
   return Changed;
 }
 
+uint64_t PassManager::GetPassTime(std::string_view Name) const {
+  uint64_t Time{};
+  for (size_t i = 0; i < PassTimes.size(); ++i) {
+    if (PassNames[i] == Name) {
+      Time += PassTimes[i];
+    }
+  }
+  return Time;
+}
+
 }
@@ -8,8 +8,11 @@ $end_info$
 
 #include <FEXCore/Config/Config.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -44,6 +47,7 @@ public:
   Pass* InsertPass(std::unique_ptr<Pass> Pass, std::string Name = "") {
     Pass->RegisterPassManager(this);
     auto PassPtr = Passes.emplace_back(std::move(Pass)).get();
+    PassNames.emplace_back(Name.empty() ? "Unnamed" : Name);
 
     if (!Name.empty()) {
       NameToPassMaping[Name] = PassPtr;
@@ -76,14 +80,44 @@ public:
     SyscallHandler = Handler;
   }
 
+  /**
+   * @name Pass timings
+   *
+   * While enabled Run accumulates the nanoseconds spent in every pass.
+   * Passes that share a name share a timing.
+   * @{ */
+    void EnablePassTimings() {
+      CollectPassTimings = true;
+    }
+
+    uint64_t GetPassTime(std::string_view Name) const;
+
+    // Visit(Name, Nanoseconds) for every pass in the order they run
+    template<typename Visitor>
+    void VisitPassTimings(Visitor &&Visit) const {
+      for (size_t i = 0; i < PassTimes.size(); ++i) {
+        Visit(PassNames[i], PassTimes[i]);
+      }
+    }
+
+    void ResetPassTimings() {
+      PassTimes.assign(PassTimes.size(), 0);
+    }
+  /**  @} */
+
 protected:
   ShouldExitHandler ExitHandler;
   FEXCore::HLE::SyscallHandler *SyscallHandler;
 
 private:
   std::vector<std::unique_ptr<Pass>> Passes;
+  // Matches Passes, only used for reporting
+  std::vector<std::string> PassNames;
   std::unordered_map<std::string, Pass*> NameToPassMaping;
 
+  bool CollectPassTimings{};
+  std::vector<uint64_t> PassTimes;
+
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
   std::vector<std::unique_ptr<Pass>> ValidationPasses;
   void InsertValidationPass(std::unique_ptr<Pass> Pass, std::string Name = "") {
@@ -892,25 +892,31 @@ bool ConstProp::ConstantInlining(IREmitter *IREmit, const IRListView& CurrentIR)
       }
 
       case OP_EXITFUNCTION:
+      case OP_GUESTCALL:
+      case OP_GUESTRETURN:
       {
-        auto Op = IROp->C<IR::IROp_ExitFunction>();
+        // Every argument of a block exit is a guest RIP, GuestCall also has its return address
+        const uint8_t NumArgs = IR::GetArgs(IROp->Op);
+        for (uint8_t i = 0; i < NumArgs; ++i) {
+          auto RIP = IROp->Args[i];
 
-        uint64_t Constant{};
-        if (IREmit->IsValueConstant(Op->NewRIP, &Constant)) {
-          
-          IREmit->SetWriteCursor(CurrentIR.GetNode(Op->NewRIP));
+          uint64_t Constant{};
+          if (IREmit->IsValueConstant(RIP, &Constant)) {
 
-          IREmit->ReplaceNodeArgument(CodeNode, 0, IREmit->_InlineConstant(Constant));
+            IREmit->SetWriteCursor(CurrentIR.GetNode(RIP));
 
-          Changed = true;
-        } else {
-          auto NewRIP = IREmit->GetOpHeader(Op->NewRIP);
-          if (NewRIP->Op == OP_ENTRYPOINTOFFSET) {
-            auto EO = NewRIP->C<IR::IROp_EntrypointOffset>();
-            IREmit->SetWriteCursor(CurrentIR.GetNode(Op->NewRIP));
+            IREmit->ReplaceNodeArgument(CodeNode, i, IREmit->_InlineConstant(Constant));
 
-            IREmit->ReplaceNodeArgument(CodeNode, 0, IREmit->_InlineEntrypointOffset(EO->Offset, EO->Header.Size));
             Changed = true;
+          } else {
+            auto NewRIP = IREmit->GetOpHeader(RIP);
+            if (NewRIP->Op == OP_ENTRYPOINTOFFSET) {
+              auto EO = NewRIP->C<IR::IROp_EntrypointOffset>();
+              IREmit->SetWriteCursor(CurrentIR.GetNode(RIP));
+
+              IREmit->ReplaceNodeArgument(CodeNode, i, IREmit->_InlineEntrypointOffset(EO->Offset, EO->Header.Size));
+              Changed = true;
+            }
           }
         }
         break;
@@ -157,7 +157,9 @@ bool IRValidation::Run(IREmitter *IREmit) {
       NodeIsLive.Set(ID.Value);
 
       switch (IROp->Op) {
-        case IR::OP_EXITFUNCTION: {
+        case IR::OP_EXITFUNCTION:
+        case IR::OP_GUESTCALL:
+        case IR::OP_GUESTRETURN: {
           CurrentBlock->HasExit = true;
         break;
         }
@@ -246,6 +248,8 @@ bool IRValidation::Run(IREmitter *IREmit) {
         auto Op = GetOp(CodeCurrent);
         switch (Op) {
           case OP_EXITFUNCTION:
+          case OP_GUESTCALL:
+          case OP_GUESTRETURN:
           case OP_JUMP:
           case OP_CONDJUMP:
           case OP_BREAK:
@@ -2,9 +2,12 @@
 #include <FEXCore/Utils/Allocator.h>
 #include <FEXCore/Utils/CompilerDefs.h>
 #include <FEXCore/Utils/LogManager.h>
+#include <FEXCore/Utils/MathUtils.h>
 #include <FEXHeaderUtils/Syscalls.h>
 
+#include <algorithm>
 #include <array>
+#include <cstdio>
 #include <sys/mman.h>
 #ifdef ENABLE_JEMALLOC
 #include <jemalloc/jemalloc.h>
@@ -13,6 +16,7 @@
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 extern "C" {
   typedef void* (*mmap_hook_type)(
@@ -129,7 +133,9 @@ namespace FEXCore::Allocator {
     FEX_UNREACHABLE;
   }
 
-  PtrCache* StealMemoryRegion(uintptr_t Begin, uintptr_t End) {
+  // Probes the range with a descending size cascade of mappings
+  // Takes thousands of syscalls and VMAs, only used when the ranges in /proc/self/maps can't be reserved as is
+  static PtrCache* StealMemoryRegionByProbing(uintptr_t Begin, uintptr_t End) {
     PtrCache *Cache{};
     uint64_t CacheSize{};
     uint64_t CurrentCacheOffset = 0;
@@ -210,6 +216,160 @@ namespace FEXCore::Allocator {
     return Cache;
   }
 
+  // Fills Ranges with the unmapped parts of [Begin, End) according to /proc/self/maps
+  static bool FindFreeRanges(uintptr_t Begin, uintptr_t End, std::vector<PtrCache> *Ranges) {
+    FILE *fp = fopen("/proc/self/maps", "re");
+    if (!fp) {
+      return false;
+    }
+
+    // Mappings are listed in ascending order
+    uintptr_t Cursor = Begin;
+    uintptr_t MapBegin{};
+    uintptr_t MapEnd{};
+    while (Cursor < End && fscanf(fp, "%lx-%lx%*[^\n]\n", &MapBegin, &MapEnd) == 2) {
+      if (MapEnd <= Cursor) {
+        continue;
+      }
+
+      if (MapBegin >= End) {
+        break;
+      }
+
+      if (MapBegin > Cursor) {
+        Ranges->push_back({Cursor, MapBegin - Cursor});
+      }
+      Cursor = MapEnd;
+    }
+
+    const bool Error = ferror(fp);
+    fclose(fp);
+
+    if (Error) {
+      return false;
+    }
+
+    if (Cursor < End) {
+      Ranges->push_back({Cursor, End - Cursor});
+    }
+    return true;
+  }
+
+  static void UnmapRanges(PtrCache const *Ranges, size_t Count) {
+    for (size_t i = 0; i < Count; ++i) {
+      ::munmap(reinterpret_cast<void*>(Ranges[i].Ptr), Ranges[i].Size);
+    }
+  }
+
+  // Returns 0 or the errno of the failure
+  static int MapFixed(uintptr_t Ptr, size_t Size, int Prot) {
+    void *Result = ::mmap(reinterpret_cast<void*>(Ptr), Size, Prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+    if (Result == MAP_FAILED) {
+      return errno;
+    }
+
+    // Kernels older than 4.17 treat this as a hint
+    if (Result != reinterpret_cast<void*>(Ptr)) {
+      ::munmap(Result, Size);
+      return EEXIST;
+    }
+
+    return 0;
+  }
+
+  // Maps as much of the start of the range as the kernel lets us, eg: the last page below the top of the VA is refused
+  // Trims in growing steps so this stays a handful of syscalls, at worst leaves twice what was refused unreserved
+  // Returns the size mapped or -EEXIST if something else is mapped there
+  static int64_t MapFixedPrefix(uintptr_t Ptr, size_t Size) {
+    size_t Trim{};
+    while (Trim < Size) {
+      const int Result = MapFixed(Ptr, Size - Trim, PROT_NONE);
+      if (Result == 0) {
+        return Size - Trim;
+      }
+
+      if (Result != ENOMEM) {
+        return -EEXIST;
+      }
+
+      Trim = Trim ? Trim * 2 : PAGE_SIZE;
+    }
+
+    return 0;
+  }
+
+  // Reserves every free range with a single mapping each, the PtrCache lives at the start of the first range it fits in
+  // Fails if anything got mapped in to the range since /proc/self/maps was read
+  // The cache's range is assumed to be mappable in full, only the top of the VA is refused and the cache goes first
+  static bool StealFreeRanges(uintptr_t Begin, uintptr_t End, PtrCache **Result) {
+    std::vector<PtrCache> Ranges;
+    if (!FindFreeRanges(Begin, End, &Ranges)) {
+      return false;
+    }
+
+    if (Ranges.empty()) {
+      // Nothing to steal
+      *Result = nullptr;
+      return true;
+    }
+
+    // One entry per range, then the cache itself
+    const size_t CacheSize = FEXCore::AlignUp((Ranges.size() + 1) * sizeof(PtrCache), PAGE_SIZE);
+    auto CacheRange = std::find_if(Ranges.begin(), Ranges.end(), [CacheSize](PtrCache const &Range) {
+      return Range.Size >= CacheSize;
+    });
+
+    if (CacheRange == Ranges.end()) {
+      return false;
+    }
+
+    if (MapFixed(CacheRange->Ptr, CacheSize, PROT_READ | PROT_WRITE) != 0) {
+      return false;
+    }
+    auto Cache = reinterpret_cast<PtrCache*>(CacheRange->Ptr);
+
+    CacheRange->Ptr += CacheSize;
+    CacheRange->Size -= CacheSize;
+    if (CacheRange->Size == 0) {
+      Ranges.erase(CacheRange);
+    }
+
+    size_t Count{};
+    for (auto const &Range : Ranges) {
+      const int64_t Mapped = MapFixedPrefix(Range.Ptr, Range.Size);
+      if (Mapped < 0) {
+        UnmapRanges(Cache, Count);
+        ::munmap(Cache, CacheSize);
+        return false;
+      }
+
+      if (Mapped > 0) {
+        Cache[Count++] = {Range.Ptr, static_cast<uint64_t>(Mapped)};
+      }
+    }
+
+    Cache[Count] = {
+      .Ptr = static_cast<uint64_t>(reinterpret_cast<uint64_t>(Cache)),
+      .Size = CacheSize,
+    };
+
+    *Result = Cache;
+    return true;
+  }
+
+  PtrCache* StealMemoryRegion(uintptr_t Begin, uintptr_t End) {
+    // Only loses a race with other threads mapping memory in to the range, which is rare this early
+    constexpr size_t MaxTries = 4;
+    for (size_t i = 0; i < MaxTries; ++i) {
+      PtrCache *Cache{};
+      if (StealFreeRanges(Begin, End, &Cache)) {
+        return Cache;
+      }
+    }
+
+    return StealMemoryRegionByProbing(Begin, End);
+  }
+
   PtrCache* Steal48BitVA() {
     size_t Bits = FEXCore::Allocator::DetermineVASize();
     if (Bits < 48) {
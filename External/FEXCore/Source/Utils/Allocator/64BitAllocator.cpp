@@ -1,4 +1,3 @@
-#include "Utils/Allocator/FlexBitSet.h"
 #include "Utils/Allocator/HostAllocator.h"
 #include "Utils/Allocator/IntrusiveArenaAllocator.h"
 #include <FEXCore/Utils/Allocator.h>
@@ -13,10 +12,14 @@
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
-#include <list>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <new>
+#include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <sys/mman.h>
 #include <sys/utsname.h>
@@ -67,78 +70,218 @@ namespace Alloc::OSAllocator {
         return false;
       }
 
+      // A region that allocations are placed in
+      // Tracks its free ranges both by address and by size, every operation on them is O(log n) in the number of free ranges
+      // Everything here is protected by the region's own mutex
       struct LiveVMARegion {
+        LiveVMARegion(ReservedVMARegion *_SlabInfo, std::pmr::memory_resource *Upstream)
+          : SlabInfo {_SlabInfo}
+          , FreeSpace {_SlabInfo->RegionSize}
+          , NodePool {Upstream}
+          , FreeByAddress {&NodePool}
+          , FreeBySize {&NodePool} {
+          InsertFree(SlabInfo->Base, SlabInfo->RegionSize);
+        }
+
         ReservedVMARegion *SlabInfo;
         uint64_t FreeSpace{};
-        uint32_t LastPageAllocation{};
-        FEXCore::FlexBitSet<uint64_t> UsedPages;
-
-        // This returns the size of the LiveVMARegion in addition to the flex set that tracks the used data
-        // The LiveVMARegion lives at the start of the VMA region which means on initialization we need to set that
-        // tracked ranged as used immediately
-        static size_t GetSizeWithFlexSet(size_t Size) {
-          // One element per page
-
-          // 0x10'0000'0000 bytes
-          // 0x100'0000 Pages
-          // 1 bit per page for tracking means 0x20'0000 (Pages / 8) bytes of flex space
-          // Which is 2MB of tracking
-          uint64_t NumElements = (Size >> PAGE_SHIFT) * sizeof(uint64_t);
-          return sizeof(LiveVMARegion) + FEXCore::FlexBitSet<uint64_t>::Size(NumElements);
+        std::mutex RegionMutex{};
+
+        // Tree nodes get recycled here instead of going back to the forward only object allocator
+        std::pmr::unsynchronized_pool_resource NodePool;
+        // Free range base -> size
+        std::pmr::map<uintptr_t, uint64_t> FreeByAddress;
+        // {Size, Base}, lowest address first within the same size
+        std::pmr::set<std::pair<uint64_t, uintptr_t>> FreeBySize;
+
+        uintptr_t End() const {
+          return SlabInfo->Base + SlabInfo->RegionSize;
+        }
+
+        bool Contains(uintptr_t Begin, uintptr_t RangeEnd) const {
+          return Begin >= SlabInfo->Base && RangeEnd <= End();
+        }
+
+        uint64_t LargestFree() const {
+          return FreeBySize.empty() ? 0 : FreeBySize.rbegin()->first;
+        }
+
+        void InsertFree(uintptr_t Base, uint64_t Size) {
+          FreeByAddress.emplace(Base, Size);
+          FreeBySize.emplace(Size, Base);
+        }
+
+        std::pmr::map<uintptr_t, uint64_t>::iterator EraseFree(std::pmr::map<uintptr_t, uint64_t>::iterator it) {
+          FreeBySize.erase({it->second, it->first});
+          return FreeByAddress.erase(it);
+        }
+
+        // Marks the range as used, returns how much of it was free
+        uint64_t Claim(uintptr_t Begin, uintptr_t RangeEnd) {
+          uint64_t Claimed{};
+
+          // Start at the free range that could overlap the beginning
+          auto it = FreeByAddress.upper_bound(Begin);
+          if (it != FreeByAddress.begin() &&
+              std::prev(it)->first + std::prev(it)->second > Begin) {
+            --it;
+          }
+
+          while (it != FreeByAddress.end() && it->first < RangeEnd) {
+            uintptr_t FreeBegin = it->first;
+            uintptr_t FreeEnd = FreeBegin + it->second;
+            it = EraseFree(it);
+
+            // Keep whatever is left on either side
+            if (FreeBegin < Begin) {
+              InsertFree(FreeBegin, Begin - FreeBegin);
+            }
+            if (FreeEnd > RangeEnd) {
+              InsertFree(RangeEnd, FreeEnd - RangeEnd);
+            }
+
+            Claimed += std::min(FreeEnd, RangeEnd) - std::max(FreeBegin, Begin);
+          }
+
+          FreeSpace -= Claimed;
+          return Claimed;
+        }
+
+        // Claims the range only if it is entirely free
+        bool ClaimExact(uintptr_t Begin, uintptr_t RangeEnd) {
+          auto it = FreeByAddress.upper_bound(Begin);
+          if (it == FreeByAddress.begin()) {
+            return false;
+          }
+
+          --it;
+          if (it->first + it->second < RangeEnd) {
+            return false;
+          }
+
+          Claim(Begin, RangeEnd);
+          return true;
         }
 
-        static void InitializeVMARegionUsed(LiveVMARegion *Region, size_t AdditionalSize) {
-          size_t SizeOfLiveRegion = FEXCore::AlignUp(LiveVMARegion::GetSizeWithFlexSet(Region->SlabInfo->RegionSize), PAGE_SIZE);
-          size_t SizePlusManagedData = SizeOfLiveRegion + AdditionalSize;
+        // Best fit, the smallest free range that fits and the lowest address of those
+        // Fills holes first, keeping the number of VMAs down (65k maximum)
+        uintptr_t ClaimBestFit(uint64_t Size) {
+          auto it = FreeBySize.lower_bound({Size, 0});
+          if (it == FreeBySize.end()) {
+            return 0;
+          }
 
-          Region->FreeSpace = Region->SlabInfo->RegionSize - SizePlusManagedData;
+          uintptr_t Base = it->second;
+          Claim(Base, Base + Size);
+          return Base;
+        }
+
+        // Frees a range that is entirely claimed, merging it with its free neighbours
+        void Release(uintptr_t Begin, uintptr_t RangeEnd) {
+          FreeSpace += RangeEnd - Begin;
+
+          auto Next = FreeByAddress.lower_bound(Begin);
+          if (Next != FreeByAddress.begin()) {
+            auto Prev = std::prev(Next);
+            if (Prev->first + Prev->second == Begin) {
+              Begin = Prev->first;
+              EraseFree(Prev);
+            }
+          }
 
-          size_t NumPages = SizePlusManagedData >> PAGE_SHIFT;
-          // Memset the full tracking to zero to state nothing used
-          Region->UsedPages.MemSet(Region->SlabInfo->RegionSize >> PAGE_SHIFT);
-          // Set our reserved pages
-          for (size_t i = 0; i < NumPages; ++i) {
-            // Set our used pages
-            Region->UsedPages.Set(i);
+          if (Next != FreeByAddress.end() && Next->first == RangeEnd) {
+            RangeEnd = Next->first + Next->second;
+            EraseFree(Next);
           }
-          Region->LastPageAllocation = NumPages;
+
+          InsertFree(Begin, RangeEnd - Begin);
         }
       };
-      static_assert(std::is_trivially_copyable<LiveVMARegion>::value, "Needs to be trivially copyable");
-      static_assert(offsetof(LiveVMARegion, UsedPages) == sizeof(LiveVMARegion), "FlexBitSet needs to be at the end");
 
-      using ReservedRegionListType = std::pmr::list<ReservedVMARegion*>;
-      using LiveRegionListType = std::pmr::list<LiveVMARegion*>;
-      ReservedRegionListType *ReservedRegions{};
-      LiveRegionListType *LiveRegions{};
+      // Both keyed by base address
+      using ReservedRegionMapType = std::pmr::map<uintptr_t, ReservedVMARegion*>;
+      using LiveRegionMapType = std::pmr::map<uintptr_t, LiveVMARegion*>;
+      ReservedRegionMapType *ReservedRegions{};
+      LiveRegionMapType *LiveRegions{};
 
       Alloc::ForwardOnlyIntrusiveArenaAllocator *ObjectAlloc{};
-      std::mutex AllocationMutex{};
+
+      // Protects the region maps. Live regions are never removed so they can be used after letting go of this
+      // Lock ordering is RegionsMutex then LiveVMARegion::RegionMutex
+      std::shared_mutex RegionsMutex{};
       void DetermineVASize();
 
-      LiveVMARegion *MakeRegionActive(ReservedRegionListType::iterator ReservedIterator, uint64_t UsedSize) {
-        ReservedVMARegion *ReservedRegion = *ReservedIterator;
+      LiveVMARegion *FindLiveRegion(uintptr_t Begin, uintptr_t End) {
+        auto it = LiveRegions->upper_bound(Begin);
+        if (it == LiveRegions->begin()) {
+          return nullptr;
+        }
+
+        --it;
+        return it->second->Contains(Begin, End) ? it->second : nullptr;
+      }
 
+      // Needs RegionsMutex held exclusively
+      LiveVMARegion *MakeRegionActive(ReservedRegionMapType::iterator ReservedIterator) {
+        ReservedVMARegion *ReservedRegion = ReservedIterator->second;
         ReservedRegions->erase(ReservedIterator);
-        // mprotect the new region we've allocated
-        size_t SizeOfLiveRegion = FEXCore::AlignUp(LiveVMARegion::GetSizeWithFlexSet(ReservedRegion->RegionSize), PAGE_SIZE);
-        size_t SizePlusManagedData = UsedSize + SizeOfLiveRegion;
 
-        [[maybe_unused]] auto Res = mprotect(reinterpret_cast<void*>(ReservedRegion->Base), SizePlusManagedData, PROT_READ | PROT_WRITE);
+        // Tracking lives in the object allocator, the full region is available for allocations
+        // The region stays PROT_NONE until something gets mapped in to it
+        LiveVMARegion *LiveRange = ObjectAlloc->new_construct<LiveVMARegion>(ReservedRegion, ObjectAlloc);
 
-        LOGMAN_THROW_A_FMT(Res == 0, "Couldn't mprotect region: {} '{}' Likely occurs when running out of memory or Maximum VMAs", errno, strerror(errno));
+        // Add to our active tracked ranges
+        LiveRegions->emplace(ReservedRegion->Base, LiveRange);
 
-        LiveVMARegion *LiveRange = new (reinterpret_cast<void*>(ReservedRegion->Base)) LiveVMARegion();
+        return LiveRange;
+      }
 
-        // Copy over the reserved data
-        LiveRange->SlabInfo = ReservedRegion;
-        // Initialize VMA
-        LiveVMARegion::InitializeVMARegionUsed(LiveRange, UsedSize);
+      // Reserved regions to make active for an allocation, the one holding Addr if it is set or otherwise the first one that fits
+      LiveVMARegion *MakeRegionActiveForAllocation(uintptr_t Addr, uint64_t Length) {
+        std::unique_lock lk(RegionsMutex);
 
-        // Add to our active tracked ranges
-        auto LiveIter = LiveRegions->emplace_back(LiveRange);
+        // Another thread may have made the region live in the meantime
+        if (Addr) {
+          if (auto Live = FindLiveRegion(Addr, Addr + Length)) {
+            return Live;
+          }
+
+          auto it = ReservedRegions->upper_bound(Addr);
+          if (it != ReservedRegions->begin()) {
+            --it;
+            if (Addr >= it->second->Base &&
+                Addr + Length <= it->second->Base + it->second->RegionSize) {
+              return MakeRegionActive(it);
+            }
+          }
+          return nullptr;
+        }
+
+        for (auto it = ReservedRegions->begin(); it != ReservedRegions->end(); ++it) {
+          if (it->second->RegionSize >= Length) {
+            return MakeRegionActive(it);
+          }
+        }
+
+        return nullptr;
+      }
 
-        return LiveIter;
+      void *MapClaimedRange(LiveVMARegion *Region, uintptr_t Base, uint64_t Length, int prot, int flags, int fd, off_t offset) {
+        // The range is ours, the syscall doesn't need to hold up other allocations
+        void *MMapResult = ::mmap(reinterpret_cast<void*>(Base),
+          Length,
+          prot,
+          (flags & ~MAP_FIXED_NOREPLACE) | MAP_FIXED,
+          fd, offset);
+
+        if (MMapResult == MAP_FAILED) {
+          int Error = errno;
+          std::scoped_lock lk(Region->RegionMutex);
+          Region->Release(Base, Base + Length);
+          return reinterpret_cast<void*>(-Error);
+        }
+
+        return MMapResult;
       }
 
       // 32-bit old kernel workarounds
@@ -181,244 +324,95 @@ void *OSAllocator_64Bit::Mmap(void *addr, size_t length, int prot, int flags, in
   length = FEXCore::AlignUp(length, PAGE_SIZE);
 
   uint64_t AddrEnd = Addr + length;
-  size_t NumberOfPages = length / PAGE_SIZE;
 
-  // This needs a mutex to be thread safe
-  FHU::ScopedSignalMaskWithMutex lk(AllocationMutex);
+  // Signals stay masked across the locks and the syscalls between them
+  // A signal handler that allocates would otherwise see a claimed range that isn't mapped yet, or deadlock
+  FHU::ScopedSignalMask Mask;
 
-  uint64_t AllocatedOffset{};
   LiveVMARegion *LiveRegion{};
-
-  if (Fixed || Addr != 0) {
-    // Check active slabs to see if we can fit this
-    for (auto it = LiveRegions->begin(); it != LiveRegions->end(); ++it) {
-      uintptr_t RegionBegin = (*it)->SlabInfo->Base;
-      uintptr_t RegionEnd = RegionBegin + (*it)->SlabInfo->RegionSize;
-
-      if (Addr >= RegionBegin &&
-          Addr < RegionEnd) {
-        LiveRegion = *it;
-        // Leave our loop
-        break;
-      }
+  if (Addr != 0) {
+    {
+      std::shared_lock lk(RegionsMutex);
+      LiveRegion = FindLiveRegion(Addr, AddrEnd);
     }
 
-    // Couldn't find an active region that fit
-    // Check reserved regions
     if (!LiveRegion) {
-      // Didn't have a slab that fit this range
-      // Check our reserved regions to see if we have one that fits
-      for (auto it = ReservedRegions->begin(); it != ReservedRegions->end(); ++it) {
-        ReservedVMARegion *ReservedRegion = *it;
-        uintptr_t RegionEnd = ReservedRegion->Base + ReservedRegion->RegionSize;
-        if (Addr >= ReservedRegion->Base &&
-            AddrEnd < RegionEnd) {
-          // Found one, let's make it active
-          LiveRegion = MakeRegionActive(it, 0);
-          break;
-        }
-      }
+      LiveRegion = MakeRegionActiveForAllocation(Addr, length);
     }
   }
 
-  again:
-
-  auto CheckIfRangeFits = [&AllocatedOffset](LiveVMARegion *Region, uint64_t length, int prot, int flags, int fd, off_t offset, uint64_t StartingPosition = 0) -> std::pair<LiveVMARegion*, void*> {
-    uint64_t AllocatedPage{};
-    uint64_t NumberOfPages = length >> PAGE_SHIFT;
-
-    if (Region->FreeSpace >= length) {
-      uint64_t LastAllocation =
-        StartingPosition ?
-        (StartingPosition - Region->SlabInfo->Base) >> PAGE_SHIFT
-        : Region->LastPageAllocation;
-      size_t RegionNumberOfPages = Region->SlabInfo->RegionSize >> PAGE_SHIFT;
-
-      // Backward scan
-      // We need to do a backward scan first to fill any holes
-      // Otherwise we will very quickly run out of VMA regions (65k maximum)
-      for (size_t CurrentPage = LastAllocation;
-           CurrentPage >= NumberOfPages;) {
-        size_t Remaining = NumberOfPages;
-        assert(Remaining <= CurrentPage);
-
-        while (Remaining) {
-          if (Region->UsedPages[CurrentPage - Remaining]) {
-            // Has an intersecting range
-            break;
-          }
-          --Remaining;
-        }
-
-        if (Remaining) {
-          // Didn't find a slab range
-          CurrentPage -= Remaining;
-        }
-        else {
-          // We have a slab range
-          CurrentPage -= NumberOfPages;
-
-          // Keep scanning backwards to not introduce ANOTHER gap
-          while (CurrentPage >= 1) {
-            if (Region->UsedPages[CurrentPage - 1]) {
-              // Found a used page, we can leave now
-              break;
-            }
-            --CurrentPage;
-          }
-          AllocatedPage = CurrentPage;
-          break;
-        }
-      }
-
-      // Foward Scan
-      if (AllocatedPage == 0) {
-        for (size_t CurrentPage = LastAllocation;
-             CurrentPage < (RegionNumberOfPages - NumberOfPages);) {
-          // If we have enough free space, check if we have enough free pages that are contiguous
-          size_t Remaining = NumberOfPages;
-
-          assert((CurrentPage + Remaining - 1) < RegionNumberOfPages);
-          while (Remaining) {
-            if (Region->UsedPages[CurrentPage + Remaining - 1]) {
-              // Has an intersecting range
-              break;
-            }
-            --Remaining;
-          }
+  if (Fixed) {
+    if (!LiveRegion) {
+      // Not in any of our regions
+      return reinterpret_cast<void*>(-ENOMEM);
+    }
 
-          if (Remaining) {
-            // Didn't find a slab range
-            CurrentPage += Remaining;
-          }
-          else {
-            // We have a slab range
-            AllocatedPage = CurrentPage;
-            break;
-          }
+    if (flags & MAP_FIXED_NOREPLACE) {
+      {
+        std::scoped_lock lk(LiveRegion->RegionMutex);
+        if (!LiveRegion->ClaimExact(Addr, AddrEnd)) {
+          // Intersected with something that already existed
+          return reinterpret_cast<void*>(-EEXIST);
         }
       }
 
-      if (AllocatedPage) {
-        AllocatedOffset = Region->SlabInfo->Base + AllocatedPage * PAGE_SIZE;
+      return MapClaimedRange(LiveRegion, Addr, length, prot, flags, fd, offset);
+    }
 
-        // We need to setup protections for this
-        void *MMapResult = ::mmap(reinterpret_cast<void*>(AllocatedOffset),
-          length,
-          prot,
-          (flags & ~MAP_FIXED_NOREPLACE) | MAP_FIXED,
-          fd, offset);
+    // Replaces whatever was there, only claim the range once the mapping succeeded
+    std::scoped_lock lk(LiveRegion->RegionMutex);
+    void *MMapResult = ::mmap(reinterpret_cast<void*>(Addr),
+      length,
+      prot,
+      (flags & ~MAP_FIXED_NOREPLACE) | MAP_FIXED,
+      fd, offset);
 
-        if (MMapResult == MAP_FAILED) {
-          return std::make_pair(Region, reinterpret_cast<void*>(-errno));
-        }
-        return std::make_pair(Region, MMapResult);
-      }
+    if (MMapResult == MAP_FAILED) {
+      return reinterpret_cast<void*>(-errno);
     }
 
-    return std::make_pair(nullptr, nullptr);
-  };
-
-  if (Fixed) {
-    // Found a region let's allocate to it
-    if (LiveRegion) {
-      // Found a slab that fits this
-      if (flags & MAP_FIXED_NOREPLACE) {
-        auto Fits = CheckIfRangeFits(LiveRegion, length, prot, flags, fd, offset, Addr);
-        if (Fits.first && Fits.second == reinterpret_cast<void*>(Addr)) {
-          // We fit correctly
-          AllocatedOffset = Addr;
-        }
-        else {
-          // Intersected with something that already existed
-          return reinterpret_cast<void*>(-EEXIST);
-        }
-      }
-      else {
-        // We need to mmap the file to this location
-        void *MMapResult = ::mmap(reinterpret_cast<void*>(Addr),
-          length,
-          prot,
-          (flags & ~MAP_FIXED_NOREPLACE) | MAP_FIXED,
-          fd, offset);
+    LiveRegion->Claim(Addr, AddrEnd);
+    return MMapResult;
+  }
 
-        if (MMapResult == MAP_FAILED) {
-          return reinterpret_cast<void*>(-errno);
-        }
+  // Try the hinted address first
+  if (LiveRegion) {
+    bool Claimed{};
+    {
+      std::scoped_lock lk(LiveRegion->RegionMutex);
+      Claimed = LiveRegion->ClaimExact(Addr, AddrEnd);
+    }
 
-        AllocatedOffset = Addr;
-      }
-      // Fall through to live region tracking
+    if (Claimed) {
+      return MapClaimedRange(LiveRegion, Addr, length, prot, flags, fd, offset);
     }
   }
-  else {
-    // Check our active slabs to see if we can fit the allocation
-    // Slightly different than fixed since it doesn't need exact placement
-    if (LiveRegion && Addr != 0) {
-      // We found a LiveRegion that could hold this address. Let's try to place it
-      // Check if this area is free
-      auto Fits = CheckIfRangeFits(LiveRegion, length, prot, flags, fd, offset, Addr);
-      if (Fits.first && Fits.second == reinterpret_cast<void*>(Addr)) {
-        // We fit correctly
-        AllocatedOffset = Addr;
-      }
-      else {
-        // Couldn't fit
-        // We can continue past this point still
-        LiveRegion = nullptr;
-      }
-    }
 
-    if (!LiveRegion) {
-      for (auto it = LiveRegions->begin(); it != LiveRegions->end(); ++it) {
-        auto Fits = CheckIfRangeFits(*it, length, prot, flags, fd, offset);
-        if (Fits.first && Fits.second == reinterpret_cast<void*>(AllocatedOffset)) {
-          // We fit correctly
-          LiveRegion = Fits.first;
+  while (true) {
+    uintptr_t Allocation{};
+    {
+      std::shared_lock lk(RegionsMutex);
+      for (auto &[Base, Region] : *LiveRegions) {
+        std::scoped_lock RegionLock(Region->RegionMutex);
+        // Skips full regions without walking their free ranges
+        if (Region->LargestFree() >= length) {
+          Allocation = Region->ClaimBestFit(length);
+          LiveRegion = Region;
           break;
         }
-
-        // Couldn't fit but mmap gave us an error
-        if (!Fits.first && Fits.second) {
-          return Fits.second;
-        }
-
-        // nullptr on both means no error and couldn't fit
       }
     }
 
-    if (!LiveRegion) {
-      // Couldn't find a fit in the live regions
-      // Allocate a new reserved region
-      size_t lengthOfLiveRegion = FEXCore::AlignUp(LiveVMARegion::GetSizeWithFlexSet(length), PAGE_SIZE);
-      size_t lengthPlusManagedData = length + lengthOfLiveRegion;
-      for (auto it = ReservedRegions->begin(); it != ReservedRegions->end(); ++it) {
-        if ((*it)->RegionSize >= lengthPlusManagedData) {
-          MakeRegionActive(it, 0);
-          goto again;
-        }
-      }
+    if (Allocation) {
+      return MapClaimedRange(LiveRegion, Allocation, length, prot, flags, fd, offset);
     }
-  }
-
-  if (LiveRegion) {
-    // Mark the pages as used
-    uintptr_t RegionBegin = LiveRegion->SlabInfo->Base;
-    uintptr_t MappedBegin = (AllocatedOffset - RegionBegin) >> PAGE_SHIFT;
 
-    for (size_t i = 0; i < NumberOfPages; ++i) {
-      LiveRegion->UsedPages.Set(MappedBegin + i);
+    // Couldn't find a fit in the live regions
+    // Make a new reserved region active and try again
+    if (!MakeRegionActiveForAllocation(0, length)) {
+      return reinterpret_cast<void*>(-ENOMEM);
     }
-
-    // Change our last allocation region
-    LiveRegion->LastPageAllocation = MappedBegin + NumberOfPages;
-    LiveRegion->FreeSpace -= length;
-  }
-
-  if (!AllocatedOffset) {
-    AllocatedOffset = -ENOMEM;
   }
-  return reinterpret_cast<void*>(AllocatedOffset);
 }
 
 int OSAllocator_64Bit::Munmap(void *addr, size_t length) {
@@ -442,52 +436,44 @@ int OSAllocator_64Bit::Munmap(void *addr, size_t length) {
     return -EOVERFLOW;
   }
 
-  // This needs a mutex to be thread safe
-  FHU::ScopedSignalMaskWithMutex lk(AllocationMutex);
-
   length = FEXCore::AlignUp(length, PAGE_SIZE);
 
   uintptr_t PtrBegin = reinterpret_cast<uintptr_t>(addr);
   uintptr_t PtrEnd = PtrBegin + length;
-  // Walk all of the live ranges and find this slab then delete it
-  for (auto it = LiveRegions->begin(); it != LiveRegions->end(); ++it) {
-    uintptr_t RegionBegin = (*it)->SlabInfo->Base;
-    uintptr_t RegionEnd = RegionBegin + (*it)->SlabInfo->RegionSize;
 
-    if (RegionBegin <= PtrBegin &&
-        RegionEnd > PtrEnd) {
-      // Live region fully encompasses slab range
+  FHU::ScopedSignalMask Mask;
 
-      uint64_t FreedPages{};
-      uint32_t SlabPageBegin = (PtrBegin - RegionBegin) >> PAGE_SHIFT;
-      uint64_t PagesToFree = length >> PAGE_SHIFT;
-
-      for (size_t i = 0; i < PagesToFree; ++i) {
-        FreedPages += (*it)->UsedPages.TestAndClear(SlabPageBegin + i) ? 1 : 0;
-      }
-
-      if (FreedPages != 0)
-      {
-        // If we were contiuous freeing then make sure to give back the physical address space
-        // If the region was locked then madvise won't remove the physical backing
-        // This woul be a bug in the frontend application
-        // So be careful with mlock/munlock
-        ::madvise(addr, length, MADV_DONTNEED);
-        ::mmap(addr, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
-      }
+  LiveVMARegion *LiveRegion{};
+  {
+    std::shared_lock lk(RegionsMutex);
+    LiveRegion = FindLiveRegion(PtrBegin, PtrEnd);
+  }
 
-      (*it)->FreeSpace += FreedPages * 4096;
+  // If it didn't match at all then no error
+  if (!LiveRegion) {
+    return 0;
+  }
 
-      // Set the last allocated page to the minimum of last page allocation or this slab
-      // This will let us more quickly fill holes
-      (*it)->LastPageAllocation = std::min((*it)->LastPageAllocation, SlabPageBegin);
+  // Claim the whole range first so no other thread gets handed part of it before it is back to PROT_NONE
+  uint64_t FreedSize{};
+  {
+    std::scoped_lock lk(LiveRegion->RegionMutex);
+    FreedSize = length - LiveRegion->Claim(PtrBegin, PtrEnd);
+  }
 
-      // XXX: Move region back to reserved list
-      return 0;
-    }
+  if (FreedSize != 0) {
+    // If we were contiuous freeing then make sure to give back the physical address space
+    // If the region was locked then madvise won't remove the physical backing
+    // This woul be a bug in the frontend application
+    // So be careful with mlock/munlock
+    ::madvise(addr, length, MADV_DONTNEED);
+    ::mmap(addr, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
   }
 
-  // If it didn't match at all then no error
+  std::scoped_lock lk(LiveRegion->RegionMutex);
+  LiveRegion->Release(PtrBegin, PtrEnd);
+
+  // XXX: Move region back to reserved list
   return 0;
 }
 
@@ -603,7 +589,7 @@ OSAllocator_64Bit::OSAllocator_64Bit() {
           ReservedVMARegion *Region = ObjectAlloc->new_construct<ReservedVMARegion>();
           Region->Base = reinterpret_cast<uint64_t>(Ptr);
           Region->RegionSize = AllocationSize;
-          ReservedRegions->emplace_back(Region);
+          ReservedRegions->emplace(Region->Base, Region);
           PrevReserved = Region;
         }
       }
@@ -623,17 +609,18 @@ OSAllocator_64Bit::OSAllocator_64Bit() {
 
 OSAllocator_64Bit::~OSAllocator_64Bit() {
   // This needs a mutex to be thread safe
-  FHU::ScopedSignalMaskWithMutex lk(AllocationMutex);
+  FHU::ScopedSignalMask Mask;
+  std::unique_lock lk(RegionsMutex);
 
   // Walk the pages and deallocate
   // First walk the live regions
-  for (auto it = LiveRegions->begin(); it != LiveRegions->end(); ++it) {
-    ::munmap(reinterpret_cast<void*>((*it)->SlabInfo->Base), (*it)->SlabInfo->RegionSize);
+  for (auto &[Base, Region] : *LiveRegions) {
+    ::munmap(reinterpret_cast<void*>(Base), Region->SlabInfo->RegionSize);
   }
 
   // Now walk the reserved regions
-  for (auto it = ReservedRegions->begin(); it != ReservedRegions->end(); ++it) {
-    ::munmap(reinterpret_cast<void*>((*it)->Base), (*it)->RegionSize);
+  for (auto &[Base, Region] : *ReservedRegions) {
+    ::munmap(reinterpret_cast<void*>(Base), Region->RegionSize);
   }
 }
 
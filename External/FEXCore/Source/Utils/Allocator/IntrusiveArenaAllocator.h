@@ -38,6 +38,8 @@ namespace Alloc {
 
   private:
     void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+      std::scoped_lock<std::mutex> lk{AllocationMutex};
+
       size_t PreviousAligned = FEXCore::AlignUp(LastAllocation, alignment);
       size_t NewOffset = PreviousAligned + bytes;
 
@@ -66,6 +68,7 @@ namespace Alloc {
     uintptr_t Begin;
     size_t Size;
     size_t LastAllocation{};
+    std::mutex AllocationMutex{};
   };
 
   class IntrusiveArenaAllocator final : public std::pmr::memory_resource {
@@ -34,8 +34,13 @@ void MFmt(const char *fmt, const fmt::format_args& args) {
 
 namespace Msg {
 std::vector<MsgHandler> Handlers;
+std::vector<MsgFmtHandler> FmtHandlers;
 void InstallHandler(MsgHandler Handler) { Handlers.emplace_back(Handler); }
-void UnInstallHandlers() { Handlers.clear(); }
+void InstallFmtHandler(MsgFmtHandler Handler) { FmtHandlers.emplace_back(Handler); }
+void UnInstallHandlers() {
+  Handlers.clear();
+  FmtHandlers.clear();
+}
 
 static void M(DebugLevels Level, const char *fmt, va_list args) {
   size_t MsgSize = 1024;
@@ -56,6 +61,15 @@ static void M(DebugLevels Level, const char *fmt, va_list args) {
   for (auto &Handler : Handlers) {
     Handler(Level, Buffer);
   }
+
+  if (!FmtHandlers.empty()) {
+    // Already formatted, pass it through as a single argument
+    const char *Formatted = Buffer;
+    const auto Args = fmt::make_format_args(Formatted);
+    for (auto &Handler : FmtHandlers) {
+      Handler(Level, "{}", Args);
+    }
+  }
 }
 
 void D(const char *fmt, ...) {
@@ -70,6 +84,15 @@ void D(const char *fmt, ...) {
 }
 
 void MFmtImpl(DebugLevels level, const char* fmt, const fmt::format_args& args) {
+  for (auto& Handler : FmtHandlers) {
+    Handler(level, fmt, args);
+  }
+
+  // Only format if something wants the text
+  if (Handlers.empty()) {
+    return;
+  }
+
   const auto msg = fmt::vformat(fmt, args);
 
   for (auto& Handler : Handlers) {
@@ -2,13 +2,17 @@
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXCore/Utils/Telemetry.h>
 
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <stddef.h>
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <vector>
 
 namespace FEXCore::Telemetry {
 #ifndef FEX_DISABLE_TELEMETRY
@@ -18,7 +22,16 @@ namespace FEXCore::Telemetry {
     "16Byte Split atomics",
     "VEX instructions (AVX)",
     "EVEX instructions (AVX512)",
+    "16bit CAS Tear",
+    "32bit CAS Tear",
+    "64bit CAS Tear",
+    "128bit CAS Tear",
   };
+
+  static std::mutex KeyedValuesMutex;
+  // Section to key to value
+  static std::map<std::string, std::map<std::string, uint64_t, std::less<>>, std::less<>> KeyedValues;
+
   void Initialize() {
     auto DataDirectory = Config::GetDataDirectory();
     DataDirectory += "Telemetry/";
@@ -50,6 +63,19 @@ namespace FEXCore::Telemetry {
         fs << Name << ": " << *Data << std::endl;
       }
 
+      std::scoped_lock lk(KeyedValuesMutex);
+      for (auto const &[Section, Values] : KeyedValues) {
+        std::vector<std::pair<std::string_view, uint64_t>> Sorted(Values.begin(), Values.end());
+        std::stable_sort(Sorted.begin(), Sorted.end(), [](auto const &lhs, auto const &rhs) {
+          return lhs.second > rhs.second;
+        });
+
+        fs << std::endl << "[" << Section << "]" << std::endl;
+        for (auto const &[Key, Data] : Sorted) {
+          fs << Key << ": " << Data << std::endl;
+        }
+      }
+
       fs.flush();
       fs.close();
     }
@@ -58,5 +84,21 @@ namespace FEXCore::Telemetry {
   Value &GetObject(TelemetryType Type) {
     return TelemetryValues.at(Type);
   }
+
+  void AddKeyedValue(std::string_view Section, std::string_view Key, uint64_t Value) {
+    std::scoped_lock lk(KeyedValuesMutex);
+    auto SectionIt = KeyedValues.find(Section);
+    if (SectionIt == KeyedValues.end()) {
+      SectionIt = KeyedValues.emplace(Section, decltype(KeyedValues)::mapped_type{}).first;
+    }
+
+    auto KeyIt = SectionIt->second.find(Key);
+    if (KeyIt == SectionIt->second.end()) {
+      SectionIt->second.emplace(Key, Value);
+    }
+    else {
+      KeyIt->second += Value;
+    }
+  }
 #endif
 }
@@ -149,6 +149,22 @@ namespace Type {
 
   FEX_DEFAULT_VISIBILITY void AddLayer(std::unique_ptr<FEXCore::Config::Layer> _Layer);
 
+  /**
+   * @brief Gets the config files this process loaded as a sealed memfd for a FEX child to load
+   *
+   * Created on first use, has FD_CLOEXEC set.
+   *
+   * @return The fd or -1 on failure
+   */
+  FEX_DEFAULT_VISIBILITY int GetSnapshotFD();
+
+  /**
+   * @brief Maps a snapshot from a FEX parent, config files that haven't changed since then don't get parsed again
+   *
+   * Needs to happen before the layers load. Takes ownership of FD if it is a sealed memfd.
+   */
+  FEX_DEFAULT_VISIBILITY void LoadSnapshot(int FD);
+
   FEX_DEFAULT_VISIBILITY bool Exists(ConfigOption Option);
   FEX_DEFAULT_VISIBILITY std::optional<LayerValue*> All(ConfigOption Option);
   FEX_DEFAULT_VISIBILITY std::optional<std::string*> Get(ConfigOption Option);
@@ -89,6 +89,12 @@ class LLVMCore;
     }
 
     virtual void ClearCache() {}
+    /**
+     * @brief Drops all code for a thread object that is about to be reused by a new guest thread
+     *
+     * Unlike ClearCache the code buffer isn't grown, the new thread starts from an empty cache
+     */
+    virtual void ResetCache() { ClearCache(); }
     virtual void CopyNecessaryDataForCompileThread(CPUBackend *Original) {}
     virtual bool IsAddressInJITCode(uint64_t Address, bool IncludeDispatcher = true, bool IncludeCompileService = true) const { return false; }
 
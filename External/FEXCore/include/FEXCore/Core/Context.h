@@ -51,6 +51,16 @@ namespace FEXCore::Context {
 
   using ExitHandler = std::function<void(uint64_t ThreadId, FEXCore::Context::ExitReason)>;
 
+  /**
+   * @brief Names a guest code location for the profilers
+   *
+   * @param Filename The file the code was mapped from
+   * @param FileOffset Offset of the code in that file
+   *
+   * @return The symbol name or an empty string if there isn't one
+   */
+  using GuestSymbolizer = std::function<std::string(const std::string& Filename, uint64_t FileOffset)>;
+
   /**
    * @brief This initializes internal FEXCore state that is shared between contexts and requires overhead to setup
    */
@@ -103,6 +113,14 @@ namespace FEXCore::Context {
    */
   FEX_DEFAULT_VISIBILITY void Pause(FEXCore::Context::Context *CTX);
 
+  /**
+   * @brief Pauses execution of every thread except the calling one
+   *
+   * Blocks until none of the other threads run guest code anymore. They are never resumed, this is for a thread that
+   * takes the process down with it.
+   */
+  FEX_DEFAULT_VISIBILITY void PauseOtherThreads(FEXCore::Context::Context *CTX);
+
   /**
    * @brief Starts (or continues) the CPU core
    *
@@ -238,9 +256,20 @@ namespace FEXCore::Context {
 
   FEX_DEFAULT_VISIBILITY void AddNamedRegion(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length, uintptr_t Offset, const std::string& Name);
   FEX_DEFAULT_VISIBILITY void RemoveNamedRegion(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length);
+  /**
+   * @brief Tells FEXCore about guest mapping changes so it knows which memory can't change
+   *
+   * Ranges need to be removed or lose permissions before the host mapping changes, and get added after.
+   */
+  FEX_DEFAULT_VISIBILITY void AddGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length, bool PrivateFile, int Prot);
+  FEX_DEFAULT_VISIBILITY void RemoveGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length);
+  FEX_DEFAULT_VISIBILITY void ProtectGuestMapping(FEXCore::Context::Context *CTX, uintptr_t Base, uintptr_t Length, int Prot);
+  // The calls above do nothing unless this is true
+  FEX_DEFAULT_VISIBILITY bool TracksGuestMappings(FEXCore::Context::Context *CTX);
   FEX_DEFAULT_VISIBILITY void SetAOTIRLoader(FEXCore::Context::Context *CTX, std::function<int(const std::string&)> CacheReader);
   FEX_DEFAULT_VISIBILITY void SetAOTIRWriter(FEXCore::Context::Context *CTX, std::function<std::unique_ptr<std::ofstream>(const std::string&)> CacheWriter);
   FEX_DEFAULT_VISIBILITY void SetAOTIRRenamer(FEXCore::Context::Context *CTX, std::function<void(const std::string&)> CacheRenamer);
+  FEX_DEFAULT_VISIBILITY void SetGuestSymbolizer(FEXCore::Context::Context *CTX, GuestSymbolizer Symbolizer);
 
   FEX_DEFAULT_VISIBILITY void FinalizeAOTIRCache(FEXCore::Context::Context *CTX);
   FEX_DEFAULT_VISIBILITY void WriteFilesWithCode(FEXCore::Context::Context *CTX, std::function<void(const std::string& fileid, const std::string& filename)> Writer);
@@ -52,6 +52,30 @@ namespace FEXCore::Core {
      */
     uint64_t InSyscallInfo{};
     InternalThreadState* Thread;
+
+    /**
+     * @brief Host side shadow of the guest's call stack
+     *
+     * Guest calls push a pointer to a link record in the calling block, guest returns pop it.
+     * The record is the same {HostCode, GuestRIP} pair that constant block exits use, so a return only needs to
+     * compare the record's RIP and jump through it. It gets linked and unlinked alongside every other block link.
+     *
+     * Records live in the code buffer so entries must be dropped whenever the code cache is cleared.
+     * Empty entries are zero.
+     */
+    static constexpr size_t RETURN_STACK_SIZE = 64;
+    static constexpr uint64_t RETURN_STACK_MASK = RETURN_STACK_SIZE * sizeof(uint64_t) - 1;
+
+    // Byte offset of the next entry, wraps on overflow
+    uint64_t ReturnStackOffset{};
+    uint64_t ReturnStack[RETURN_STACK_SIZE]{};
+
+    void ClearReturnStack() {
+      ReturnStackOffset = 0;
+      for (auto &Entry : ReturnStack) {
+        Entry = 0;
+      }
+    }
   };
   static_assert(offsetof(CpuStateFrame, State) == 0, "CPUState must be first member in CpuStateFrame");
   static_assert(offsetof(CpuStateFrame, State.rip) == 0, "rip must be zero offset in CpuStateFrame");
@@ -69,11 +69,30 @@ namespace Core {
     // Called from the thunk handler to handle the signal
     void HandleSignal(int Signal, void *Info, void *UContext);
 
+    /**
+     * @name Guest signal mask
+     *
+     * The guest's signal mask only lives in the frontend, the host mask is left open.
+     * The core saves the mask when it delivers a guest signal and gives it back on sigreturn.
+     * @{ */
+      virtual uint64_t GetGuestSignalMask() = 0;
+
+      /**
+       * @brief Restores the guest's mask on return from a guest signal handler
+       *
+       * @param Mask The guest mask to return to
+       * @param UContext The host context being returned to, the frontend sets the host mask in it
+       */
+      virtual void RestoreGuestSignalMask(uint64_t Mask, void *UContext) = 0;
+    /**  @} */
+
     constexpr static size_t MAX_SIGNALS {64};
 
     // Use the last signal just so we are less likely to ever conflict with something that the guest application is using
     // 64 is used internally by Valgrind
     constexpr static size_t SIGNAL_FOR_PAUSE {63};
+    // Raised by the sampling profiler's per thread timers, leaves SIGPROF to the guest
+    constexpr static size_t SIGNAL_FOR_PROFILER {62};
 
   protected:
     FEXCore::Core::InternalThreadState *GetTLSThread();
@@ -16,6 +16,9 @@ namespace Debug {
 
   void CompileRIP(FEXCore::Context::Context *CTX, uint64_t RIP);
 
+  // Keeps the IR and debug data of every block instead of evicting it, needs to be called before InitCore
+  void RetainDebugData(FEXCore::Context::Context *CTX);
+
   uint64_t GetThreadCount(FEXCore::Context::Context *CTX);
   FEXCore::Core::RuntimeStats *GetRuntimeStatsForThread(FEXCore::Context::Context *CTX, uint64_t Thread);
 
@@ -12,13 +12,26 @@
 
 namespace FEXCore {
   class LookupCache;
+  class LocalIRCache;
   class CompileService;
+  class BlockProfilerThread;
+  class CodeStatsThread;
+  class CompileTimeStatsThread;
+  class SampleProfilerThread;
 }
 
 namespace FEXCore::Context {
   struct Context;
 }
 
+namespace FEXCore::CPU {
+  struct InterpreterProgram;
+
+  struct InterpreterProgramDeleter {
+    void operator()(InterpreterProgram *Program) const;
+  };
+}
+
 namespace FEXCore::Frontend {
   class Decoder;
 }
@@ -33,6 +46,19 @@ namespace FEXCore::Core {
   struct RuntimeStats {
     std::atomic_uint64_t InstructionsExecuted;
     std::atomic_uint64_t BlocksCompiled;
+
+    // Partial code cache eviction
+    std::atomic_uint64_t CodeSegmentsEvicted;
+    std::atomic_uint64_t BlocksEvicted;
+    // Blocks compiled again after having been evicted
+    std::atomic_uint64_t BlocksRecompiled;
+
+    // Compile time in nanoseconds, only counted while CompileTimeStats is enabled
+    std::atomic_uint64_t DecodeTime;
+    std::atomic_uint64_t DispatchTime;
+    std::atomic_uint64_t PassTime; ///< Every pass but register allocation
+    std::atomic_uint64_t RATime;
+    std::atomic_uint64_t CodegenTime;
   };
 
   struct DebugDataSubblock {
@@ -53,6 +79,7 @@ namespace FEXCore::Core {
     uint64_t TimeSpentInCode; ///< How long this code has spent time running
     uint64_t RunCount; ///< Number of times this block of code has been run
     std::vector<DebugDataSubblock> Subblocks;
+    std::vector<uint64_t> ReadOnlyPages; ///< Pages of read-only memory the code folded loads from
   };
 
   enum class SignalEvent {
@@ -68,9 +95,15 @@ namespace FEXCore::Core {
     std::unique_ptr<FEXCore::IR::IRListView, FEXCore::IR::IRListViewDeleter> IR;
     std::unique_ptr<FEXCore::IR::RegisterAllocationData, FEXCore::IR::RegisterAllocationDataDeleter> RAData;
     std::unique_ptr<FEXCore::Core::DebugData> DebugData;
+    // Only used by the interpreter, created the first time the block runs
+    std::unique_ptr<FEXCore::CPU::InterpreterProgram, FEXCore::CPU::InterpreterProgramDeleter> InterpreterProgram{};
   };
 
   struct InternalThreadState {
+    // Defined where the types of everything the thread owns are complete
+    InternalThreadState();
+    ~InternalThreadState();
+
     FEXCore::Core::CpuStateFrame* CurrentFrame = &BaseFrameState;
 
     struct {
@@ -80,7 +113,7 @@ namespace FEXCore::Core {
       std::atomic_bool ThreadSleeping {false};
     } RunningEvents;
 
-    FEXCore::Context::Context *CTX;
+    FEXCore::Context::Context *CTX{};
     std::atomic<SignalEvent> SignalReason{SignalEvent::Nothing};
 
     std::unique_ptr<FEXCore::Threads::Thread> ExecutionThread;
@@ -92,7 +125,15 @@ namespace FEXCore::Core {
     std::unique_ptr<FEXCore::CPU::CPUBackend> CPUBackend;
     std::unique_ptr<FEXCore::LookupCache> LookupCache;
 
-    std::unordered_map<uint64_t, LocalIREntry> LocalIRCache;
+    std::unique_ptr<FEXCore::LocalIRCache> LocalIRCache;
+
+    // Only exist while the matching profiler is enabled
+    std::unique_ptr<FEXCore::SampleProfilerThread> SampleProfiler;
+    std::unique_ptr<FEXCore::BlockProfilerThread> BlockProfiler;
+    // Only exists while code statistics are enabled
+    std::unique_ptr<FEXCore::CodeStatsThread> CodeStats;
+    // Only exists while compile time statistics are enabled
+    std::unique_ptr<FEXCore::CompileTimeStatsThread> CompileTimes;
 
     std::unique_ptr<FEXCore::Frontend::Decoder> FrontendDecoder;
     std::unique_ptr<FEXCore::IR::PassManager> PassManager;
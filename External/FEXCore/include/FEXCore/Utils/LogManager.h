@@ -48,6 +48,12 @@ static inline void AFmt(bool, const char*, ...) {}
 namespace Msg {
 using MsgHandler = void(*)(DebugLevels Level, char const *Message);
 FEX_DEFAULT_VISIBILITY void InstallHandler(MsgHandler Handler);
+
+// Receives the message before it is formatted, for handlers that can defer formatting
+// The format string and arguments are only valid for the duration of the call
+using MsgFmtHandler = void(*)(DebugLevels Level, char const *fmt, const fmt::format_args& args);
+FEX_DEFAULT_VISIBILITY void InstallFmtHandler(MsgFmtHandler Handler);
+
 FEX_DEFAULT_VISIBILITY void UnInstallHandlers();
 
 FEX_DEFAULT_VISIBILITY void D(const char *fmt, ...);
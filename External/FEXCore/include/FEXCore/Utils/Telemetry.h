@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <type_traits>
 #include <filesystem>
+#include <string_view>
 
 namespace FEXCore::Telemetry {
 #ifndef FEX_DISABLE_TELEMETRY
@@ -41,6 +42,14 @@ namespace FEXCore::Telemetry {
 
   Value &GetObject(TelemetryType Type);
 
+  /**
+   * @brief Adds to an open ended counter, like the use count of an opcode
+   *
+   * Written after the fixed values, grouped by section and sorted by count.
+   * Takes a lock, not meant for hot paths.
+   */
+  FEX_DEFAULT_VISIBILITY void AddKeyedValue(std::string_view Section, std::string_view Key, uint64_t Value);
+
   FEX_DEFAULT_VISIBILITY void Initialize();
   FEX_DEFAULT_VISIBILITY void Shutdown(std::filesystem::path &ApplicationName);
 
@@ -62,6 +71,7 @@ namespace FEXCore::Telemetry {
 #else
   static inline void Initialize() {}
   static inline void Shutdown(std::filesystem::path &) {}
+  static inline void AddKeyedValue(std::string_view, std::string_view, uint64_t) {}
 
 #define FEXCORE_TELEMETRY_STATIC_INIT(Name, Type)
 #define FEXCORE_TELEMETRY_INIT(Name, Type)
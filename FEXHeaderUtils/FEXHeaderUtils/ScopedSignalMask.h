@@ -10,6 +10,26 @@
 #include <unistd.h>
 
 namespace FHU {
+  /**
+   * @brief A class that masks signals until it goes out of scope
+   *
+   * For work that takes multiple locks or does syscalls between them, none of which can be interrupted by a signal
+   */
+  class ScopedSignalMask final {
+    public:
+      ScopedSignalMask(uint64_t Mask = ~0ULL) {
+        // Mask all signals, storing the original incoming mask
+        ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &Mask, &OriginalMask, sizeof(OriginalMask));
+      }
+
+      ~ScopedSignalMask() {
+        // Unmask back to the original signal mask
+        ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &OriginalMask, nullptr, sizeof(OriginalMask));
+      }
+    private:
+      uint64_t OriginalMask{};
+  };
+
   /**
    * @brief A class that masks signals and locks a mutex until it goes out of scope
    *
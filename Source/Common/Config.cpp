@@ -4,10 +4,12 @@
 #include <FEXCore/Config/Config.h>
 
 #include <cstring>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
 #include <map>
 #include <list>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <json-maker.h>
@@ -77,4 +79,60 @@ namespace FEX::Config {
     }
     return {};
   }
+
+  // Holds the fd number of the snapshot
+  constexpr std::string_view SnapshotVariable = "FEX_CONFIG_SNAPSHOT=";
+
+  static bool IsSnapshotVariable(const char *Env) {
+    return strncmp(Env, SnapshotVariable.data(), SnapshotVariable.size()) == 0;
+  }
+
+  SnapshotEnvironment::SnapshotEnvironment(char* const* envp) {
+    // Whatever the guest passed in doesn't point to our snapshot
+    for (auto Env = envp; Env && *Env; ++Env) {
+      if (!IsSnapshotVariable(*Env)) {
+        Environment.emplace_back(*Env);
+      }
+    }
+
+    FD = FEXCore::Config::GetSnapshotFD();
+    if (FD != -1 && fcntl(FD, F_SETFD, 0) != -1) {
+      Variable = std::string(SnapshotVariable) + std::to_string(FD);
+      Environment.emplace_back(Variable.data());
+    }
+    else {
+      FD = -1;
+    }
+
+    Environment.emplace_back(nullptr);
+  }
+
+  SnapshotEnvironment::~SnapshotEnvironment() {
+    if (FD != -1) {
+      // The execve failed, keep the snapshot away from anything else this process starts
+      fcntl(FD, F_SETFD, FD_CLOEXEC);
+    }
+  }
+
+  void ConsumeConfigSnapshot(char **envp) {
+    auto Out = envp;
+    for (auto Env = envp; Env && *Env; ++Env) {
+      if (!IsSnapshotVariable(*Env)) {
+        *Out++ = *Env;
+        continue;
+      }
+
+      char *End{};
+      const char *Number = *Env + SnapshotVariable.size();
+      long FD = strtol(Number, &End, 10);
+      if (End != Number && *End == '\0' && FD >= 0 && FD <= INT32_MAX) {
+        FEXCore::Config::LoadSnapshot(FD);
+      }
+    }
+
+    // The guest never gets to see it
+    if (Out) {
+      *Out = nullptr;
+    }
+  }
 }
@@ -2,6 +2,7 @@
 #include <FEXCore/Config/Config.h>
 
 #include <string>
+#include <vector>
 
 /**
  * @brief This is a singleton for storing global configuration state
@@ -26,4 +27,29 @@ namespace FEX::Config {
     char **argv,
     char **const envp
   );
+
+  /**
+   * @brief Environment for an execve of FEX that hands the config snapshot down
+   *
+   * The snapshot fd survives the execve while this is alive. Only lives across the execve, which only returns on failure.
+   */
+  class SnapshotEnvironment final {
+  public:
+    explicit SnapshotEnvironment(char* const* envp);
+    ~SnapshotEnvironment();
+
+    char* const* Get() const { return Environment.data(); }
+
+  private:
+    int FD{-1};
+    std::string Variable;
+    std::vector<char*> Environment;
+  };
+
+  /**
+   * @brief Loads the config snapshot from a FEX parent and removes its variable from envp
+   *
+   * Needs to happen before LoadConfig.
+   */
+  void ConsumeConfigSnapshot(char **envp);
 }
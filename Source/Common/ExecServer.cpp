@@ -0,0 +1,844 @@
+/*
+$info$
+tags: Common|ExecServer
+desc: Starts guest programs from an already initialized FEX instead of executing FEX from scratch
+$end_info$
+*/
+
+#include "Common/ExecServer.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <grp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/personality.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#ifndef SYS_close_range
+// Same number on every architecture
+#define SYS_close_range 436
+#endif
+
+namespace FEX::ExecServer {
+  namespace Common {
+    constexpr uint32_t REQUEST_MAGIC = 0x45584546; // 'FEXE'
+
+    // SCM_RIGHTS can carry at most 253 fds per message
+    constexpr size_t FDS_PER_MESSAGE = 250;
+
+    struct RequestHeader {
+      uint32_t Magic;
+      uint32_t ArgCount;
+      uint32_t EnvCount;
+      // Doesn't count the working directory and the start fd, which are always sent first
+      uint32_t FDCount;
+      uint32_t Umask;
+      // Supplementary groups, sent after the fd numbers
+      uint32_t GroupCount;
+      // Null terminated arguments then environment variables
+      uint64_t StringSize;
+      sigset_t SignalMask;
+      // Bit N - 1 is set if signal N is ignored, the only dispositions that survive an execve
+      uint64_t IgnoredSignals;
+      int32_t Nice;
+      uint32_t Personality;
+      // Real, effective and saved
+      uid_t UIDs[3];
+      gid_t GIDs[3];
+      rlimit Limits[RLIMIT_NLIMITS];
+    };
+
+    enum class ReplyType : uint32_t {
+      // Value is the PID of the program
+      TYPE_STARTED,
+      // Value is the program's wait status
+      TYPE_EXITED,
+    };
+
+    struct Reply {
+      ReplyType Type;
+      int32_t Value;
+    };
+
+    static socklen_t GetSocketAddress(sockaddr_un *Addr) {
+      // Servers of different FEX builds must not pick up each other's programs
+      struct stat Self{};
+      stat("/proc/self/exe", &Self);
+      const auto Name = fmt::format("FEXExecServer-{}-{:x}-{:x}-{}", getuid(), Self.st_dev, Self.st_ino, Self.st_mtim.tv_sec);
+
+      // Abstract socket, nothing is left behind in the filesystem
+      Addr->sun_family = AF_UNIX;
+      Addr->sun_path[0] = '\0';
+      const size_t Length = std::min(Name.size(), sizeof(Addr->sun_path) - 1);
+      memcpy(&Addr->sun_path[1], Name.data(), Length);
+      return offsetof(sockaddr_un, sun_path) + 1 + Length;
+    }
+
+    static bool WriteAll(int FD, void const *Data, size_t Size) {
+      auto Ptr = reinterpret_cast<uint8_t const*>(Data);
+      while (Size) {
+        const ssize_t Result = ::send(FD, Ptr, Size, MSG_NOSIGNAL);
+        if (Result == -1 && errno == EINTR) {
+          continue;
+        }
+        if (Result <= 0) {
+          return false;
+        }
+        Ptr += Result;
+        Size -= Result;
+      }
+      return true;
+    }
+
+    // Reads exactly Size bytes so it never eats in to the messages carrying fds
+    static bool ReadAll(int FD, void *Data, size_t Size) {
+      auto Ptr = reinterpret_cast<uint8_t*>(Data);
+      while (Size) {
+        const ssize_t Result = ::recv(FD, Ptr, Size, 0);
+        if (Result == -1 && errno == EINTR) {
+          continue;
+        }
+        if (Result <= 0) {
+          return false;
+        }
+        Ptr += Result;
+        Size -= Result;
+      }
+      return true;
+    }
+
+    static bool SendFDs(int Socket, std::vector<int> const &FDs) {
+      for (size_t i = 0; i < FDs.size(); i += FDS_PER_MESSAGE) {
+        const size_t Count = std::min(FDS_PER_MESSAGE, FDs.size() - i);
+
+        // Some data needs to go along with the ancillary data, doesn't matter what
+        char Data{};
+        iovec iov{&Data, sizeof(Data)};
+
+        std::vector<uint8_t> Control(CMSG_SPACE(Count * sizeof(int)));
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = Control.data();
+        msg.msg_controllen = Control.size();
+
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_len = CMSG_LEN(Count * sizeof(int));
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        memcpy(CMSG_DATA(cmsg), &FDs[i], Count * sizeof(int));
+
+        if (sendmsg(Socket, &msg, MSG_NOSIGNAL) != sizeof(Data)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    static bool ReceiveFDs(int Socket, size_t Count, std::vector<int> *FDs) {
+      while (FDs->size() < Count) {
+        const size_t BatchCount = std::min(FDS_PER_MESSAGE, Count - FDs->size());
+
+        char Data{};
+        iovec iov{&Data, sizeof(Data)};
+
+        std::vector<uint8_t> Control(CMSG_SPACE(BatchCount * sizeof(int)));
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = Control.data();
+        msg.msg_controllen = Control.size();
+
+        if (recvmsg(Socket, &msg, MSG_CMSG_CLOEXEC) != sizeof(Data)) {
+          return false;
+        }
+
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+          return false;
+        }
+
+        const size_t Received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const size_t Begin = FDs->size();
+        FDs->resize(Begin + Received);
+        memcpy(&FDs->at(Begin), CMSG_DATA(cmsg), Received * sizeof(int));
+
+        if (Received != BatchCount || (msg.msg_flags & MSG_CTRUNC)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    static std::vector<int> GetOpenFDs() {
+      std::vector<int> FDs;
+      DIR *Dir = opendir("/proc/self/fd");
+      if (!Dir) {
+        return FDs;
+      }
+
+      const int DirFD = dirfd(Dir);
+      while (auto Entry = readdir(Dir)) {
+        if (Entry->d_name[0] == '.') {
+          continue;
+        }
+
+        const int FD = atoi(Entry->d_name);
+        if (FD != DirFD) {
+          FDs.emplace_back(FD);
+        }
+      }
+      closedir(Dir);
+
+      return FDs;
+    }
+  }
+
+  namespace Client {
+    static void StartServer() {
+      // Forks out of a multithreaded process, only async signal safe calls until the execve
+      const pid_t Child = fork();
+      if (Child == 0) {
+        // Detach from the guest's session and leave the server to init
+        setsid();
+        if (fork() != 0) {
+          _exit(0);
+        }
+
+        // Anything left open would keep pipes the guest waits on open for as long as the server lives
+        const int Null = open("/dev/null", O_RDWR);
+        dup2(Null, STDIN_FILENO);
+        dup2(Null, STDOUT_FILENO);
+        dup2(Null, STDERR_FILENO);
+        if (::syscall(SYS_close_range, 3, ~0U, 0) != 0) {
+          for (long FD = 3, Max = sysconf(_SC_OPEN_MAX); FD < Max; ++FD) {
+            close(FD);
+          }
+        }
+
+        const char *Args[] = {"FEXLoader", "--exec-server", nullptr};
+        execve("/proc/self/exe", const_cast<char *const*>(Args), environ);
+        _exit(1);
+      }
+
+      if (Child != -1) {
+        waitpid(Child, nullptr, 0);
+      }
+    }
+
+    // Where the proxy forwards signals to
+    static volatile sig_atomic_t ProgramPID{};
+
+    static void ForwardSignal(int Signal) {
+      const int OldErrno = errno;
+      kill(ProgramPID, Signal);
+      errno = OldErrno;
+    }
+
+    [[noreturn]]
+    static void WaitForProgram(int ServerFD, pid_t PID) {
+      // Signals that would have reached the program if it were still this process
+      // The paused guest threads are still around and might have them unblocked, so forward from whichever thread
+      // they land on
+      ProgramPID = PID;
+
+      struct sigaction Action{};
+      Action.sa_handler = ForwardSignal;
+      Action.sa_flags = SA_RESTART;
+      sigfillset(&Action.sa_mask);
+
+      sigset_t Forwarded;
+      sigemptyset(&Forwarded);
+      for (int Signal : {SIGHUP, SIGINT, SIGQUIT, SIGTERM, SIGUSR1, SIGUSR2, SIGALRM, SIGWINCH, SIGCONT}) {
+        sigaction(Signal, &Action, nullptr);
+        sigaddset(&Forwarded, Signal);
+      }
+      // Also picks up the ones the guest had blocked, the program has its own mask
+      pthread_sigmask(SIG_UNBLOCK, &Forwarded, nullptr);
+
+      // What it looks like if the server goes away, the program gets killed along with it
+      int Status = SIGKILL;
+
+      pollfd PollFD {ServerFD, POLLIN, 0};
+      while (true) {
+        const int Result = poll(&PollFD, 1, -1);
+        if (Result == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          break;
+        }
+
+        Common::Reply Reply{};
+        if (Common::ReadAll(ServerFD, &Reply, sizeof(Reply)) && Reply.Type == Common::ReplyType::TYPE_EXITED) {
+          Status = Reply.Value;
+        }
+        break;
+      }
+
+      if (WIFSIGNALED(Status)) {
+        // Die the same way so our parent gets the same wait status
+        const int Signal = WTERMSIG(Status);
+        signal(Signal, SIG_DFL);
+
+        sigset_t Set;
+        sigemptyset(&Set);
+        sigaddset(&Set, Signal);
+        pthread_sigmask(SIG_UNBLOCK, &Set, nullptr);
+
+        kill(getpid(), Signal);
+        _exit(128 + Signal);
+      }
+
+      _exit(WEXITSTATUS(Status));
+    }
+
+    void TryExec(char const* const* Argv, char* const* Envp, std::function<void()> const &StopOtherThreads) {
+      const int ServerFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (ServerFD == -1) {
+        return;
+      }
+
+      sockaddr_un Addr{};
+      const auto AddrSize = Common::GetSocketAddress(&Addr);
+      if (connect(ServerFD, reinterpret_cast<sockaddr*>(&Addr), AddrSize) == -1) {
+        close(ServerFD);
+        // This one runs like usual, the server is there for the next one
+        StartServer();
+        return;
+      }
+
+      // Don't wait forever on a server that is stuck
+      timeval Timeout{2, 0};
+      setsockopt(ServerFD, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+      setsockopt(ServerFD, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+
+      Common::RequestHeader Header{};
+      Header.Magic = Common::REQUEST_MAGIC;
+
+      std::string Strings;
+      for (auto Arg = Argv; *Arg; ++Arg) {
+        Strings.append(*Arg);
+        Strings.push_back('\0');
+        ++Header.ArgCount;
+      }
+
+      for (auto Env = Envp; Env && *Env; ++Env) {
+        Strings.append(*Env);
+        Strings.push_back('\0');
+        ++Header.EnvCount;
+      }
+      Header.StringSize = Strings.size();
+
+      const mode_t Mask = umask(0);
+      umask(Mask);
+      Header.Umask = Mask;
+
+      // The caller has already switched to the guest's signal mask
+      pthread_sigmask(SIG_BLOCK, nullptr, &Header.SignalMask);
+
+      // Guest SIG_IGN dispositions are mirrored on the host, everything else is reset by an execve
+      for (int Signal = 1; Signal <= 64; ++Signal) {
+        struct sigaction Action{};
+        if (sigaction(Signal, nullptr, &Action) == 0 &&
+            !(Action.sa_flags & SA_SIGINFO) &&
+            Action.sa_handler == SIG_IGN) {
+          Header.IgnoredSignals |= 1ULL << (Signal - 1);
+        }
+      }
+
+      // The nice value is per thread, the calling thread is the one doing the execve
+      errno = 0;
+      Header.Nice = getpriority(PRIO_PROCESS, 0);
+      if (Header.Nice == -1 && errno != 0) {
+        close(ServerFD);
+        return;
+      }
+
+      Header.Personality = personality(0xFFFFFFFF);
+      getresuid(&Header.UIDs[0], &Header.UIDs[1], &Header.UIDs[2]);
+      getresgid(&Header.GIDs[0], &Header.GIDs[1], &Header.GIDs[2]);
+      for (int Resource = 0; Resource < RLIMIT_NLIMITS; ++Resource) {
+        getrlimit((enum __rlimit_resource)(Resource), &Header.Limits[Resource]);
+      }
+
+      const int GroupCount = getgroups(0, nullptr);
+      std::vector<gid_t> Groups(std::max(GroupCount, 0));
+      if (GroupCount < 0 || getgroups(Groups.size(), Groups.data()) != GroupCount) {
+        close(ServerFD);
+        return;
+      }
+      Header.GroupCount = GroupCount;
+
+      // The program waits for this before starting, so it never runs alongside our other threads
+      // A socket rather than a pipe so a program that died already can't SIGPIPE us
+      int Start[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, Start) == -1) {
+        close(ServerFD);
+        return;
+      }
+
+      // The working directory, the start fd and every fd that would survive an execve
+      std::vector<int> FDs;
+      const int CWD = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+      if (CWD == -1) {
+        close(Start[0]);
+        close(Start[1]);
+        close(ServerFD);
+        return;
+      }
+      FDs.emplace_back(CWD);
+      FDs.emplace_back(Start[0]);
+
+      std::vector<int32_t> FDNumbers;
+      for (int FD : Common::GetOpenFDs()) {
+        const int Flags = fcntl(FD, F_GETFD);
+        if (Flags == -1 || (Flags & FD_CLOEXEC)) {
+          continue;
+        }
+        FDs.emplace_back(FD);
+        FDNumbers.emplace_back(FD);
+      }
+      Header.FDCount = FDNumbers.size();
+
+      const bool Sent =
+        Common::WriteAll(ServerFD, &Header, sizeof(Header)) &&
+        Common::WriteAll(ServerFD, Strings.data(), Strings.size()) &&
+        Common::WriteAll(ServerFD, FDNumbers.data(), FDNumbers.size() * sizeof(int32_t)) &&
+        Common::WriteAll(ServerFD, Groups.data(), Groups.size() * sizeof(gid_t)) &&
+        Common::SendFDs(ServerFD, FDs);
+      close(CWD);
+      close(Start[0]);
+
+      Common::Reply Reply{};
+      if (!Sent ||
+          !Common::ReadAll(ServerFD, &Reply, sizeof(Reply)) ||
+          Reply.Type != Common::ReplyType::TYPE_STARTED) {
+        // Also stops the program if it got started after all
+        close(Start[1]);
+        close(ServerFD);
+        return;
+      }
+
+      // Like execve, nothing but the program runs guest code from here on
+      StopOtherThreads();
+
+      // If this fails the program is already gone and the server reports how it went
+      const char Go{};
+      Common::WriteAll(Start[1], &Go, sizeof(Go));
+      close(Start[1]);
+
+      // The program runs as long as it likes
+      Timeout = {};
+      setsockopt(ServerFD, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+
+      WaitForProgram(ServerFD, Reply.Value);
+    }
+  }
+
+  namespace Server {
+    // Quits after this long without any programs running
+    constexpr int IDLE_TIMEOUT_MS = 60 * 1000;
+    // Limits on what a client can make us allocate
+    constexpr uint64_t MAX_STRING_SIZE = 64 * 1024 * 1024;
+    constexpr uint32_t MAX_FDS = 64 * 1024;
+    constexpr uint32_t MAX_GROUPS = 64 * 1024;
+
+    struct ReceivedRequest {
+      Request Program;
+      Common::RequestHeader Header;
+      // First is the working directory, then the start fd, the rest go to the matching Targets entry
+      std::vector<int> FDs;
+      std::vector<int32_t> Targets;
+      std::vector<gid_t> Groups;
+    };
+
+    static bool SameFile(std::string const &Ours, std::string const &Theirs) {
+      struct stat OurStat{}, TheirStat{};
+      if (stat(Ours.c_str(), &OurStat) == -1) {
+        // Namespaces this kernel doesn't have can't differ either
+        return errno == ENOENT && stat(Theirs.c_str(), &TheirStat) == -1 && errno == ENOENT;
+      }
+
+      return stat(Theirs.c_str(), &TheirStat) == 0 &&
+             OurStat.st_dev == TheirStat.st_dev &&
+             OurStat.st_ino == TheirStat.st_ino;
+    }
+
+    // The program must not escape a chroot or container the client was in
+    static bool SharesSandbox(pid_t PID) {
+      const auto Proc = fmt::format("/proc/{}", PID);
+      if (!SameFile("/", Proc + "/root")) {
+        return false;
+      }
+
+      for (auto Namespace : {"mnt", "user", "pid", "ipc", "uts", "cgroup"}) {
+        if (!SameFile(fmt::format("/proc/self/ns/{}", Namespace), fmt::format("{}/ns/{}", Proc, Namespace))) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    static bool ReceiveRequest(int ClientFD, ReceivedRequest *Received) {
+      // The abstract socket is visible to every process in the network namespace
+      ucred Cred{};
+      socklen_t CredSize = sizeof(Cred);
+      if (getsockopt(ClientFD, SOL_SOCKET, SO_PEERCRED, &Cred, &CredSize) == -1 ||
+          Cred.uid != getuid() ||
+          !SharesSandbox(Cred.pid)) {
+        return false;
+      }
+
+      // A stuck client can't hold up everyone else for long
+      timeval Timeout{2, 0};
+      setsockopt(ClientFD, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+      setsockopt(ClientFD, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+
+      Common::RequestHeader Header{};
+      if (!Common::ReadAll(ClientFD, &Header, sizeof(Header)) ||
+          Header.Magic != Common::REQUEST_MAGIC ||
+          Header.StringSize > MAX_STRING_SIZE ||
+          Header.FDCount > MAX_FDS ||
+          Header.GroupCount > MAX_GROUPS ||
+          Header.ArgCount == 0 ||
+          static_cast<uint64_t>(Header.ArgCount) + Header.EnvCount > Header.StringSize) {
+        return false;
+      }
+
+      std::string Strings(Header.StringSize, '\0');
+      Received->Targets.resize(Header.FDCount);
+      Received->Groups.resize(Header.GroupCount);
+      if (!Common::ReadAll(ClientFD, Strings.data(), Strings.size()) ||
+          !Common::ReadAll(ClientFD, Received->Targets.data(), Received->Targets.size() * sizeof(int32_t)) ||
+          !Common::ReadAll(ClientFD, Received->Groups.data(), Received->Groups.size() * sizeof(gid_t)) ||
+          !Common::ReceiveFDs(ClientFD, Header.FDCount + 2, &Received->FDs)) {
+        return false;
+      }
+
+      for (auto Target : Received->Targets) {
+        if (Target < 0) {
+          return false;
+        }
+      }
+
+      size_t Offset{};
+      auto NextString = [&](std::vector<std::string> *Strings_) {
+        const auto End = Strings.find('\0', Offset);
+        if (End == std::string::npos) {
+          return false;
+        }
+        Strings_->emplace_back(Strings, Offset, End - Offset);
+        Offset = End + 1;
+        return true;
+      };
+
+      for (uint32_t i = 0; i < Header.ArgCount; ++i) {
+        if (!NextString(&Received->Program.Args)) {
+          return false;
+        }
+      }
+
+      for (uint32_t i = 0; i < Header.EnvCount; ++i) {
+        if (!NextString(&Received->Program.Environment)) {
+          return false;
+        }
+      }
+
+      Received->Header = Header;
+      return true;
+    }
+
+    // Takes on the state of the client that survives an execve
+    static bool SetupCredentials(ReceivedRequest const &Received) {
+      auto const &Header = Received.Header;
+
+      for (int Signal = 1; Signal <= 64; ++Signal) {
+        if (Signal == SIGKILL || Signal == SIGSTOP) {
+          continue;
+        }
+
+        // Anything the server inherited gets reset as well
+        // Fails for the signals reserved by libc, those are never ignored
+        struct sigaction Action{};
+        Action.sa_handler = (Header.IgnoredSignals & (1ULL << (Signal - 1))) ? SIG_IGN : SIG_DFL;
+        sigaction(Signal, &Action, nullptr);
+      }
+
+      if (personality(Header.Personality) == -1) {
+        return false;
+      }
+
+      // Before the limits, a lowered RLIMIT_NICE could otherwise forbid it
+      if (setpriority(PRIO_PROCESS, 0, Header.Nice) == -1) {
+        return false;
+      }
+
+      for (int Resource = 0; Resource < RLIMIT_NLIMITS; ++Resource) {
+        if (setrlimit((enum __rlimit_resource)(Resource), &Header.Limits[Resource]) == -1) {
+          return false;
+        }
+      }
+
+      // Only needs privileges if the client's credentials differ from ours, the user ID last so the rest can't be
+      // refused by the ones it drops
+      std::vector<gid_t> Groups(std::max(getgroups(0, nullptr), 0));
+      Groups.resize(std::max(getgroups(Groups.size(), Groups.data()), 0));
+      if (Groups != Received.Groups &&
+          setgroups(Received.Groups.size(), Received.Groups.data()) == -1) {
+        return false;
+      }
+
+      return setresgid(Header.GIDs[0], Header.GIDs[1], Header.GIDs[2]) == 0 &&
+             setresuid(Header.UIDs[0], Header.UIDs[1], Header.UIDs[2]) == 0;
+    }
+
+    // Turns the freshly forked child in to what the client's execve would have started with
+    // Reports back through ReadyFD once the rest can't fail anymore, then waits for the client to let it start
+    static bool SetupProgram(ReceivedRequest &Received, pid_t ServerPID, int ReadyFD) {
+      // The proxy can only report the exit of programs the server is around to reap
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() != ServerPID) {
+        return false;
+      }
+
+      // Moves the received fds above every number they need to end up at
+      int Base = 3;
+      for (auto Target : Received.Targets) {
+        Base = std::max(Base, Target + 1);
+      }
+
+      std::vector<int> Moved;
+      Moved.reserve(Received.FDs.size() + 1);
+      for (int FD : Received.FDs) {
+        Moved.emplace_back(fcntl(FD, F_DUPFD_CLOEXEC, Base));
+        close(FD);
+      }
+
+      Moved.emplace_back(fcntl(ReadyFD, F_DUPFD_CLOEXEC, Base));
+      close(ReadyFD);
+      ReadyFD = Moved.back();
+      Moved.pop_back();
+
+      // Nothing of the server's survives, like an execve wouldn't have kept it either
+      for (int FD : Common::GetOpenFDs()) {
+        if (FD != ReadyFD && std::find(Moved.begin(), Moved.end(), FD) == Moved.end()) {
+          close(FD);
+        }
+      }
+
+      for (size_t i = 2; i < Moved.size(); ++i) {
+        dup2(Moved[i], Received.Targets[i - 2]);
+        close(Moved[i]);
+      }
+
+      if (fchdir(Moved[0]) == -1) {
+        return false;
+      }
+      close(Moved[0]);
+
+      umask(Received.Header.Umask);
+
+      if (!SetupCredentials(Received)) {
+        return false;
+      }
+
+      const char Ready{};
+      if (!Common::WriteAll(ReadyFD, &Ready, sizeof(Ready))) {
+        return false;
+      }
+      close(ReadyFD);
+
+      // The client stops its other threads first, the guest never sees both at once
+      char Go{};
+      if (!Common::ReadAll(Moved[1], &Go, sizeof(Go))) {
+        return false;
+      }
+      close(Moved[1]);
+
+      // SIGCHLD was blocked for the server, this replaces that as well
+      pthread_sigmask(SIG_SETMASK, &Received.Header.SignalMask, nullptr);
+      return true;
+    }
+
+    std::optional<Request> Run() {
+      const int ListenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (ListenFD == -1) {
+        return std::nullopt;
+      }
+
+      sockaddr_un Addr{};
+      const auto AddrSize = Common::GetSocketAddress(&Addr);
+      if (bind(ListenFD, reinterpret_cast<sockaddr*>(&Addr), AddrSize) == -1 ||
+          listen(ListenFD, SOMAXCONN) == -1) {
+        // Another server got there first
+        close(ListenFD);
+        return std::nullopt;
+      }
+
+      sigset_t ChildSignal;
+      sigemptyset(&ChildSignal);
+      sigaddset(&ChildSignal, SIGCHLD);
+      pthread_sigmask(SIG_BLOCK, &ChildSignal, nullptr);
+      const int SignalFD = signalfd(-1, &ChildSignal, SFD_CLOEXEC | SFD_NONBLOCK);
+      if (SignalFD == -1) {
+        close(ListenFD);
+        return std::nullopt;
+      }
+
+      const pid_t ServerPID = getpid();
+
+      // Connection to the proxy of every running program, -1 once the proxy has gone away
+      std::unordered_map<pid_t, int> Programs;
+
+      std::vector<pollfd> PollFDs;
+      std::vector<pid_t> PollPIDs;
+
+      while (true) {
+        PollFDs.clear();
+        PollPIDs.clear();
+        PollFDs.push_back({ListenFD, POLLIN, 0});
+        PollFDs.push_back({SignalFD, POLLIN, 0});
+        for (auto [PID, FD] : Programs) {
+          if (FD != -1) {
+            PollFDs.push_back({FD, POLLIN, 0});
+            PollPIDs.emplace_back(PID);
+          }
+        }
+
+        const int Result = poll(PollFDs.data(), PollFDs.size(), Programs.empty() ? IDLE_TIMEOUT_MS : -1);
+        if (Result == 0) {
+          // Idle for long enough
+          break;
+        }
+        if (Result == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          break;
+        }
+
+        // Proxies never send anything after their request, this is them going away
+        // Handled before reaping so a program that exited at the same time isn't confused with a reused PID
+        for (size_t i = 2; i < PollFDs.size(); ++i) {
+          if (PollFDs[i].revents) {
+            const pid_t PID = PollPIDs[i - 2];
+            // The program would have died along with the process it replaced
+            kill(PID, SIGKILL);
+            close(PollFDs[i].fd);
+            Programs[PID] = -1;
+          }
+        }
+
+        if (PollFDs[1].revents & POLLIN) {
+          signalfd_siginfo Info{};
+          while (read(SignalFD, &Info, sizeof(Info)) == sizeof(Info));
+
+          int Status{};
+          pid_t PID{};
+          while ((PID = waitpid(-1, &Status, WNOHANG)) > 0) {
+            auto it = Programs.find(PID);
+            if (it == Programs.end()) {
+              continue;
+            }
+
+            if (it->second != -1) {
+              Common::Reply Reply{Common::ReplyType::TYPE_EXITED, Status};
+              Common::WriteAll(it->second, &Reply, sizeof(Reply));
+              close(it->second);
+            }
+            Programs.erase(it);
+          }
+        }
+
+        if (!(PollFDs[0].revents & POLLIN)) {
+          continue;
+        }
+
+        const int ClientFD = accept4(ListenFD, nullptr, nullptr, SOCK_CLOEXEC);
+        if (ClientFD == -1) {
+          continue;
+        }
+
+        ReceivedRequest Received{};
+        if (!ReceiveRequest(ClientFD, &Received)) {
+          // The client sees the connection close and runs the program itself
+          for (int FD : Received.FDs) {
+            close(FD);
+          }
+          close(ClientFD);
+          continue;
+        }
+
+        int Ready[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, Ready) == -1) {
+          for (int FD : Received.FDs) {
+            close(FD);
+          }
+          close(ClientFD);
+          continue;
+        }
+
+        const pid_t PID = fork();
+        if (PID == 0) {
+          close(Ready[0]);
+          if (!SetupProgram(Received, ServerPID, Ready[1])) {
+            _exit(128 + SIGKILL);
+          }
+          return std::move(Received.Program);
+        }
+
+        for (int FD : Received.FDs) {
+          close(FD);
+        }
+        close(Ready[1]);
+
+        // The client falls back to a normal execve if the program couldn't take on its state
+        char Status{};
+        const bool IsReady = PID != -1 && Common::ReadAll(Ready[0], &Status, sizeof(Status));
+        close(Ready[0]);
+
+        if (!IsReady) {
+          // A child that failed gets reaped like any other, it isn't a program
+          close(ClientFD);
+          continue;
+        }
+
+        Common::Reply Reply{Common::ReplyType::TYPE_STARTED, PID};
+        if (!Common::WriteAll(ClientFD, &Reply, sizeof(Reply))) {
+          kill(PID, SIGKILL);
+          close(ClientFD);
+          Programs[PID] = -1;
+          continue;
+        }
+
+        Programs[PID] = ClientFD;
+      }
+
+      close(SignalFD);
+      close(ListenFD);
+      return std::nullopt;
+    }
+  }
+}
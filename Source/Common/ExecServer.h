@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace FEX::ExecServer {
+  // Client side
+  namespace Client {
+    /**
+     * @brief Asks a running exec server to start a program in place of this process
+     *
+     * The server forks an already initialized FEX with our environment, working directory, umask, signal mask,
+     * ignored signals, credentials, resource limits, nice value, personality and every fd that would survive an
+     * execve. This process then stays around as a proxy that forwards signals to the new one and exits with its exit
+     * status.
+     *
+     * If no server is listening one gets started in the background for the next execve.
+     *
+     * @param Argv FEX's own arguments followed by the program and its arguments, null terminated
+     * @param StopOtherThreads Called once the server took the program, the program only starts after it returns
+     *
+     * @return Only returns if no server took the program, the caller needs to execve like usual
+     */
+    void TryExec(char const* const* Argv, char* const* Envp, std::function<void()> const &StopOtherThreads);
+  }
+
+  // Server side
+  namespace Server {
+    struct Request {
+      std::vector<std::string> Args;
+      std::vector<std::string> Environment;
+    };
+
+    /**
+     * @brief Listens for programs to start until the server has been idle for a while
+     *
+     * Everything that was set up before calling this is shared by every program the server starts.
+     *
+     * @return The program to start in a freshly forked child, nothing in the server once it quits
+     */
+    std::optional<Request> Run();
+  }
+}
@@ -1,25 +1,44 @@
 #include "Common/SocketLogging.h"
 
-#include <FEXCore/Utils/NetStream.h>
 #include <FEXCore/Utils/Threads.h>
 #include <FEXHeaderUtils/Syscalls.h>
 
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <fcntl.h>
+#include <limits.h>
+#include <mutex>
 #include <netdb.h>
 #include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
+#include <thread>
+#include <type_traits>
 #include <unistd.h>
+#include <unordered_map>
+#include <vector>
 
 namespace FEX::SocketLogging {
   namespace Common {
     enum class PacketTypes : uint32_t {
       TYPE_MSG,
       TYPE_ACK,
+      // Registers a format string that the sending thread refers to by id
+      TYPE_FMT_STRING,
+      // Format string id followed by the serialized arguments
+      TYPE_FMT_MSG,
     };
 
     struct PacketHeader {
@@ -37,9 +56,39 @@ namespace FEX::SocketLogging {
       char Msg[0];
     };
 
+    struct PacketFmtString {
+      PacketHeader Header{};
+      uint32_t Id{};
+      // Including the null terminator
+      uint32_t Length{};
+      char Fmt[0];
+    };
+
+    struct PacketFmtMsg {
+      PacketHeader Header{};
+      uint32_t Level{};
+      uint32_t FmtId{};
+      uint32_t ArgsSize{};
+      uint32_t Pad{};
+      uint8_t Args[0];
+    };
+
     static_assert(sizeof(PacketHeader) == 24, "Wrong size");
+    static_assert(sizeof(PacketFmtString) == 32, "Wrong size");
+    static_assert(sizeof(PacketFmtMsg) == 40, "Wrong size");
 
-    static PacketHeader FillHeader(Common::PacketTypes Type) {
+    // Each argument is a type byte followed by its value
+    enum class ArgTypes : uint8_t {
+      INT,     ///< int64_t
+      UINT,    ///< uint64_t
+      BOOL,    ///< uint8_t
+      CHAR,    ///< char
+      DOUBLE,  ///< double
+      POINTER, ///< uint64_t
+      STRING,  ///< uint32_t length followed by the characters
+    };
+
+    static PacketHeader FillHeader(Common::PacketTypes Type, int32_t PID, int32_t TID) {
       struct timespec Time{};
       uint64_t Timestamp{};
       clock_gettime(CLOCK_MONOTONIC, &Time);
@@ -48,73 +97,612 @@ namespace FEX::SocketLogging {
       Common::PacketHeader Msg {
         .Timestamp = Timestamp,
         .PacketType = Type,
-        .PID = ::getpid(),
-        .TID = FHU::Syscalls::gettid(),
+        .PID = PID,
+        .TID = TID,
       };
 
       return Msg;
     }
+
+    static PacketHeader FillHeader(Common::PacketTypes Type) {
+      return FillHeader(Type, ::getpid(), FHU::Syscalls::gettid());
+    }
   }
 
   namespace Client {
-    class ClientConnector {
+    /**
+     * @brief Single producer single consumer ring of encoded packets
+     *
+     * Only the owning thread writes to it, it is drained by whoever holds the connector's flush lock.
+     * Packets are only published once they are complete so the reader never sees half of one.
+     * Pushing doesn't take a lock while there is room, a producer that finds its ring full takes the
+     * flush lock and drains the rings itself.
+     */
+    class MessageRing final {
+      public:
+        constexpr static size_t SIZE = 64 * 1024;
+        // Wake the flusher early once the ring is this full
+        constexpr static size_t WAKE_THRESHOLD = SIZE / 2;
+
+        MessageRing()
+          : Data {std::make_unique<uint8_t[]>(SIZE)} {
+        }
+
+        // Returns the number of bytes in the ring after the push, zero if the packet didn't fit
+        size_t Push(uint8_t const *Packet, size_t Size) {
+          const uint64_t Write = WritePos.load(std::memory_order_relaxed);
+          const uint64_t Read = ReadPos.load(std::memory_order_acquire);
+          if (Size > SIZE - (Write - Read)) {
+            return 0;
+          }
+
+          const size_t Offset = Write % SIZE;
+          const size_t FirstPart = std::min(Size, SIZE - Offset);
+          memcpy(&Data[Offset], Packet, FirstPart);
+          memcpy(&Data[0], Packet + FirstPart, Size - FirstPart);
+
+          WritePos.store(Write + Size, std::memory_order_release);
+          return Write + Size - Read;
+        }
+
+        // Fills up to two iovecs with everything that was published, returns the count
+        size_t Peek(struct iovec *Vecs, uint64_t *End) {
+          const uint64_t Read = ReadPos.load(std::memory_order_relaxed);
+          const uint64_t Write = WritePos.load(std::memory_order_acquire);
+          *End = Write;
+
+          const size_t Size = Write - Read;
+          if (Size == 0) {
+            return 0;
+          }
+
+          const size_t Offset = Read % SIZE;
+          const size_t FirstPart = std::min(Size, SIZE - Offset);
+          Vecs[0] = {&Data[Offset], FirstPart};
+          if (FirstPart == Size) {
+            return 1;
+          }
+
+          Vecs[1] = {&Data[0], Size - FirstPart};
+          return 2;
+        }
+
+        void Consume(uint64_t End) {
+          ReadPos.store(End, std::memory_order_release);
+        }
+
+        // Packets that were lost since the flusher last looked
+        std::atomic<uint64_t> Dropped{};
+        // The owning thread has exited, the ring is freed once it is drained
+        std::atomic<bool> Retired{};
+
+      private:
+        std::unique_ptr<uint8_t[]> Data;
+        std::atomic<uint64_t> WritePos{};
+        std::atomic<uint64_t> ReadPos{};
+    };
+
+    struct ThreadLogState {
+      ~ThreadLogState() {
+        if (Ring) {
+          Ring->Retired.store(true, std::memory_order_release);
+        }
+      }
+
+      struct FmtEntry {
+        uint32_t Id;
+        // Format strings are usually literals but check the contents in case the pointer got reused
+        std::string Fmt;
+      };
+
+      std::shared_ptr<MessageRing> Ring{};
+      int32_t TID{};
+
+      // Format strings are registered with the server per thread
+      std::unordered_map<char const*, FmtEntry> FmtIds{};
+      uint32_t NextFmtId{};
+
+      // Reused between messages so encoding doesn't allocate
+      std::vector<uint8_t> Scratch{};
+
+      // Set while encoding so a signal handler that logs can't corrupt the message in progress
+      bool InHandler{};
+    };
+
+    static thread_local ThreadLogState ThreadState{};
+
+    template<typename T>
+    static void Append(std::vector<uint8_t> &Buffer, T const &Value) {
+      const size_t Offset = Buffer.size();
+      Buffer.resize(Offset + sizeof(T));
+      memcpy(&Buffer[Offset], &Value, sizeof(T));
+    }
+
+    static void AppendString(std::vector<uint8_t> &Buffer, std::string_view Value) {
+      Append(Buffer, Common::ArgTypes::STRING);
+      Append(Buffer, static_cast<uint32_t>(Value.size()));
+      Buffer.insert(Buffer.end(), Value.begin(), Value.end());
+    }
+
+    // Returns false if an argument can't be sent without formatting it
+    static bool EncodeArgs(std::vector<uint8_t> &Buffer, fmt::format_args const &Args) {
+      for (int i = 0;; ++i) {
+        const auto Arg = Args.get(i);
+        if (!Arg) {
+          return true;
+        }
+
+        const bool Encoded = fmt::visit_format_arg([&Buffer](auto Value) -> bool {
+          using T = decltype(Value);
+          if constexpr (std::is_same_v<T, bool>) {
+            Append(Buffer, Common::ArgTypes::BOOL);
+            Append(Buffer, static_cast<uint8_t>(Value));
+          }
+          else if constexpr (std::is_same_v<T, char>) {
+            Append(Buffer, Common::ArgTypes::CHAR);
+            Append(Buffer, Value);
+          }
+          else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t)) {
+            if constexpr (std::is_signed_v<T>) {
+              Append(Buffer, Common::ArgTypes::INT);
+              Append(Buffer, static_cast<int64_t>(Value));
+            }
+            else {
+              Append(Buffer, Common::ArgTypes::UINT);
+              Append(Buffer, static_cast<uint64_t>(Value));
+            }
+          }
+          else if constexpr (std::is_floating_point_v<T>) {
+            Append(Buffer, Common::ArgTypes::DOUBLE);
+            Append(Buffer, static_cast<double>(Value));
+          }
+          else if constexpr (std::is_same_v<T, char const*>) {
+            AppendString(Buffer, Value);
+          }
+          else if constexpr (std::is_same_v<T, fmt::string_view>) {
+            AppendString(Buffer, std::string_view(Value.data(), Value.size()));
+          }
+          else if constexpr (std::is_same_v<T, void const*>) {
+            Append(Buffer, Common::ArgTypes::POINTER);
+            Append(Buffer, reinterpret_cast<uint64_t>(Value));
+          }
+          else {
+            // Custom formatters and 128-bit integers
+            return false;
+          }
+          return true;
+        }, Arg);
+
+        if (!Encoded) {
+          return false;
+        }
+      }
+    }
+
+    class ClientConnector final {
       public:
         ClientConnector(int FD)
-          : Socket {std::make_unique<FEXCore::Utils::NetStream>(FD)} {
+          : Socket {FD}
+          , PID {::getpid()} {
+          StartFlushThread();
         }
-        void MsgHandler(LogMan::DebugLevels Level, bool Synchronize, char const *Message);
+
+        void MsgHandler(LogMan::DebugLevels Level, char const *Message);
+        void MsgFmtHandler(LogMan::DebugLevels Level, char const *Fmt, fmt::format_args const &Args);
         void AssertHandler(char const *Message) {
-          MsgHandler(LogMan::DebugLevels::ASSERT, true, Message);
+          MsgHandler(LogMan::DebugLevels::ASSERT, Message);
+        }
+
+        void Flush(bool Synchronize) {
+          std::lock_guard lk(FlushMutex);
+          AcquireDrain();
+          FlushLocked(Synchronize);
+          ReleaseDrain();
         }
 
+        // For when the process is about to go away, may be called from a signal handler
+        // Doesn't take any locks, only this thread's ring is written out
+        void FlushBeforeExit();
+
+        void CleanupAfterFork();
+
       private:
-        std::unique_ptr<std::iostream> Socket;
+        constexpr static auto FLUSH_INTERVAL = std::chrono::milliseconds(10);
+        // How many times the exit flush yields waiting for another thread's drain to finish
+        constexpr static int EXIT_FLUSH_RETRIES = 100;
+
+        int Socket;
+        int32_t PID;
+
+        std::mutex RingsMutex;
+        std::vector<std::shared_ptr<MessageRing>> Rings;
+
+        // Held while draining the rings, everything below it is only touched with it held
+        std::mutex FlushMutex;
+        std::vector<std::shared_ptr<MessageRing>> FlushRings;
+        std::vector<struct iovec> FlushVecs;
+        std::vector<std::pair<MessageRing*, uint64_t>> FlushConsumed;
+        std::vector<MessageRing*> FlushRetired;
+        std::vector<uint8_t> DroppedNotices;
+
+        // Set by whoever is consuming from the rings, the exit flush takes it without the mutex
+        std::atomic<bool> Draining{};
+        // TID of the thread that holds Draining, so a crash inside a flush doesn't wait on itself
+        std::atomic<int32_t> DrainOwner{};
+
+        void AcquireDrain() {
+          while (Draining.exchange(true, std::memory_order_acquire)) {
+            // Only an exit flush holds it without the mutex, and not for long
+            ::sched_yield();
+          }
+          DrainOwner.store(FHU::Syscalls::gettid(), std::memory_order_relaxed);
+        }
+
+        void ReleaseDrain() {
+          DrainOwner.store(0, std::memory_order_relaxed);
+          Draining.store(false, std::memory_order_release);
+        }
+
+        Event FlushEvent{};
+
+        MessageRing &GetThreadRing();
+        bool RegisterFmt(ThreadLogState &State, char const *Fmt, uint32_t *Id);
+        void PushText(ThreadLogState &State, LogMan::DebugLevels Level, char const *Message);
+        bool Push(ThreadLogState &State, uint8_t const *Packet, size_t Size);
+
+        void StartFlushThread();
+        void FlushThreadFunc();
+        void FlushLocked(bool Synchronize);
+        void WriteAll(struct iovec *Vecs, size_t Count);
     };
 
-    void ClientConnector::MsgHandler(LogMan::DebugLevels Level, bool Synchronize, char const *Message) {
+    MessageRing &ClientConnector::GetThreadRing() {
+      auto &State = ThreadState;
+      if (!State.Ring) {
+        State.Ring = std::make_shared<MessageRing>();
+        State.TID = FHU::Syscalls::gettid();
+
+        std::lock_guard lk(RingsMutex);
+        Rings.emplace_back(State.Ring);
+      }
+      return *State.Ring;
+    }
+
+    bool ClientConnector::Push(ThreadLogState &State, uint8_t const *Packet, size_t Size) {
+      size_t Used = State.Ring->Push(Packet, Size);
+      if (Used == 0) {
+        // Flusher can't keep up, drain it ourselves rather than losing messages
+        Flush(false);
+        Used = State.Ring->Push(Packet, Size);
+        if (Used == 0) {
+          // Bigger than the whole ring
+          State.Ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+
+      if (Used >= MessageRing::WAKE_THRESHOLD) {
+        // Only takes a lock if the flusher hasn't been woken already
+        FlushEvent.NotifyOne();
+      }
+
+      return Used != 0;
+    }
+
+    bool ClientConnector::RegisterFmt(ThreadLogState &State, char const *Fmt, uint32_t *Id) {
+      auto it = State.FmtIds.find(Fmt);
+      if (it != State.FmtIds.end() && it->second.Fmt == Fmt) {
+        *Id = it->second.Id;
+        return true;
+      }
+
+      const size_t Length = strlen(Fmt) + 1;
+      Common::PacketFmtString Packet {
+        .Header = Common::FillHeader(Common::PacketTypes::TYPE_FMT_STRING, PID, State.TID),
+        .Id = State.NextFmtId,
+        .Length = static_cast<uint32_t>(Length),
+      };
+
+      std::vector<uint8_t> Buffer(sizeof(Packet) + Length);
+      memcpy(&Buffer[0], &Packet, sizeof(Packet));
+      memcpy(&Buffer[sizeof(Packet)], Fmt, Length);
+
+      if (!Push(State, Buffer.data(), Buffer.size())) {
+        return false;
+      }
+
+      *Id = State.NextFmtId++;
+      State.FmtIds.insert_or_assign(Fmt, ThreadLogState::FmtEntry{*Id, Fmt});
+      return true;
+    }
+
+    void ClientConnector::PushText(ThreadLogState &State, LogMan::DebugLevels Level, char const *Message) {
       Common::PacketMsg Msg {
-        .Header = Common::FillHeader(Common::PacketTypes::TYPE_MSG),
+        .Header = Common::FillHeader(Common::PacketTypes::TYPE_MSG, PID, State.TID),
         .Level = Level,
       };
-      size_t MsgLen = strlen(Message) + 1;
-      size_t PacketSize = sizeof(Common::PacketMsg) + MsgLen;
-
-      // XXX: Alloca for small packets?
-      Common::PacketMsg *MsgP = reinterpret_cast<Common::PacketMsg*>(malloc(PacketSize));
-      memcpy(MsgP, &Msg, sizeof(Common::PacketMsg));
-      memcpy(MsgP->Msg, Message, MsgLen);
-      // First write the Packet
-      Socket->write(reinterpret_cast<const char*>(MsgP), PacketSize);
-      // Now flush it
-      Socket->flush();
+      const size_t MsgLen = strlen(Message) + 1;
+
+      auto &Scratch = State.Scratch;
+      Scratch.resize(sizeof(Common::PacketMsg) + MsgLen);
+      memcpy(&Scratch[0], &Msg, sizeof(Common::PacketMsg));
+      memcpy(&Scratch[offsetof(Common::PacketMsg, Msg)], Message, MsgLen);
+
+      Push(State, Scratch.data(), Scratch.size());
+    }
+
+    void ClientConnector::MsgHandler(LogMan::DebugLevels Level, char const *Message) {
+      auto &State = ThreadState;
+      if (State.InHandler) {
+        // Logging from a signal handler that interrupted a message
+        // Ring can still be null if the signal landed while it was being created
+        if (State.Ring) {
+          State.Ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+
+      State.InHandler = true;
+      GetThreadRing();
+      PushText(State, Level, Message);
+      State.InHandler = false;
+
+      if (Level == LogMan::DebugLevels::ASSERT) {
+        // Make sure the server has it before we go down
+        Flush(true);
+      }
+    }
+
+    void ClientConnector::MsgFmtHandler(LogMan::DebugLevels Level, char const *Fmt, fmt::format_args const &Args) {
+      auto &State = ThreadState;
+      if (State.InHandler) {
+        // Logging from a signal handler that interrupted a message
+        // Ring can still be null if the signal landed while it was being created
+        if (State.Ring) {
+          State.Ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+
+      State.InHandler = true;
+      GetThreadRing();
+
+      // Arguments go after the packet, which is filled in once their size is known
+      auto &Scratch = State.Scratch;
+      Scratch.resize(sizeof(Common::PacketFmtMsg));
+
+      uint32_t FmtId{};
+      if (!EncodeArgs(Scratch, Args)) {
+        // Can't defer the formatting, send it as text
+        const auto Message = fmt::vformat(Fmt, Args);
+        PushText(State, Level, Message.c_str());
+      }
+      else if (RegisterFmt(State, Fmt, &FmtId)) {
+        Common::PacketFmtMsg Msg {
+          .Header = Common::FillHeader(Common::PacketTypes::TYPE_FMT_MSG, PID, State.TID),
+          .Level = Level,
+          .FmtId = FmtId,
+          .ArgsSize = static_cast<uint32_t>(Scratch.size() - sizeof(Common::PacketFmtMsg)),
+        };
+        memcpy(&Scratch[0], &Msg, sizeof(Msg));
+
+        Push(State, Scratch.data(), Scratch.size());
+      }
+
+      State.InHandler = false;
+
+      if (Level == LogMan::DebugLevels::ASSERT) {
+        Flush(true);
+      }
+    }
+
+    void ClientConnector::WriteAll(struct iovec *Vecs, size_t Count) {
+      while (Count) {
+        ssize_t Written = ::writev(Socket, Vecs, std::min<size_t>(Count, IOV_MAX));
+        if (Written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          // Server went away, nothing more we can do with these
+          return;
+        }
+
+        // Skip past what was written, partial writes leave us in the middle of a vector
+        while (Count && static_cast<size_t>(Written) >= Vecs->iov_len) {
+          Written -= Vecs->iov_len;
+          ++Vecs;
+          --Count;
+        }
+
+        if (Count) {
+          Vecs->iov_base = reinterpret_cast<uint8_t*>(Vecs->iov_base) + Written;
+          Vecs->iov_len -= Written;
+        }
+      }
+    }
+
+    void ClientConnector::FlushLocked(bool Synchronize) {
+      {
+        std::lock_guard lk(RingsMutex);
+        FlushRings = Rings;
+      }
+
+      FlushVecs.clear();
+      FlushConsumed.clear();
+      FlushRetired.clear();
+      DroppedNotices.clear();
+
+      // Notices are built up front so the vectors pointing in to them stay valid
+      for (auto &Ring : FlushRings) {
+        if (uint64_t Dropped = Ring->Dropped.exchange(0, std::memory_order_relaxed)) {
+          const auto Notice = fmt::format("Dropped {} log messages", Dropped);
+          Common::PacketMsg Msg {
+            .Header = Common::FillHeader(Common::PacketTypes::TYPE_MSG),
+            .Level = LogMan::DebugLevels::ERROR,
+          };
+
+          const size_t Offset = DroppedNotices.size();
+          DroppedNotices.resize(Offset + sizeof(Common::PacketMsg) + Notice.size() + 1);
+          memcpy(&DroppedNotices[Offset], &Msg, sizeof(Common::PacketMsg));
+          memcpy(&DroppedNotices[Offset + offsetof(Common::PacketMsg, Msg)], Notice.c_str(), Notice.size() + 1);
+        }
+      }
+
+      if (!DroppedNotices.empty()) {
+        FlushVecs.push_back({DroppedNotices.data(), DroppedNotices.size()});
+      }
+
+      for (auto &Ring : FlushRings) {
+        // Checked before peeking, anything it wrote before exiting is visible then
+        if (Ring->Retired.load(std::memory_order_acquire)) {
+          FlushRetired.emplace_back(Ring.get());
+        }
+
+        struct iovec Vecs[2];
+        uint64_t End{};
+        const size_t Count = Ring->Peek(Vecs, &End);
+        FlushVecs.insert(FlushVecs.end(), Vecs, Vecs + Count);
+        if (Count) {
+          FlushConsumed.emplace_back(Ring.get(), End);
+        }
+      }
+
+      // Everything goes out in as few syscalls as possible
+      WriteAll(FlushVecs.data(), FlushVecs.size());
+
+      for (auto [Ring, End] : FlushConsumed) {
+        Ring->Consume(End);
+      }
+
+      if (!FlushRetired.empty()) {
+        // Drained now and their threads won't write any more
+        std::lock_guard lk(RingsMutex);
+        std::erase_if(Rings, [this](auto const &Ring) {
+          return std::find(FlushRetired.begin(), FlushRetired.end(), Ring.get()) != FlushRetired.end();
+        });
+      }
+      FlushRings.clear();
 
       if (Synchronize) {
-        auto Ack = FillHeader(Common::PacketTypes::TYPE_ACK);
-        // First write the Packet
-        Socket->write(reinterpret_cast<const char*>(&Ack), sizeof(Ack));
-        // Now flush it
-        Socket->flush();
+        auto Ack = Common::FillHeader(Common::PacketTypes::TYPE_ACK);
+        struct iovec AckVec {&Ack, sizeof(Ack)};
+        WriteAll(&AckVec, 1);
 
-        if (Socket->read(reinterpret_cast<char*>(&Ack), sizeof(Ack))) {
+        if (::read(Socket, &Ack, sizeof(Ack)) == sizeof(Ack)) {
           if (Ack.PacketType == Common::PacketTypes::TYPE_ACK) {
             // This is what was expected
           }
         }
       }
+    }
+
+    void ClientConnector::FlushBeforeExit() {
+      const int32_t TID = FHU::Syscalls::gettid();
+      if (DrainOwner.load(std::memory_order_relaxed) == TID) {
+        // We interrupted our own flush, the rings are in an unknown state
+        return;
+      }
+
+      auto &Ring = ThreadState.Ring;
+      for (int i = 0; i < EXIT_FLUSH_RETRIES; ++i) {
+        if (Draining.exchange(true, std::memory_order_acquire)) {
+          ::sched_yield();
+          continue;
+        }
+
+        DrainOwner.store(TID, std::memory_order_relaxed);
+        if (Ring) {
+          struct iovec Vecs[2];
+          uint64_t End{};
+          const size_t Count = Ring->Peek(Vecs, &End);
+          WriteAll(Vecs, Count);
+          Ring->Consume(End);
+        }
+
+        // Make sure the server has it before we go down
+        auto Ack = Common::FillHeader(Common::PacketTypes::TYPE_ACK);
+        struct iovec AckVec {&Ack, sizeof(Ack)};
+        WriteAll(&AckVec, 1);
+        [[maybe_unused]] auto Result = ::read(Socket, &Ack, sizeof(Ack));
 
-      free(MsgP);
+        ReleaseDrain();
+        return;
+      }
     }
 
-    static std::unique_ptr<ClientConnector> Client{};
+    void ClientConnector::StartFlushThread() {
+      // Not a FEXCore thread, its stack pool gets reclaimed after fork which would take this stack with it
+      uint64_t OldMask = FEXCore::Threads::SetSignalMask(~0ULL);
+      std::thread([this] { FlushThreadFunc(); }).detach();
+      FEXCore::Threads::SetSignalMask(OldMask);
+    }
+
+    void ClientConnector::FlushThreadFunc() {
+      // Runs until the process exits, the atexit handler does the final flush
+      while (true) {
+        FlushEvent.WaitFor(FLUSH_INTERVAL);
+        Flush(false);
+      }
+    }
+
+    void ClientConnector::CleanupAfterFork() {
+      // Other threads in the parent may have held these at the time of fork
+      // We are the only thread in the child so reconstruct them in place
+      new (&RingsMutex) std::mutex{};
+      new (&FlushMutex) std::mutex{};
+      Draining.store(false, std::memory_order_relaxed);
+      DrainOwner.store(0, std::memory_order_relaxed);
+      new (&FlushEvent) Event{};
+
+      PID = ::getpid();
+
+      // Anything still queued is the parent's and it flushes it itself
+      Rings.clear();
+      auto &State = ThreadState;
+      if (State.Ring) {
+        struct iovec Vecs[2];
+        uint64_t End{};
+        State.Ring->Peek(Vecs, &End);
+        State.Ring->Consume(End);
+        Rings.emplace_back(State.Ring);
+
+        // New TID, so the server hasn't seen any of our format strings
+        State.TID = FHU::Syscalls::gettid();
+        State.FmtIds.clear();
+        State.NextFmtId = 0;
+      }
+
+      StartFlushThread();
+    }
+
+    // Never freed, other threads can still be logging while the process exits
+    static ClientConnector *Client{};
 
     void MsgHandler(LogMan::DebugLevels Level, char const *Message) {
-      Client->MsgHandler(Level, Level == LogMan::DebugLevels::ASSERT, Message);
+      Client->MsgHandler(Level, Message);
+    }
+
+    void MsgFmtHandler(LogMan::DebugLevels Level, char const *Fmt, fmt::format_args const &Args) {
+      Client->MsgFmtHandler(Level, Fmt, Args);
     }
 
     void AssertHandler(char const *Message) {
       Client->AssertHandler(Message);
     }
 
+    void Flush() {
+      if (Client) {
+        Client->FlushBeforeExit();
+      }
+    }
+
+    static void FlushAtExit() {
+      Client->Flush(false);
+    }
+
+    static void CleanupAfterFork() {
+      Client->CleanupAfterFork();
+    }
+
     bool ConnectToClient(const std::string &Remote) {
       // Time to open up the actual socket and send the FD over to the daemon
       // Create the initial unix socket
@@ -150,7 +738,13 @@ namespace FEX::SocketLogging {
         return false;
       }
 
-      Client = std::make_unique<ClientConnector>(socket_fd);
+      const bool FirstConnection = Client == nullptr;
+      Client = new ClientConnector(socket_fd);
+
+      if (FirstConnection) {
+        atexit(FlushAtExit);
+        pthread_atfork(nullptr, nullptr, CleanupAfterFork);
+      }
       return true;
     }
   }
@@ -222,8 +816,7 @@ namespace FEX::SocketLogging {
                     if (Event.revents & (POLLHUP | POLLERR | POLLNVAL | POLLRDHUP)) {
                       // Error or hangup, close the socket and erase it from our list
                       Erase = true;
-                      close(Event.fd);
-                      ClosedHandler(Event.fd);
+                      CloseClient(Event.fd);
                     }
                   }
                   Event.revents = 0;
@@ -250,8 +843,7 @@ namespace FEX::SocketLogging {
 
           // Walk the socket list and close everything
           for (auto &Event : PollFDs) {
-            close(Event.fd);
-            ClosedHandler(Event.fd);
+            CloseClient(Event.fd);
           }
           PollFDs.clear();
 
@@ -303,9 +895,150 @@ namespace FEX::SocketLogging {
           });
         }
 
+        struct ClientState {
+          // Packets can be split across reads, this is whatever is left of the last one
+          std::vector<uint8_t> Data{};
+          // TID -> format string id -> format string
+          std::unordered_map<int32_t, std::unordered_map<uint32_t, std::string>> FmtStrings{};
+        };
+        std::unordered_map<int, ClientState> Clients{};
+
+        void CloseClient(int Socket) {
+          close(Socket);
+          Clients.erase(Socket);
+          ClosedHandler(Socket);
+        }
+
+        static std::string DecodeFmtMsg(std::string_view Fmt, uint8_t const *Args, size_t Size) {
+          fmt::dynamic_format_arg_store<fmt::format_context> Store;
+
+          size_t Offset{};
+          auto Read = [&](auto &Value) {
+            if (Offset + sizeof(Value) > Size) {
+              return false;
+            }
+            memcpy(&Value, &Args[Offset], sizeof(Value));
+            Offset += sizeof(Value);
+            return true;
+          };
+
+          while (Offset < Size) {
+            Common::ArgTypes Type{};
+            if (!Read(Type)) {
+              break;
+            }
+
+            bool Valid{};
+            switch (Type) {
+              case Common::ArgTypes::INT: {
+                int64_t Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(Value);
+                }
+                break;
+              }
+              case Common::ArgTypes::UINT: {
+                uint64_t Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(Value);
+                }
+                break;
+              }
+              case Common::ArgTypes::BOOL: {
+                uint8_t Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(Value != 0);
+                }
+                break;
+              }
+              case Common::ArgTypes::CHAR: {
+                char Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(Value);
+                }
+                break;
+              }
+              case Common::ArgTypes::DOUBLE: {
+                double Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(Value);
+                }
+                break;
+              }
+              case Common::ArgTypes::POINTER: {
+                uint64_t Value{};
+                if ((Valid = Read(Value))) {
+                  Store.push_back(reinterpret_cast<void const*>(Value));
+                }
+                break;
+              }
+              case Common::ArgTypes::STRING: {
+                uint32_t Length{};
+                if (Read(Length) && Offset + Length <= Size) {
+                  Store.push_back(std::string(reinterpret_cast<char const*>(&Args[Offset]), Length));
+                  Offset += Length;
+                  Valid = true;
+                }
+                break;
+              }
+            }
+
+            if (!Valid) {
+              return fmt::format("{} <malformed arguments>", Fmt);
+            }
+          }
+
+          try {
+            return fmt::vformat(Fmt, Store);
+          }
+          catch (fmt::format_error const &) {
+            return fmt::format("{} <failed to format>", Fmt);
+          }
+        }
+
+        // Returns zero if the packet isn't complete yet
+        static size_t GetPacketSize(Common::PacketHeader const &Header, uint8_t const *Packet, size_t Available) {
+          switch (Header.PacketType) {
+            case Common::PacketTypes::TYPE_MSG: {
+              if (Available <= offsetof(Common::PacketMsg, Msg)) {
+                return 0;
+              }
+              const size_t MaxLength = Available - offsetof(Common::PacketMsg, Msg);
+              const size_t Length = strnlen(reinterpret_cast<char const*>(Packet + offsetof(Common::PacketMsg, Msg)), MaxLength);
+              const size_t Size = sizeof(Common::PacketMsg) + Length + 1;
+              return Length == MaxLength || Size > Available ? 0 : Size;
+            }
+            case Common::PacketTypes::TYPE_ACK:
+              return sizeof(Common::PacketHeader);
+            case Common::PacketTypes::TYPE_FMT_STRING: {
+              Common::PacketFmtString Fmt{};
+              if (Available < sizeof(Fmt)) {
+                return 0;
+              }
+              memcpy(&Fmt, Packet, sizeof(Fmt));
+              const size_t Size = sizeof(Fmt) + Fmt.Length;
+              return Size > Available ? 0 : Size;
+            }
+            case Common::PacketTypes::TYPE_FMT_MSG: {
+              Common::PacketFmtMsg Msg{};
+              if (Available < sizeof(Msg)) {
+                return 0;
+              }
+              memcpy(&Msg, Packet, sizeof(Msg));
+              const size_t Size = sizeof(Msg) + Msg.ArgsSize;
+              return Size > Available ? 0 : Size;
+            }
+            default:
+              return ~0ULL;
+          }
+        }
+
         void HandleSocketData(int Socket) {
-          std::vector<uint8_t> Data(1500);
-          size_t CurrentRead{};
+          auto &Client = Clients[Socket];
+          auto &Data = Client.Data;
+
+          size_t CurrentRead = Data.size();
+          Data.resize(CurrentRead + 1500);
           while (true) {
             int Read = read(Socket, &Data.at(CurrentRead), Data.size() - CurrentRead);
             if (Read > 0) {
@@ -328,26 +1061,66 @@ namespace FEX::SocketLogging {
               break;
             }
           }
+          Data.resize(CurrentRead);
 
           size_t CurrentOffset{};
-          while (CurrentOffset < CurrentRead) {
-            Common::PacketHeader *Header = reinterpret_cast<Common::PacketHeader*>(&Data[CurrentOffset]);
-            if (Header->PacketType == Common::PacketTypes::TYPE_MSG) {
-              Common::PacketMsg *Msg = reinterpret_cast<Common::PacketMsg*>(&Data[CurrentOffset]);
+          while (CurrentOffset + sizeof(Common::PacketHeader) <= CurrentRead) {
+            uint8_t const *Packet = &Data[CurrentOffset];
+            Common::PacketHeader Header{};
+            memcpy(&Header, Packet, sizeof(Header));
 
-              MsgHandler(Socket, Msg->Header.Timestamp, Msg->Header.PID, Msg->Header.TID, Msg->Level, Msg->Msg);
-              CurrentOffset += sizeof(Common::PacketMsg) + strlen(Msg->Msg) + 1;
+            const size_t PacketSize = GetPacketSize(Header, Packet, CurrentRead - CurrentOffset);
+            if (PacketSize == 0) {
+              // Rest of it is still on the way
+              break;
+            }
+
+            if (Header.PacketType == Common::PacketTypes::TYPE_MSG) {
+              Common::PacketMsg Msg{};
+              memcpy(&Msg, Packet, offsetof(Common::PacketMsg, Msg));
+
+              MsgHandler(Socket, Header.Timestamp, Header.PID, Header.TID, Msg.Level, reinterpret_cast<char const*>(Packet + offsetof(Common::PacketMsg, Msg)));
             }
-            else if (Header->PacketType == Common::PacketTypes::TYPE_ACK) {
+            else if (Header.PacketType == Common::PacketTypes::TYPE_ACK) {
               // If the client sent an ACK then we want to send one right back
               auto Ack = FillHeader(Common::PacketTypes::TYPE_ACK);
               write(Socket, &Ack, sizeof(Ack));
-              CurrentOffset += sizeof(Ack);
+            }
+            else if (Header.PacketType == Common::PacketTypes::TYPE_FMT_STRING) {
+              Common::PacketFmtString Fmt{};
+              memcpy(&Fmt, Packet, sizeof(Fmt));
+
+              // Length includes the null terminator
+              std::string_view FmtString(reinterpret_cast<char const*>(Packet + sizeof(Fmt)), Fmt.Length ? Fmt.Length - 1 : 0);
+              Client.FmtStrings[Header.TID].insert_or_assign(Fmt.Id, std::string(FmtString));
+            }
+            else if (Header.PacketType == Common::PacketTypes::TYPE_FMT_MSG) {
+              Common::PacketFmtMsg Msg{};
+              memcpy(&Msg, Packet, sizeof(Msg));
+
+              std::string const *FmtString{};
+              if (auto ThreadFmts = Client.FmtStrings.find(Header.TID); ThreadFmts != Client.FmtStrings.end()) {
+                if (auto Fmt = ThreadFmts->second.find(Msg.FmtId); Fmt != ThreadFmts->second.end()) {
+                  FmtString = &Fmt->second;
+                }
+              }
+
+              const auto Decoded = FmtString ?
+                DecodeFmtMsg(*FmtString, Packet + sizeof(Msg), Msg.ArgsSize) :
+                fmt::format("<unknown format string {}>", Msg.FmtId);
+
+              MsgHandler(Socket, Header.Timestamp, Header.PID, Header.TID, Msg.Level, Decoded.c_str());
             }
             else {
+              // Lost track of the stream, nothing after this can be trusted
               CurrentOffset = CurrentRead;
+              break;
             }
+
+            CurrentOffset += PacketSize;
           }
+
+          Data.erase(Data.begin(), Data.begin() + CurrentOffset);
         }
     };
 
@@ -10,8 +10,16 @@
 namespace FEX::SocketLogging {
   // Client side
   namespace Client {
+    // Messages are queued per thread and sent in batches by a background thread, asserts are sent immediately
+    // A thread only takes a lock to log if its queue is full, it then sends the queues itself
     void MsgHandler(LogMan::DebugLevels Level, char const *Message);
+    // Sends the format string id and the arguments, formatting happens on the server
+    void MsgFmtHandler(LogMan::DebugLevels Level, char const *Fmt, fmt::format_args const &Args);
     void AssertHandler(char const *Message);
+    // Sends what the calling thread queued so far and waits for the server to have it
+    // Needed before an execve or a fatal signal, the background thread won't get another chance
+    // Safe to call from a signal handler, it gives up rather than block on a flush in progress
+    void Flush();
 
     bool ConnectToClient(const std::string &Remote);
   }
@@ -6,16 +6,22 @@ $end_info$
 */
 
 #include "Linux/Utils/ELFContainer.h"
+#include <FEXCore/Utils/Allocator.h>
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXCore/Utils/MathUtils.h>
 
 #include <algorithm>
 #include <cstring>
 #include <elf.h>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <system_error>
+#include <unistd.h>
 #include <vector>
 
 namespace ELFLoader {
@@ -146,19 +152,52 @@ ELFContainer::~ELFContainer() {
   RawFile.clear();
 }
 
-bool ELFContainer::LoadELF(std::string const &Filename) {
-  std::fstream ELFFile(Filename, std::fstream::in | std::fstream::binary);
+bool ELFContainer::MappedFile::Map(std::string const &Filename) {
+  clear();
 
-  if (!ELFFile.is_open())
+  int FD = open(Filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (FD == -1) {
     return false;
+  }
 
-  ELFFile.seekg(0, ELFFile.end);
-  size_t FileSize = ELFFile.tellg();
-  ELFFile.seekg(0, ELFFile.beg);
+  struct stat Stat{};
+  if (fstat(FD, &Stat) == -1 ||
+      Stat.st_size == 0) {
+    close(FD);
+    return false;
+  }
 
-  RawFile.resize(FileSize);
-  ELFFile.read(RawFile.data(), FileSize);
-  ELFFile.close();
+  void *Ptr = FEXCore::Allocator::mmap(nullptr, Stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, FD, 0);
+  // The mapping keeps its own reference to the file
+  close(FD);
+
+  if (Ptr == MAP_FAILED) {
+    return false;
+  }
+
+  Data = reinterpret_cast<char*>(Ptr);
+  Size = Stat.st_size;
+  return true;
+}
+
+void ELFContainer::MappedFile::clear() {
+  if (Data) {
+    FEXCore::Allocator::munmap(Data, Size);
+    Data = nullptr;
+    Size = 0;
+  }
+}
+
+char &ELFContainer::MappedFile::at(size_t Offset) const {
+  if (Offset >= Size) {
+    throw std::out_of_range("ELF offset out of range");
+  }
+  return Data[Offset];
+}
+
+bool ELFContainer::LoadELF(std::string const &Filename) {
+  if (!RawFile.Map(Filename))
+    return false;
 
   InterpreterHeader._64 = nullptr;
 
@@ -321,6 +360,32 @@ ELFSymbol const *ELFContainer::GetSymbolInRange(RangeType Address) {
   return Sym->second;
 }
 
+bool ELFContainer::FileOffsetToAddress(uint64_t Offset, uint64_t *Address) const {
+  for (auto const &Header : ProgramHeaders) {
+    uint32_t Type;
+    uint64_t FileOffset, VirtualAddress, FileSize;
+    if (Mode == MODE_32BIT) {
+      Type = Header._32->p_type;
+      FileOffset = Header._32->p_offset;
+      VirtualAddress = Header._32->p_vaddr;
+      FileSize = Header._32->p_filesz;
+    }
+    else {
+      Type = Header._64->p_type;
+      FileOffset = Header._64->p_offset;
+      VirtualAddress = Header._64->p_vaddr;
+      FileSize = Header._64->p_filesz;
+    }
+
+    if (Type == PT_LOAD && Offset >= FileOffset && Offset < FileOffset + FileSize) {
+      *Address = VirtualAddress + (Offset - FileOffset);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void ELFContainer::CalculateMemoryLayouts() {
   uint64_t MinPhysAddr = ~0ULL;
   uint64_t MaxPhysAddr = 0;
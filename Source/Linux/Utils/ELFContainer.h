@@ -71,6 +71,13 @@ public:
   using RangeType = std::pair<uint64_t, uint64_t>;
   ELFSymbol const *GetSymbolInRange(RangeType Address);
 
+  /**
+   * @brief Translates an offset in the file to the address it is loaded at, without any load bias
+   *
+   * @return false if no loadable segment covers the offset
+   */
+  bool FileOffsetToAddress(uint64_t Offset, uint64_t *Address) const;
+
   bool WasDynamic() const { return DynamicProgram; }
   bool HasDynamicLinker() const { return !DynamicLinker.empty(); }
   bool WasLoaded() const { return Loaded; }
@@ -138,7 +145,33 @@ private:
   void PrintInitArray() const;
   void PrintDynamicTable() const;
 
-  std::vector<char> RawFile;
+  /**
+   * @brief Private mapping of the ELF file
+   *
+   * Only the pages holding the headers and tables that get parsed are faulted in,
+   * and those come straight from the page cache instead of a copy of the whole file.
+   * Writable so existing users of the raw pointers keep working, writes are copy on write.
+   */
+  class MappedFile {
+  public:
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile() { clear(); }
+
+    bool Map(std::string const &Filename);
+    void clear();
+
+    // Bounds checked like std::vector::at
+    char &at(size_t Offset) const;
+    size_t size() const { return Size; }
+
+  private:
+    char *Data{};
+    size_t Size{};
+  };
+
+  MappedFile RawFile;
   union {
     Elf32_Ehdr _32;
     Elf64_Ehdr _64;
@@ -64,7 +64,7 @@ class ELFCodeLoader2 final : public FEXCore::CodeLoader {
   }
 
   template<typename T>
-  bool MapFile(const ELFParser& file, uintptr_t Base, const Elf64_Phdr &Header, int prot, int flags, T Mapper) {
+  bool MapFile(const ELFParser& file, std::string const &Filename, uintptr_t Base, const Elf64_Phdr &Header, int prot, int flags, T Mapper) {
 
     auto addr = Base + PAGE_START(Header.p_vaddr);
     auto size = Header.p_filesz + PAGE_OFFSET(Header.p_vaddr);
@@ -84,8 +84,7 @@ class ELFCodeLoader2 final : public FEXCore::CodeLoader {
       LogMan::Msg::EFmt("MapFile: Some elf mapping failed, {}, fd: {}\n", errno, file.fd);
       return false;
     } else {
-      auto Filename = get_fdpath(file.fd);
-      Sections.push_back({Base, (uintptr_t)rv, size, (off_t)off, Filename, (prot & PROT_EXEC) != 0});
+      Sections.push_back({Base, (uintptr_t)rv, size, (off_t)off, Filename, (prot & PROT_EXEC) != 0, prot});
 
       return true;
     }
@@ -132,6 +131,9 @@ class ELFCodeLoader2 final : public FEXCore::CodeLoader {
       }
     }
 
+    // Segments are mapped straight from the file, resolve its name once rather than per segment
+    auto Filename = get_fdpath(Elf.fd);
+
     for(const auto &Header: Elf.phdrs) {
       if (Header.p_type != PT_LOAD)
         continue;
@@ -139,7 +141,7 @@ class ELFCodeLoader2 final : public FEXCore::CodeLoader {
 			int MapProt = MapFlags(Header);
       int MapType = MAP_PRIVATE | MAP_DENYWRITE | MAP_FIXED_NOREPLACE;
 
-			if (!MapFile(Elf, LoadBase, Header, MapProt, MapType, Mapper)) {
+			if (!MapFile(Elf, Filename, LoadBase, Header, MapProt, MapType, Mapper)) {
         return {};
       }
 
@@ -210,6 +212,7 @@ class ELFCodeLoader2 final : public FEXCore::CodeLoader {
     off_t Offs;
     std::string Filename;
     bool Executable;
+    int Prot;
   };
 
   std::vector<LoadedSection> Sections;
@@ -7,6 +7,8 @@ $end_info$
 
 #include "AOT/AOTGenerator.h"
 #include "Common/ArgumentLoader.h"
+#include "Common/Config.h"
+#include "Common/ExecServer.h"
 #include "Common/RootFSSetup.h"
 #include "Common/SocketLogging.h"
 #include "ELFCodeLoader2.h"
@@ -37,6 +39,7 @@ $end_info$
 #include <filesystem>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <set>
 #include <sstream>
@@ -47,6 +50,7 @@ $end_info$
 #include <system_error>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -149,6 +153,31 @@ void PrintIntersectingMapping() {
   }
 }
 
+// Set up by the exec server for the programs it starts
+FEXCore::Allocator::PtrCache *ExecServerBase48Bit{};
+
+// Everything done here is shared by every program the server starts
+std::optional<FEX::ExecServer::Server::Request> RunExecServer() {
+  FEXCore::Config::Initialize();
+  FEXCore::Config::AddLayer(FEXCore::Config::CreateMainLayer());
+  FEXCore::Config::AddLayer(FEXCore::Config::CreateEnvironmentLayer(environ));
+  FEXCore::Config::Load();
+
+  // The server holds on to a squashfs rootfs so it stays mounted between programs
+  if (!FEX::RootFS::Setup(environ)) {
+    return std::nullopt;
+  }
+  FEX::RootFS::Shutdown();
+
+  // Programs load their own config, the application layers depend on them
+  FEXCore::Config::Shutdown();
+
+  // Most programs are 64-bit, the 32-bit ones hand this back
+  ExecServerBase48Bit = FEXCore::Allocator::Steal48BitVA();
+
+  return FEX::ExecServer::Server::Run();
+}
+
 } // Anonymous namespace
 
 void InterpreterHandler(std::string *Filename, std::string const &RootFS, std::vector<std::string> *args) {
@@ -226,7 +255,38 @@ bool IsInterpreterInstalled() {
          std::filesystem::exists("/proc/sys/fs/binfmt_misc/FEX-x86_64", ec));
 }
 
-int main(int argc, char **argv, char **const envp) {
+int main(int argc, char **argv, char **envp) {
+  // Keeps the arguments of a program started by the exec server alive
+  static std::optional<FEX::ExecServer::Server::Request> ExecServerProgram;
+  static std::vector<char*> ExecServerArgv;
+  static std::vector<char*> ExecServerEnvp;
+
+  if (argc == 2 && strcmp(argv[1], "--exec-server") == 0) {
+    ExecServerProgram = RunExecServer();
+    if (!ExecServerProgram) {
+      return 0;
+    }
+
+    // From here on this is a freshly started program
+    for (auto &Arg : ExecServerProgram->Args) {
+      ExecServerArgv.emplace_back(Arg.data());
+    }
+    ExecServerArgv.emplace_back(nullptr);
+
+    for (auto &Env : ExecServerProgram->Environment) {
+      ExecServerEnvp.emplace_back(Env.data());
+    }
+    ExecServerEnvp.emplace_back(nullptr);
+
+    argc = ExecServerProgram->Args.size();
+    argv = ExecServerArgv.data();
+    envp = ExecServerEnvp.data();
+    environ = envp;
+  }
+
+  // A FEX parent hands down the config files it already parsed
+  FEX::Config::ConsumeConfigSnapshot(envp);
+
   const bool IsInterpreter = RanAsInterpreter(argv[0]);
 
   ExecutedWithFD = getauxval(AT_EXECFD) != 0;
@@ -301,7 +361,7 @@ int main(int argc, char **argv, char **const envp) {
 
       if (FEX::SocketLogging::Client::ConnectToClient(OutputSocket())) {
         LogMan::Throw::InstallHandler(FEX::SocketLogging::Client::AssertHandler);
-        LogMan::Msg::InstallHandler(FEX::SocketLogging::Client::MsgHandler);
+        LogMan::Msg::InstallFmtHandler(FEX::SocketLogging::Client::MsgFmtHandler);
       }
     }
     else {
@@ -378,7 +438,8 @@ int main(int argc, char **argv, char **const envp) {
 
   if (Loader.Is64BitMode()) {
     // Destroy the 48th bit if it exists
-    Base48Bit = FEXCore::Allocator::Steal48BitVA();
+    // The exec server has already done this for the programs it starts
+    Base48Bit = ExecServerBase48Bit ? ExecServerBase48Bit : FEXCore::Allocator::Steal48BitVA();
     if (!Loader.MapMemory([](void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
       return FEXCore::Allocator::mmap(addr, length, prot, flags, fd, offset);
     }, [](void *addr, size_t length) {
@@ -389,6 +450,9 @@ int main(int argc, char **argv, char **const envp) {
       return -ENOEXEC;
     }
   } else {
+    // Needs to go before the allocator hooks are set up
+    FEXCore::Allocator::ReclaimMemoryRegion(ExecServerBase48Bit);
+
     FEX_CONFIG_OPT(Use32BitAllocator, FORCE32BITALLOCATOR);
     if (KernelVersion < FEX::HLE::SyscallHandler::KernelVersion(4, 17)) {
       Use32BitAllocator = true;
@@ -501,8 +565,35 @@ int main(int argc, char **argv, char **const envp) {
     std::filesystem::rename(TmpFilepath, NewFilepath);
   });
 
+  // Only called while writing the sample profile at exit, each file gets parsed once
+  FEXCore::Context::SetGuestSymbolizer(CTX, [Files = std::make_shared<std::unordered_map<std::string, std::unique_ptr<ELFLoader::ELFContainer>>>()]
+    (const std::string& Filename, uint64_t FileOffset) -> std::string {
+    auto it = Files->find(Filename);
+    if (it == Files->end()) {
+      std::unique_ptr<ELFLoader::ELFContainer> File;
+      if (ELFLoader::ELFContainer::IsSupportedELF(Filename)) {
+        File = std::make_unique<ELFLoader::ELFContainer>(Filename, std::string{}, true);
+      }
+      it = Files->emplace(Filename, std::move(File)).first;
+    }
+
+    uint64_t Address{};
+    if (!it->second || !it->second->FileOffsetToAddress(FileOffset, &Address)) {
+      return {};
+    }
+
+    auto Symbol = it->second->GetSymbolInRange({Address, 1});
+    if (!Symbol) {
+      return {};
+    }
+
+    return Symbol->Name;
+  });
+
   for(const auto &Section: Loader.Sections) {
     FEXCore::Context::AddNamedRegion(CTX, Section.Base, Section.Size, Section.Offs, Section.Filename);
+    // Segments are private file mappings, RELRO and .rodata in the executable and interpreter can get folded
+    FEXCore::Context::AddGuestMapping(CTX, Section.Base, Section.Size, true, Section.Prot);
   }
 
   if (AOTIRGenerate()) {
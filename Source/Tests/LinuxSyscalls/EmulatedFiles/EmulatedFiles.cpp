@@ -16,12 +16,16 @@ $end_info$
 
 #include <git_version.h>
 
+#include <algorithm>
 #include <cstring>
+#include <errno.h>
 #include <fcntl.h>
 #include <filesystem>
 #include <ostream>
 #include <sstream>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <system_error>
 #include <unistd.h>
 #include <utility>
@@ -49,6 +53,13 @@ namespace FEX::EmulatedFile {
     return fd;
   }
 
+  static int GenTmpFD(std::string const &Contents) {
+    int FD = GenTmpFD();
+    write(FD, Contents.data(), Contents.size());
+    lseek(FD, 0, SEEK_SET);
+    return FD;
+  }
+
   std::string GenerateCPUInfo(FEXCore::Context::Context *ctx, uint32_t CPUCores) {
     std::ostringstream cpu_stream{};
     auto res_0 = FEXCore::Context::RunCPUIDFunction(ctx, 0, 0);
@@ -618,17 +629,120 @@ namespace FEX::EmulatedFile {
     return cpu_stream.str();
   }
 
+  SealedFile::SealedFile(GenerateFunc Generate)
+    : Generate {std::move(Generate)} {
+  }
+
+  SealedFile::~SealedFile() {
+    if (FD != -1) {
+      close(FD);
+    }
+  }
+
+  bool SealedFile::Create(std::string const &Contents) {
+    int NewFD = ::memfd_create("FEXEmulatedFile", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (NewFD == -1) {
+      return false;
+    }
+
+    size_t Written{};
+    while (Written < Contents.size()) {
+      ssize_t Result = write(NewFD, Contents.data() + Written, Contents.size() - Written);
+      if (Result == -1 && errno == EINTR) {
+        continue;
+      }
+      if (Result <= 0) {
+        close(NewFD);
+        return false;
+      }
+      Written += Result;
+    }
+
+    struct stat Stat{};
+    if (fcntl(NewFD, F_ADD_SEALS, F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE) == -1 ||
+        fstat(NewFD, &Stat) == -1) {
+      close(NewFD);
+      return false;
+    }
+
+    FD = NewFD;
+    Dev = Stat.st_dev;
+    Inode = Stat.st_ino;
+    return true;
+  }
+
+  int32_t SealedFile::Reopen(int32_t flags) {
+    // dup would share the file offset between every guest FD, go through procfs for a new file description
+    char Path[32];
+    snprintf(Path, sizeof(Path), "/proc/self/fd/%d", FD);
+    int NewFD = open(Path, O_RDONLY | (flags & O_CLOEXEC));
+    if (NewFD == -1) {
+      return -1;
+    }
+
+    // The guest is free to close our FD and reuse the number
+    // Make sure we didn't just open something that belongs to it
+    struct stat Stat{};
+    if (fstat(NewFD, &Stat) == -1 ||
+        Stat.st_dev != Dev ||
+        Stat.st_ino != Inode) {
+      close(NewFD);
+      return -1;
+    }
+
+    return NewFD;
+  }
+
+  int32_t SealedFile::Open(int32_t flags) {
+    std::unique_lock lk(Lock, std::try_to_lock);
+
+    if (lk.owns_lock()) {
+      if (FD != -1) {
+        int NewFD = Reopen(flags);
+        if (NewFD != -1) {
+          return NewFD;
+        }
+
+        // Lost our FD, the number may belong to the guest now so don't close it
+        FD = -1;
+      }
+
+      auto Contents = Generate();
+      if (!Contents) {
+        return -1;
+      }
+
+      if (Create(*Contents)) {
+        int NewFD = Reopen(flags);
+        if (NewFD != -1) {
+          return NewFD;
+        }
+      }
+
+      return GenTmpFD(*Contents);
+    }
+
+    auto Contents = Generate();
+    if (!Contents) {
+      return -1;
+    }
+    return GenTmpFD(*Contents);
+  }
+
+  EmulatedFDManager::FDReadStringFunc EmulatedFDManager::AddSealedFile(SealedFile::GenerateFunc Generate) {
+    auto File = SealedFiles.emplace_back(std::make_unique<SealedFile>(std::move(Generate))).get();
+    return [File](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
+      return File->Open(flags);
+    };
+  }
+
   EmulatedFDManager::EmulatedFDManager(FEXCore::Context::Context *ctx)
     : CTX {ctx} {
-    FDReadCreators["/proc/cpuinfo"] = [&](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
-      int FD = GenTmpFD();
-      write(FD, (void*)&cpu_info.at(0), cpu_info.size());
-      lseek(FD, 0, SEEK_SET);
-      return FD;
-    };
+    FDReadCreators["/proc/cpuinfo"] = AddSealedFile([this]() -> std::optional<std::string> {
+      return cpu_info;
+    });
 
-    FDReadCreators["/proc/sys/kernel/osrelease"] = [&](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
-      int FD = GenTmpFD();
+    FDReadCreators["/proc/sys/kernel/osrelease"] = AddSealedFile([]() -> std::optional<std::string> {
       uint32_t GuestVersion = FEX::HLE::_SyscallHandler->GetGuestKernelVersion();
       char Tmp[64]{};
       snprintf(Tmp, sizeof(Tmp), "%d.%d.%d\n",
@@ -636,13 +750,10 @@ namespace FEX::EmulatedFile {
         FEX::HLE::SyscallHandler::KernelMinor(GuestVersion),
         FEX::HLE::SyscallHandler::KernelPatch(GuestVersion));
       // + 1 to ensure null at the end
-      write(FD, Tmp, strlen(Tmp) + 1);
-      lseek(FD, 0, SEEK_SET);
-      return FD;
-    };
+      return std::string(Tmp, strlen(Tmp) + 1);
+    });
 
-    FDReadCreators["/proc/version"] = [&](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
-      int FD = GenTmpFD();
+    FDReadCreators["/proc/version"] = AddSealedFile([]() -> std::optional<std::string> {
       // UTS version NEEDS to be in a format that can pass to `date -d`
       // Format of this is Linux version <Release> (<Compile By>@<Compile Host>) (<Linux Compiler>) #<version> {SMP, PREEMPT, PREEMPT_RT} <UTS version>\n"
       const char kernel_version[] = "Linux version %d.%d.%d (FEX@FEX) (clang) #" GIT_DESCRIBE_STRING " SMP " __DATE__ " " __TIME__ "\n";
@@ -653,47 +764,42 @@ namespace FEX::EmulatedFile {
         FEX::HLE::SyscallHandler::KernelMinor(GuestVersion),
         FEX::HLE::SyscallHandler::KernelPatch(GuestVersion));
       // + 1 to ensure null at the end
-      write(FD, Tmp, strlen(Tmp) + 1);
-      lseek(FD, 0, SEEK_SET);
-      return FD;
-    };
+      return std::string(Tmp, strlen(Tmp) + 1);
+    });
 
-    auto NumCPUCores = [&](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
-      int FD = GenTmpFD();
-      write(FD, (void*)&cpus_online.at(0), cpus_online.size());
-      lseek(FD, 0, SEEK_SET);
-      return FD;
-    };
+    auto NumCPUCores = AddSealedFile([this]() -> std::optional<std::string> {
+      return cpus_online;
+    });
 
     FDReadCreators["/sys/devices/system/cpu/online"] = NumCPUCores;
     FDReadCreators["/sys/devices/system/cpu/present"] = NumCPUCores;
 
     string procAuxv = string("/proc/") + std::to_string(getpid()) + string("/auxv");
 
-    FDReadCreators[procAuxv] = &EmulatedFDManager::ProcAuxv;
-    FDReadCreators["/proc/self/auxv"] = &EmulatedFDManager::ProcAuxv;
+    auto auxv_handler = AddSealedFile(&EmulatedFDManager::ProcAuxv);
+    FDReadCreators[procAuxv] = auxv_handler;
+    FDReadCreators["/proc/self/auxv"] = auxv_handler;
 
-    auto cmdline_handler = [&](FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode) -> int32_t {
-      int FD = GenTmpFD();
+    auto cmdline_handler = AddSealedFile([]() -> std::optional<std::string> {
       auto CodeLoader = FEX::HLE::_SyscallHandler->GetCodeLoader();
       auto Args = CodeLoader->GetApplicationArguments();
-      char NullChar{};
+      std::string Contents{};
       // cmdline is an array of null terminated arguments
       for (size_t i = 0; i < Args->size(); ++i) {
         auto &Arg = Args->at(i);
-        write(FD, Arg.c_str(), Arg.size());
+        Contents.append(Arg.c_str(), Arg.size());
         // Finish off with a null terminator
-        write(FD, &NullChar, sizeof(uint8_t));
+        Contents.push_back('\0');
       }
 
-      // One additional null terminator to finish the list
-      lseek(FD, 0, SEEK_SET);
-      return FD;
-    };
+      return Contents;
+    });
 
     FDReadCreators["/proc/self/cmdline"] = cmdline_handler;
     FDReadCreators["/proc/" + std::to_string(::getpid()) + "/cmdline"] = cmdline_handler;
 
+    BuildBasenameFilter();
+
     cpus_online = "0";
     uint64_t CPUCores = ThreadsConfig();
     if (CPUCores > 1) {
@@ -706,7 +812,54 @@ namespace FEX::EmulatedFile {
   EmulatedFDManager::~EmulatedFDManager() {
   }
 
+  void EmulatedFDManager::BuildBasenameFilter() {
+    for (auto &[Path, Creator] : FDReadCreators) {
+      auto Basename = std::string_view(Path).substr(Path.find_last_of('/') + 1);
+      if (Basename.size() < 64) {
+        BasenameLengths |= 1ULL << Basename.size();
+      }
+
+      if (std::find(Basenames.begin(), Basenames.end(), Basename) == Basenames.end()) {
+        Basenames.emplace_back(Basename);
+      }
+    }
+  }
+
+  bool EmulatedFDManager::MightBeEmulated(std::string_view Basename) const {
+    if (Basename.empty() || Basename == "." || Basename == "..") {
+      // Need the filesystem to know what this refers to
+      return true;
+    }
+
+    if (Basename.size() >= 64 || !(BasenameLengths & (1ULL << Basename.size()))) {
+      return false;
+    }
+
+    return std::find(Basenames.begin(), Basenames.end(), Basename) != Basenames.end();
+  }
+
   int32_t EmulatedFDManager::OpenAt(int dirfs, const char *pathname, int flags, uint32_t mode) {
+    if (pathname) {
+      // Absolute paths that exactly match don't need any canonicalization
+      if (pathname[0] == '/') {
+        auto Creator = FDReadCreators.find(pathname);
+        if (Creator != FDReadCreators.end()) {
+          return Creator->second(CTX, dirfs, pathname, flags, mode);
+        }
+      }
+
+      // Anything that doesn't end in an emulated file name can be rejected without touching the filesystem.
+      // This doesn't catch symlinks with a different name pointing at an emulated file, those see the host file.
+      std::string_view Path {pathname};
+      while (Path.size() > 1 && Path.back() == '/') {
+        Path.remove_suffix(1);
+      }
+
+      if (!MightBeEmulated(Path.substr(Path.find_last_of('/') + 1))) {
+        return -1;
+      }
+    }
+
     std::string Path{};
     if (((pathname && pathname[0] != '/') || // If pathname exists then it must not be absolute
         !pathname) &&
@@ -755,19 +908,14 @@ namespace FEX::EmulatedFile {
     return Creator->second(CTX, dirfs, Path.c_str(), flags, mode);
   }
 
-  int32_t EmulatedFDManager::ProcAuxv(FEXCore::Context::Context* ctx, int32_t fd, const char* pathname, int32_t flags, mode_t mode)
-  {
+  std::optional<std::string> EmulatedFDManager::ProcAuxv() {
     uint64_t auxvBase=0, auxvSize=0;
     FEX::HLE::_SyscallHandler->GetCodeLoader()->GetAuxv(auxvBase, auxvSize);
     if (!auxvBase) {
       LogMan::Msg::DFmt("Failed to get Auxv stack address");
-      return -1;
+      return std::nullopt;
     }
 
-    int FD = GenTmpFD();
-    write(FD, (void*)auxvBase, auxvSize);
-    lseek(FD, 0, SEEK_SET);
-    return FD;
+    return std::string(reinterpret_cast<const char*>(auxvBase), auxvSize);
   }
 }
-
@@ -9,15 +9,48 @@ $end_info$
 
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <sys/types.h>
+#include <vector>
 
 namespace FEXCore::Context {
   struct Context;
 }
 
 namespace FEX::EmulatedFile {
+  /**
+   * @brief Emulated file contents that never change over the lifetime of the process
+   *
+   * Contents are generated on first open and kept in a sealed memfd.
+   * Each guest open reopens it through /proc/self/fd so every FD gets its own file offset.
+   */
+  class SealedFile final {
+    public:
+      using GenerateFunc = std::function<std::optional<std::string>()>;
+
+      SealedFile(GenerateFunc Generate);
+      ~SealedFile();
+
+      int32_t Open(int32_t flags);
+
+    private:
+      GenerateFunc Generate;
+
+      // try_lock only, a reentrant open from a signal handler takes the temporary file path
+      std::mutex Lock;
+      int32_t FD {-1};
+      dev_t Dev{};
+      ino_t Inode{};
+
+      bool Create(std::string const &Contents);
+      int32_t Reopen(int32_t flags);
+  };
+
   class EmulatedFDManager {
     public:
       EmulatedFDManager(FEXCore::Context::Context *ctx);
@@ -31,7 +64,23 @@ namespace FEX::EmulatedFile {
       using FDReadStringFunc = std::function<int32_t(FEXCore::Context::Context *ctx, int32_t fd, const char *pathname, int32_t flags, mode_t mode)>;
       std::unordered_map<std::string, FDReadStringFunc> FDReadCreators;
 
-      static int32_t ProcAuxv(FEXCore::Context::Context* ctx, int32_t fd, const char* pathname, int32_t flags, mode_t mode);
+      // Stable storage for the sealed files that FDReadCreators refer to
+      std::vector<std::unique_ptr<SealedFile>> SealedFiles;
+      FDReadStringFunc AddSealedFile(SealedFile::GenerateFunc Generate);
+
+      /**
+       * @name Syscall free rejection of paths that can't be emulated
+       *
+       * Every FDReadCreators path ends in one of a handful of file names.
+       * Bit N of BasenameLengths is set if any of those names are N characters long.
+       * @{ */
+      uint64_t BasenameLengths{};
+      std::vector<std::string> Basenames{};
+      void BuildBasenameFilter();
+      bool MightBeEmulated(std::string_view Basename) const;
+      /**  @} */
+
+      static std::optional<std::string> ProcAuxv();
       FEX_CONFIG_OPT(ThreadsConfig, THREADS);
   };
 }
@@ -0,0 +1,247 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Lock-free tracking of the path each guest FD was opened with
+$end_info$
+*/
+
+#include "Tests/LinuxSyscalls/FDNameTable.h"
+
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+namespace FEX::HLE {
+  // Past this the table would be mostly wasted VA, the kernel's nr_open ceiling is below this anyway
+  constexpr static size_t MAX_TRACKED_FDS = 1ULL << 30;
+
+  template<typename T>
+  static T *AllocateZeroed(size_t Size) {
+    void *Ptr = FEXCore::Allocator::mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (Ptr == MAP_FAILED) {
+      return nullptr;
+    }
+    return reinterpret_cast<T*>(Ptr);
+  }
+
+  FDNameTable::FDNameTable() {
+    // Size by the hard limit since the guest can raise the soft limit at any time
+    struct rlimit Limit{};
+    size_t MaxFDs = MAX_TRACKED_FDS;
+    if (getrlimit(RLIMIT_NOFILE, &Limit) == 0 && Limit.rlim_max != RLIM_INFINITY) {
+      MaxFDs = std::min<size_t>(MaxFDs, Limit.rlim_max);
+    }
+
+    NumChunks = (MaxFDs + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    Chunks = AllocateZeroed<std::atomic<Chunk*>>(NumChunks * sizeof(std::atomic<Chunk*>));
+    if (!Chunks) {
+      NumChunks = 0;
+    }
+
+    InternedNames = AllocateInternTable(INTERN_INITIAL_SIZE);
+  }
+
+  FDNameTable::~FDNameTable() {
+    for (size_t i = 0; i < NumChunks; ++i) {
+      if (auto Chunk = Chunks[i].load()) {
+        FEXCore::Allocator::munmap(Chunk, sizeof(*Chunk));
+      }
+    }
+
+    if (Chunks) {
+      FEXCore::Allocator::munmap(Chunks, NumChunks * sizeof(std::atomic<Chunk*>));
+    }
+
+    for (auto Table = InternedNames; Table != nullptr; ) {
+      auto Next = Table->Next.load();
+      auto Slots = Table->Slots();
+      for (size_t i = 0; i < Table->Size; ++i) {
+        delete[] Slots[i].load();
+      }
+      FEXCore::Allocator::munmap(Table, sizeof(InternTable) + Table->Size * sizeof(std::atomic<char const*>));
+      Table = Next;
+    }
+  }
+
+  std::atomic<char const*> *FDNameTable::GetSlot(int fd, bool Allocate) const {
+    if (fd < 0) {
+      return nullptr;
+    }
+
+    size_t ChunkIndex = static_cast<size_t>(fd) / CHUNK_SIZE;
+    if (ChunkIndex >= NumChunks) {
+      return nullptr;
+    }
+
+    auto Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire);
+    if (!Chunk) {
+      if (!Allocate) {
+        return nullptr;
+      }
+
+      auto NewChunk = AllocateZeroed<FDNameTable::Chunk>(sizeof(FDNameTable::Chunk));
+      if (!NewChunk) {
+        return nullptr;
+      }
+
+      if (Chunks[ChunkIndex].compare_exchange_strong(Chunk, NewChunk, std::memory_order_acq_rel)) {
+        Chunk = NewChunk;
+      }
+      else {
+        // Another thread beat us to it, Chunk now holds theirs
+        FEXCore::Allocator::munmap(NewChunk, sizeof(FDNameTable::Chunk));
+      }
+    }
+
+    return &(*Chunk)[static_cast<size_t>(fd) % CHUNK_SIZE];
+  }
+
+  FDNameTable::InternTable *FDNameTable::AllocateInternTable(size_t Size) {
+    auto Table = AllocateZeroed<InternTable>(sizeof(InternTable) + Size * sizeof(std::atomic<char const*>));
+    if (Table) {
+      Table->Size = Size;
+    }
+    return Table;
+  }
+
+  char const *FDNameTable::Intern(std::string_view Name) {
+    auto Matches = [&Name](char const *Existing) {
+      return strncmp(Existing, Name.data(), Name.size()) == 0 && Existing[Name.size()] == '\0';
+    };
+
+    size_t Hash = std::hash<std::string_view>{}(Name);
+    char *NewName{};
+
+    for (auto Table = InternedNames; Table != nullptr; ) {
+      auto Slots = Table->Slots();
+      for (size_t Probe = 0; Probe < INTERN_MAX_PROBE; ++Probe) {
+        auto &Slot = Slots[(Hash + Probe) & (Table->Size - 1)];
+        char const *Existing = Slot.load(std::memory_order_acquire);
+
+        if (!Existing) {
+          if (!NewName) {
+            NewName = AllocateName(Name);
+            if (!NewName) {
+              return nullptr;
+            }
+          }
+
+          if (Slot.compare_exchange_strong(Existing, NewName, std::memory_order_acq_rel)) {
+            return NewName;
+          }
+          // Lost the race, Existing is now whatever got inserted
+        }
+
+        if (Matches(Existing)) {
+          FreeName(NewName, Name.size());
+          return Existing;
+        }
+      }
+
+      // Too many collisions in this table, move on to the next larger one
+      auto Next = Table->Next.load(std::memory_order_acquire);
+      if (!Next) {
+        if (Table->Size >= INTERN_MAX_SIZE) {
+          break;
+        }
+
+        auto NewTable = AllocateInternTable(Table->Size * 2);
+        if (!NewTable) {
+          break;
+        }
+
+        if (Table->Next.compare_exchange_strong(Next, NewTable, std::memory_order_acq_rel)) {
+          Next = NewTable;
+        }
+        else {
+          FEXCore::Allocator::munmap(NewTable, sizeof(InternTable) + NewTable->Size * sizeof(std::atomic<char const*>));
+        }
+      }
+      Table = Next;
+    }
+
+    FreeName(NewName, Name.size());
+    return nullptr;
+  }
+
+  char *FDNameTable::AllocateName(std::string_view Name) {
+    const size_t Size = Name.size() + 1;
+    if (InternedBytes.fetch_add(Size, std::memory_order_relaxed) + Size > INTERN_MAX_BYTES) {
+      InternedBytes.fetch_sub(Size, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    auto NewName = new (std::nothrow) char[Size];
+    if (!NewName) {
+      InternedBytes.fetch_sub(Size, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    memcpy(NewName, Name.data(), Name.size());
+    NewName[Name.size()] = '\0';
+    return NewName;
+  }
+
+  void FDNameTable::FreeName(char *Name, size_t Length) {
+    if (Name) {
+      delete[] Name;
+      InternedBytes.fetch_sub(Length + 1, std::memory_order_relaxed);
+    }
+  }
+
+  void FDNameTable::Set(int fd, std::string_view Name) {
+    auto Slot = GetSlot(fd, true);
+    if (!Slot) {
+      return;
+    }
+
+    char const *Interned = Intern(Name);
+    if (!Interned && !InternFullLogged.exchange(true, std::memory_order_relaxed)) {
+      LogMan::Msg::IFmt("FD name table is full, newly opened paths won't be tracked");
+    }
+
+    // Still stored when it failed, the FD must not keep the name of whatever it was before
+    Slot->store(Interned, std::memory_order_release);
+  }
+
+  void FDNameTable::Erase(int fd) {
+    if (auto Slot = GetSlot(fd, false)) {
+      Slot->store(nullptr, std::memory_order_release);
+    }
+  }
+
+  void FDNameTable::EraseRange(uint32_t First, uint32_t Last) {
+    if (NumChunks == 0) {
+      return;
+    }
+
+    size_t End = std::min<size_t>(Last, NumChunks * CHUNK_SIZE - 1);
+    for (size_t fd = First; fd <= End; ) {
+      size_t ChunkIndex = fd / CHUNK_SIZE;
+      size_t ChunkEnd = std::min(End, (ChunkIndex + 1) * CHUNK_SIZE - 1);
+
+      // Chunks that were never allocated have nothing to clear
+      if (auto Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire)) {
+        for (size_t i = fd; i <= ChunkEnd; ++i) {
+          (*Chunk)[i % CHUNK_SIZE].store(nullptr, std::memory_order_release);
+        }
+      }
+
+      fd = ChunkEnd + 1;
+    }
+  }
+
+  char const *FDNameTable::Find(int fd) const {
+    auto Slot = GetSlot(fd, false);
+    if (!Slot) {
+      return nullptr;
+    }
+    return Slot->load(std::memory_order_acquire);
+  }
+}
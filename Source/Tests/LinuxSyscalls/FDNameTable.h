@@ -0,0 +1,79 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Lock-free tracking of the path each guest FD was opened with
+$end_info$
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace FEX::HLE {
+  /**
+   * @brief FD indexed table of the path each FD was opened with
+   *
+   * Slots are atomics so open and close from any guest thread never take a lock, which also means
+   * no signal masking is needed around them.
+   *
+   * Names are interned and never freed, so a pointer returned from `Find` stays valid forever
+   * even if the FD is closed or reused concurrently.
+   * The intern table is bounded, once it is full FDs opened with a new name have none.
+   */
+  class FDNameTable final {
+  public:
+    FDNameTable();
+    ~FDNameTable();
+
+    FDNameTable(FDNameTable const&) = delete;
+    FDNameTable& operator=(FDNameTable const&) = delete;
+
+    void Set(int fd, std::string_view Name);
+    void Erase(int fd);
+    // Inclusive range
+    void EraseRange(uint32_t First, uint32_t Last);
+
+    char const *Find(int fd) const;
+
+  private:
+    constexpr static size_t CHUNK_SIZE = 1024;
+    using Chunk = std::array<std::atomic<char const*>, CHUNK_SIZE>;
+
+    // Allocated on first use of any FD in the chunk
+    std::atomic<Chunk*> *Chunks{};
+    size_t NumChunks{};
+
+    std::atomic<char const*> *GetSlot(int fd, bool Allocate) const;
+
+    // Intern table is a chain of open addressed tables, each twice the size of the previous
+    constexpr static size_t INTERN_INITIAL_SIZE = 4096;
+    constexpr static size_t INTERN_MAX_PROBE = 16;
+    // Names are never freed, so stop interning new ones past this
+    constexpr static size_t INTERN_MAX_BYTES = 64 * 1024 * 1024;
+    constexpr static size_t INTERN_MAX_SIZE = INTERN_INITIAL_SIZE << 10;
+
+    struct InternTable {
+      size_t Size;
+      std::atomic<InternTable*> Next;
+      // Followed by Size slots
+      std::atomic<char const*> *Slots() {
+        return reinterpret_cast<std::atomic<char const*>*>(this + 1);
+      }
+    };
+
+    static InternTable *AllocateInternTable(size_t Size);
+
+    char *AllocateName(std::string_view Name);
+    void FreeName(char *Name, size_t Length);
+
+    // Returns nullptr if the table is full or out of memory
+    char const *Intern(std::string_view Name);
+    InternTable *InternedNames{};
+    std::atomic<size_t> InternedBytes{};
+    std::atomic<bool> InternFullLogged{};
+  };
+}
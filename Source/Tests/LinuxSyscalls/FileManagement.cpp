@@ -11,7 +11,6 @@ $end_info$
 #include "Tests/LinuxSyscalls/x64/Syscalls.h"
 
 #include <FEXCore/Utils/LogManager.h>
-#include <FEXHeaderUtils/ScopedSignalMask.h>
 #include <FEXHeaderUtils/Syscalls.h>
 
 #include <algorithm>
@@ -272,13 +271,26 @@ FileManager::FileManager(FEXCore::Context::Context *ctx)
     }
   }
 
+  if (RootFSPathCacheEnabled() && !LDPath().empty()) {
+    PathCache = std::make_unique<RootFSPathCache>(LDPath());
+    if (!PathCache->Initialize()) {
+      PathCache.reset();
+    }
+  }
+
   UpdatePID(::getpid());
 }
 
 FileManager::~FileManager() {
 }
 
-std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlink) {
+void FileManager::CleanupAfterFork() {
+  if (PathCache) {
+    PathCache->CleanupAfterFork();
+  }
+}
+
+std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlink, bool MustExist) {
   auto RootFSPath = LDPath();
   if (!pathname || // If no pathname
       pathname[0] != '/' || // If relative
@@ -295,18 +307,51 @@ std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlin
     return {};
   }
 
+  if (!FollowSymlink) {
+    return RootFSPath + pathname;
+  }
+
+  RootFSPathCache::Entry Cached;
+  if (PathCache && PathCache->Find(pathname, &Cached)) {
+    if (MustExist && !Cached.Exists) {
+      return {};
+    }
+    return std::move(Cached.Path);
+  }
+
+  // Only cache the result if every directory it depends on ended up being watched
+  uint64_t Generation{};
+  bool Cacheable = PathCache && PathCache->BeginResolve(&Generation);
+
   std::string Path = RootFSPath + pathname;
-  if (FollowSymlink) {
+  bool Exists{};
+  while (true) {
+    Cacheable = Cacheable && PathCache->Watch(Path);
+
     std::error_code ec;
-    while(std::filesystem::is_symlink(Path, ec)) {
-      auto SymlinkTarget = std::filesystem::read_symlink(Path);
-      if (SymlinkTarget.is_absolute()) {
-        Path = RootFSPath + SymlinkTarget.string();
-      }
-      else {
-        break;
-      }
+    auto Status = std::filesystem::symlink_status(Path, ec);
+    // Any error other than the path missing means we don't know, let the caller try it
+    Exists = ec || Status.type() != std::filesystem::file_type::not_found;
+
+    if (Status.type() != std::filesystem::file_type::symlink) {
+      break;
     }
+
+    auto SymlinkTarget = std::filesystem::read_symlink(Path);
+    if (SymlinkTarget.is_absolute()) {
+      Path = RootFSPath + SymlinkTarget.string();
+    }
+    else {
+      break;
+    }
+  }
+
+  if (Cacheable) {
+    PathCache->Insert(pathname, RootFSPathCache::Entry{Path, Exists}, Generation);
+  }
+
+  if (MustExist && !Exists) {
+    return {};
   }
   return Path;
 }
@@ -336,10 +381,7 @@ uint64_t FileManager::Open(const char *pathname, [[maybe_unused]] int flags, [[m
 }
 
 uint64_t FileManager::Close(int fd) {
-  {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
-    FDToNameMap.erase(fd);
-  }
+  FDNames.Erase(fd);
   return ::close(fd);
 }
 
@@ -351,11 +393,7 @@ uint64_t FileManager::CloseRange(unsigned int first, unsigned int last, unsigned
   if (!(flags & CLOSE_RANGE_CLOEXEC)) {
     // If the flag was set then it doesn't actually close the FDs
     // Just sets the flag on a range
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
-    for (unsigned int i = first; i <= last; ++i) {
-      // We remove from first to last inclusive
-      FDToNameMap.erase(i);
-    }
+    FDNames.EraseRange(first, last);
   }
   return ::syscall(SYSCALL_DEF(close_range), first, last, flags);
 }
@@ -365,7 +403,7 @@ uint64_t FileManager::Stat(const char *pathname, void *buf) {
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
   // Stat follows symlinks
-  auto Path = GetEmulatedPath(SelfPath, true);
+  auto Path = GetEmulatedPath(SelfPath, true, true);
   if (!Path.empty()) {
     uint64_t Result = ::stat(Path.c_str(), reinterpret_cast<struct stat*>(buf));
     if (Result != -1)
@@ -394,7 +432,7 @@ uint64_t FileManager::Access(const char *pathname, [[maybe_unused]] int mode) {
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
   // Access follows symlinks
-  auto Path = GetEmulatedPath(SelfPath, true);
+  auto Path = GetEmulatedPath(SelfPath, true, true);
   if (!Path.empty()) {
     uint64_t Result = ::access(Path.c_str(), mode);
     if (Result != -1)
@@ -422,7 +460,7 @@ uint64_t FileManager::FAccessat2(int dirfd, const char *pathname, int mode, int
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0);
+  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0, true);
   if (!Path.empty()) {
     uint64_t Result = ::syscall(SYSCALL_DEF(faccessat2), dirfd, Path.c_str(), mode, flags);
     if (Result != -1)
@@ -548,9 +586,12 @@ uint64_t FileManager::Openat([[maybe_unused]] int dirfs, const char *pathname, i
 
   fd = EmuFD.OpenAt(dirfs, SelfPath, flags, mode);
   if (fd == -1) {
-    auto Path = GetEmulatedPath(SelfPath, true);
+    auto Path = GetEmulatedPath(SelfPath, true, (flags & O_CREAT) == 0);
     if (!Path.empty()) {
       fd = ::openat(dirfs, Path.c_str(), flags, mode);
+      if (fd != -1 && (flags & O_CREAT)) {
+        InvalidatePathCache();
+      }
     }
 
     if (fd == -1)
@@ -558,8 +599,7 @@ uint64_t FileManager::Openat([[maybe_unused]] int dirfs, const char *pathname, i
   }
 
   if (fd != -1) {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
-    FDToNameMap.insert_or_assign(fd, SelfPath);
+    FDNames.Set(fd, SelfPath);
   }
 
   return fd;
@@ -573,9 +613,12 @@ uint64_t FileManager::Openat2(int dirfs, const char *pathname, FEX::HLE::open_ho
 
   fd = EmuFD.OpenAt(dirfs, SelfPath, how->flags, how->mode);
   if (fd == -1) {
-    auto Path = GetEmulatedPath(SelfPath, true);
+    auto Path = GetEmulatedPath(SelfPath, true, (how->flags & O_CREAT) == 0);
     if (!Path.empty()) {
       fd = ::syscall(SYSCALL_DEF(openat2), dirfs, Path.c_str(), how, usize);
+      if (fd != -1 && (how->flags & O_CREAT)) {
+        InvalidatePathCache();
+      }
     }
 
     if (fd == -1)
@@ -583,8 +626,7 @@ uint64_t FileManager::Openat2(int dirfs, const char *pathname, FEX::HLE::open_ho
   }
 
   if (fd != -1) {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
-    FDToNameMap.insert_or_assign(fd, SelfPath);
+    FDNames.Set(fd, SelfPath);
   }
 
   return fd;
@@ -595,7 +637,7 @@ uint64_t FileManager::Statx(int dirfd, const char *pathname, int flags, uint32_t
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0);
+  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0, true);
   if (!Path.empty()) {
     uint64_t Result = FHU::Syscalls::statx(dirfd, Path.c_str(), flags, mask, statxbuf);
     if (Result != -1)
@@ -611,8 +653,10 @@ uint64_t FileManager::Mknod(const char *pathname, mode_t mode, dev_t dev) {
   auto Path = GetEmulatedPath(SelfPath);
   if (!Path.empty()) {
     uint64_t Result = ::mknod(Path.c_str(), mode, dev);
-    if (Result != -1)
+    if (Result != -1) {
+      InvalidatePathCache();
       return Result;
+    }
   }
   return ::mknod(SelfPath, mode, dev);
 }
@@ -631,7 +675,7 @@ uint64_t FileManager::NewFSStatAt(int dirfd, const char *pathname, struct stat *
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0);
+  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0, true);
   if (!Path.empty()) {
     uint64_t Result = ::fstatat(dirfd, Path.c_str(), buf, flag);
     if (Result != -1) {
@@ -645,7 +689,7 @@ uint64_t FileManager::NewFSStatAt64(int dirfd, const char *pathname, struct stat
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0);
+  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0, true);
   if (!Path.empty()) {
     uint64_t Result = ::fstatat64(dirfd, Path.c_str(), buf, flag);
     if (Result != -1) {
@@ -655,13 +699,8 @@ uint64_t FileManager::NewFSStatAt64(int dirfd, const char *pathname, struct stat
   return ::fstatat64(dirfd, SelfPath, buf, flag);
 }
 
-std::string *FileManager::FindFDName(int fd) {
-  FHU::ScopedSignalMaskWithMutex lk(FDLock);
-  auto it = FDToNameMap.find(fd);
-  if (it == FDToNameMap.end()) {
-    return nullptr;
-  }
-  return &it->second;
+char const *FileManager::FindFDName(int fd) {
+  return FDNames.Find(fd);
 }
 
 }
@@ -10,7 +10,7 @@ $end_info$
 #include <cstdint>
 #include <functional>
 #include <map>
-#include <mutex>
+#include <memory>
 #include <optional>
 #include <stddef.h>
 #include <string>
@@ -20,6 +20,8 @@ $end_info$
 #include <unordered_set>
 
 #include "Tests/LinuxSyscalls/EmulatedFiles/EmulatedFiles.h"
+#include "Tests/LinuxSyscalls/FDNameTable.h"
+#include "Tests/LinuxSyscalls/RootFSPathCache.h"
 
 namespace FEXCore::Context {
 struct Context;
@@ -57,28 +59,44 @@ public:
   // vfs
   uint64_t Statfs(const char *path, void *buf);
 
-  std::string *FindFDName(int fd);
+  // Pointer stays valid even after the FD is closed
+  char const *FindFDName(int fd);
 
   std::optional<std::string> GetSelf(const char *Pathname);
 
   void UpdatePID(uint32_t PID) { CurrentPID = PID; }
 
-  std::string GetEmulatedPath(const char *pathname, bool FollowSymlink = false);
+  /**
+   * @brief Returns where pathname lives inside of the rootfs
+   *
+   * @param MustExist Only applies when following symlinks. Returns an empty path if the rootfs doesn't contain
+   * pathname so the caller can go directly to the host path. Callers that may create the file must not set this.
+   */
+  std::string GetEmulatedPath(const char *pathname, bool FollowSymlink = false, bool MustExist = false);
 
-  std::mutex *GetFDLock() { return &FDLock; }
+  // Must be called in the child of a fork that doesn't share the address space
+  void CleanupAfterFork();
 
 private:
   FEX::EmulatedFile::EmulatedFDManager EmuFD;
 
-  std::mutex FDLock;
-  std::unordered_map<int32_t, std::string> FDToNameMap;
+  FDNameTable FDNames;
   std::map<std::string, std::string, std::less<>> ThunkOverlays;
+  std::unique_ptr<RootFSPathCache> PathCache{};
+
+  // The guest created something through the rootfs
+  void InvalidatePathCache() {
+    if (PathCache) {
+      PathCache->Invalidate();
+    }
+  }
 
   FEX_CONFIG_OPT(Filename, APP_FILENAME);
   FEX_CONFIG_OPT(LDPath, ROOTFS);
   FEX_CONFIG_OPT(ThunkHostLibs, THUNKHOSTLIBS);
   FEX_CONFIG_OPT(ThunkGuestLibs, THUNKGUESTLIBS);
   FEX_CONFIG_OPT(ThunkConfig, THUNKCONFIG);
+  FEX_CONFIG_OPT(RootFSPathCacheEnabled, ROOTFSPATHCACHE);
   uint32_t CurrentPID{};
 
   void LoadThunkDatabase(bool Global);
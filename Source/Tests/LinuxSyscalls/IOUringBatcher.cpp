@@ -0,0 +1,435 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Batches guest blocking file I/O through a shared host io_uring
+$end_info$
+*/
+
+#include "Tests/LinuxSyscalls/IOUringBatcher.h"
+#include "Tests/LinuxSyscalls/Syscalls.h"
+#include "Tests/LinuxSyscalls/x64/Syscalls.h"
+
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <memory>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef IORING_FEAT_NODROP
+#define IORING_FEAT_NODROP (1U << 1)
+#endif
+
+#ifndef IORING_FEAT_RW_CUR_POS
+#define IORING_FEAT_RW_CUR_POS (1U << 3)
+#endif
+
+#ifndef IORING_FEAT_EXT_ARG
+#define IORING_FEAT_EXT_ARG (1U << 8)
+#endif
+
+#ifndef IORING_ENTER_EXT_ARG
+#define IORING_ENTER_EXT_ARG (1U << 3)
+#endif
+
+#ifndef RWF_NOWAIT
+#define RWF_NOWAIT 0x00000008
+#endif
+
+namespace FEX::HLE {
+  // Mirrors the kernel's io_uring_getevents_arg and __kernel_timespec
+  // Defined here since older UAPI headers don't have them
+  struct GetEventsArg {
+    uint64_t sigmask;
+    uint32_t sigmask_sz;
+    uint32_t pad;
+    uint64_t ts;
+  };
+
+  struct KernelTimespec {
+    int64_t tv_sec;
+    int64_t tv_nsec;
+  };
+
+  // Number of SQEs in the shared ring
+  // Once this many requests are outstanding guest threads fall back to direct syscalls
+  constexpr static uint32_t RING_ENTRIES = 256;
+
+  // Same clamp the kernel applies to read and write
+  constexpr static size_t MAX_RW_COUNT = 0x7FFF'F000;
+
+  // Bounds how long a waiter sleeps if another thread reaped its completion
+  // between it checking the CQ and entering the kernel
+  constexpr static KernelTimespec WAIT_TIMEOUT {0, 1'000'000};
+
+  // Set while a thread is inside the batcher
+  // A guest signal handler can run on top of us while RingMutex is held, it must not reenter
+  static thread_local bool InsideBatcher{};
+
+  IOUringBatcher::~IOUringBatcher() {
+    if (CQ.CQEs) {
+      std::lock_guard<std::mutex> lk(RingMutex);
+      ReapCompletions();
+    }
+    Shutdown();
+  }
+
+  bool IOUringBatcher::Initialize() {
+    io_uring_params Params{};
+    int FD = ::syscall(SYSCALL_DEF(io_uring_setup), RING_ENTRIES, &Params);
+    if (FD == -1) {
+      LogMan::Msg::IFmt("io_uring batching disabled: io_uring_setup failed with {}", errno);
+      return false;
+    }
+
+    constexpr uint32_t RequiredFeatures =
+      IORING_FEAT_SINGLE_MMAP |
+      IORING_FEAT_NODROP |
+      IORING_FEAT_RW_CUR_POS |
+      IORING_FEAT_EXT_ARG;
+
+    if ((Params.features & RequiredFeatures) != RequiredFeatures) {
+      LogMan::Msg::IFmt("io_uring batching disabled: Host io_uring is missing features");
+      close(FD);
+      return false;
+    }
+
+    RingFD = FD;
+    SQEntries = Params.sq_entries;
+
+    // With IORING_FEAT_SINGLE_MMAP the SQ and CQ rings share a single mapping
+    SQRingSize = std::max<size_t>(
+      Params.sq_off.array + Params.sq_entries * sizeof(uint32_t),
+      Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe));
+    SQRingPtr = FEXCore::Allocator::mmap(nullptr, SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFD, IORING_OFF_SQ_RING);
+    if (SQRingPtr == MAP_FAILED) {
+      SQRingPtr = nullptr;
+      Shutdown();
+      return false;
+    }
+    CQRingPtr = SQRingPtr;
+    CQRingSize = 0;
+
+    SQEsSize = Params.sq_entries * sizeof(io_uring_sqe);
+    void *SQEsPtr = FEXCore::Allocator::mmap(nullptr, SQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFD, IORING_OFF_SQES);
+    if (SQEsPtr == MAP_FAILED) {
+      Shutdown();
+      return false;
+    }
+
+    auto SQBase = reinterpret_cast<uint8_t*>(SQRingPtr);
+    SQ.Head = reinterpret_cast<uint32_t*>(SQBase + Params.sq_off.head);
+    SQ.Tail = reinterpret_cast<uint32_t*>(SQBase + Params.sq_off.tail);
+    SQ.Mask = *reinterpret_cast<uint32_t*>(SQBase + Params.sq_off.ring_mask);
+    SQ.Array = reinterpret_cast<uint32_t*>(SQBase + Params.sq_off.array);
+    SQ.SQEs = reinterpret_cast<io_uring_sqe*>(SQEsPtr);
+
+    auto CQBase = reinterpret_cast<uint8_t*>(CQRingPtr);
+    CQ.Head = reinterpret_cast<uint32_t*>(CQBase + Params.cq_off.head);
+    CQ.Tail = reinterpret_cast<uint32_t*>(CQBase + Params.cq_off.tail);
+    CQ.Mask = *reinterpret_cast<uint32_t*>(CQBase + Params.cq_off.ring_mask);
+    CQ.CQEs = reinterpret_cast<io_uring_cqe*>(CQBase + Params.cq_off.cqes);
+
+    Outstanding = 0;
+    Broken = false;
+    return true;
+  }
+
+  void IOUringBatcher::Shutdown() {
+    if (SQ.SQEs) {
+      FEXCore::Allocator::munmap(SQ.SQEs, SQEsSize);
+    }
+
+    if (CQRingPtr && CQRingPtr != SQRingPtr) {
+      FEXCore::Allocator::munmap(CQRingPtr, CQRingSize);
+    }
+
+    if (SQRingPtr) {
+      FEXCore::Allocator::munmap(SQRingPtr, SQRingSize);
+    }
+
+    if (RingFD != -1) {
+      close(RingFD);
+    }
+
+    RingFD = -1;
+    SQ = {};
+    CQ = {};
+    SQRingPtr = nullptr;
+    CQRingPtr = nullptr;
+
+    // The ring is gone, nothing can complete these anymore
+    // After a fork these are the child's copies, the parent's CQ must not be reaped from here
+    for (auto Req : Orphans) {
+      delete Req;
+    }
+    Orphans.clear();
+    Entering = 0;
+  }
+
+  void IOUringBatcher::CleanupAfterFork() {
+    // Another thread in the parent may have held the lock at the time of fork
+    // We are the only thread in the child so reconstruct it in place
+    new (&RingMutex) std::mutex{};
+    InsideBatcher = false;
+
+    // Requests that were in flight belong to threads that don't exist in the child
+    Shutdown();
+    if (!Initialize()) {
+      Broken = true;
+    }
+  }
+
+  void IOUringBatcher::ReapCompletions() {
+    uint32_t Head = *CQ.Head;
+    uint32_t Tail = __atomic_load_n(CQ.Tail, __ATOMIC_ACQUIRE);
+
+    for (; Head != Tail; ++Head) {
+      auto &CQE = CQ.CQEs[Head & CQ.Mask];
+      auto Req = reinterpret_cast<Request*>(CQE.user_data);
+      if (Req->Orphaned) {
+        std::erase(Orphans, Req);
+        delete Req;
+      }
+      else {
+        Req->Result = CQE.res;
+        Req->Done = true;
+      }
+      --Outstanding;
+    }
+
+    __atomic_store_n(CQ.Head, Head, __ATOMIC_RELEASE);
+  }
+
+  std::optional<int32_t> IOUringBatcher::SubmitAndWait(io_uring_sqe const &SQE) {
+    if (InsideBatcher) {
+      return std::nullopt;
+    }
+
+    struct ScopedInside {
+      ScopedInside() { InsideBatcher = true; }
+      ~ScopedInside() { InsideBatcher = false; }
+    } Inside;
+
+    // Lives on the heap since the kernel can still complete it after we gave up waiting
+    auto Req = std::make_unique<Request>();
+    uint32_t Position{};
+
+    {
+      std::lock_guard<std::mutex> lk(RingMutex);
+      if (RingFD == -1 || Broken || Outstanding >= SQEntries) {
+        return std::nullopt;
+      }
+
+      // We are the only writer of the SQ tail while holding the lock
+      uint32_t Tail = *SQ.Tail;
+      uint32_t Index = Tail & SQ.Mask;
+      Position = Tail;
+      SQ.SQEs[Index] = SQE;
+      SQ.SQEs[Index].user_data = reinterpret_cast<uint64_t>(Req.get());
+      SQ.Array[Index] = Index;
+      __atomic_store_n(SQ.Tail, Tail + 1, __ATOMIC_RELEASE);
+      ++Outstanding;
+    }
+
+    const GetEventsArg Arg {
+      .sigmask = 0,
+      .sigmask_sz = 0,
+      .pad = 0,
+      .ts = reinterpret_cast<uint64_t>(&WAIT_TIMEOUT),
+    };
+
+    bool Waiting{};
+    while (true) {
+      uint32_t ToSubmit{};
+      {
+        std::lock_guard<std::mutex> lk(RingMutex);
+        // Another thread may have already submitted and reaped our request
+        ReapCompletions();
+        if (Req->Done) {
+          return Req->Result;
+        }
+
+        if (Broken) {
+          const bool Consumed = static_cast<int32_t>(__atomic_load_n(SQ.Head, __ATOMIC_ACQUIRE) - Position) > 0;
+          if (!Consumed) {
+            if (Entering == 0) {
+              // Usually the guest closed our ring FD, nothing can consume the request anymore so it is safe to do directly
+              return std::nullopt;
+            }
+
+            // Another thread's io_uring_enter could still pick it up, wait for it to come back
+            Waiting = true;
+          }
+          else {
+            // The kernel may still be working on the request, so redoing it could repeat a write
+            // Leave it for whoever reaps its completion and report the failure instead
+            Req->Orphaned = true;
+            Orphans.emplace_back(Req.release());
+            return -EIO;
+          }
+        }
+        else {
+          // Submit everything that is queued, not just ours. This is where the batching happens
+          ToSubmit = *SQ.Tail - __atomic_load_n(SQ.Head, __ATOMIC_ACQUIRE);
+          ++Entering;
+        }
+      }
+
+      if (Waiting) {
+        Waiting = false;
+        sched_yield();
+        continue;
+      }
+
+      int Result = ::syscall(SYSCALL_DEF(io_uring_enter), RingFD, ToSubmit, 1,
+        IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &Arg, sizeof(Arg));
+      const int EnterErrno = errno;
+
+      std::lock_guard<std::mutex> lk(RingMutex);
+      --Entering;
+
+      if (Result == -1) {
+        switch (EnterErrno) {
+          case EINTR:
+          case ETIME:
+          case EAGAIN:
+          case EBUSY:
+            // Transient, go around again
+            break;
+          default:
+            // Most likely the guest closed our ring FD
+            LogMan::Msg::IFmt("io_uring batching disabled: io_uring_enter failed with {}", EnterErrno);
+            Broken = true;
+            break;
+        }
+      }
+    }
+  }
+
+  int64_t IOUringBatcher::ReadWrite(bool IsWrite, int fd, void *buf, size_t count, int64_t Offset) {
+    auto Direct = [IsWrite, fd](void *buf, size_t count, int64_t Offset) -> int64_t {
+      ssize_t Result{};
+      if (IsWrite) {
+        Result = Offset == -1 ? ::write(fd, buf, count) : ::pwrite64(fd, buf, count, Offset);
+      }
+      else {
+        Result = Offset == -1 ? ::read(fd, buf, count) : ::pread64(fd, buf, count, Offset);
+      }
+      return Result == -1 ? -errno : Result;
+    };
+
+    auto Submit = [this, IsWrite, fd](void *buf, size_t count, int64_t Offset) -> std::optional<int32_t> {
+      io_uring_sqe SQE{};
+      SQE.opcode = IsWrite ? IORING_OP_WRITE : IORING_OP_READ;
+      SQE.fd = fd;
+      SQE.addr = reinterpret_cast<uint64_t>(buf);
+      SQE.len = std::min(count, MAX_RW_COUNT);
+      // -1 offset means use and update the file position like read/write does
+      SQE.off = static_cast<uint64_t>(Offset);
+      SQE.rw_flags = RWF_NOWAIT;
+      return SubmitAndWait(SQE);
+    };
+
+    auto Result = Submit(buf, count, Offset);
+    if (!Result.has_value() ||
+        *Result == -EAGAIN ||
+        *Result == -EOPNOTSUPP) {
+      // Couldn't complete without blocking, or the file doesn't support NOWAIT
+      return Direct(buf, count, Offset);
+    }
+
+    if (*Result <= 0 || static_cast<size_t>(*Result) >= count) {
+      return *Result;
+    }
+
+    // NOWAIT can leave us with a short result where the blocking syscall wouldn't have
+    int64_t Done = *Result;
+    auto Advance = [&Offset](int64_t Amount) {
+      if (Offset != -1) {
+        Offset += Amount;
+      }
+    };
+    Advance(Done);
+
+    if (IsWrite) {
+      // Blocking writes only return short if interrupted or out of space, let the host tell us
+      int64_t Rest = Direct(reinterpret_cast<uint8_t*>(buf) + Done, count - Done, Offset);
+      return Rest > 0 ? Done + Rest : Done;
+    }
+
+    // A short read is either EOF, a pipe or socket with nothing more available, or pages missing from the page cache
+    // Only the last case needs to block, so keep pulling without waiting until the kernel tells us which one it is
+    while (static_cast<size_t>(Done) < count) {
+      auto Next = Submit(reinterpret_cast<uint8_t*>(buf) + Done, count - Done, Offset);
+      if (!Next.has_value() ||
+          *Next == -EAGAIN ||
+          *Next == -EOPNOTSUPP) {
+        struct stat Stat{};
+        if (fstat(fd, &Stat) == 0 &&
+            (S_ISREG(Stat.st_mode) || S_ISBLK(Stat.st_mode))) {
+          int64_t Rest = Direct(reinterpret_cast<uint8_t*>(buf) + Done, count - Done, Offset);
+          if (Rest > 0) {
+            Done += Rest;
+          }
+        }
+        break;
+      }
+
+      if (*Next <= 0) {
+        // EOF or an error after a partial read, the partial read wins
+        break;
+      }
+
+      Done += *Next;
+      Advance(*Next);
+    }
+
+    return Done;
+  }
+
+  uint64_t IOUringBatcher::Read(int fd, void *buf, size_t count) {
+    return ReadWrite(false, fd, buf, count, -1);
+  }
+
+  uint64_t IOUringBatcher::Write(int fd, const void *buf, size_t count) {
+    return ReadWrite(true, fd, const_cast<void*>(buf), count, -1);
+  }
+
+  uint64_t IOUringBatcher::PRead(int fd, void *buf, size_t count, uint64_t offset) {
+    if (static_cast<int64_t>(offset) < 0) {
+      return -EINVAL;
+    }
+    return ReadWrite(false, fd, buf, count, offset);
+  }
+
+  uint64_t IOUringBatcher::PWrite(int fd, const void *buf, size_t count, uint64_t offset) {
+    if (static_cast<int64_t>(offset) < 0) {
+      return -EINVAL;
+    }
+    return ReadWrite(true, fd, const_cast<void*>(buf), count, offset);
+  }
+
+  uint64_t IOUringBatcher::FSync(int fd, bool DataSync) {
+    io_uring_sqe SQE{};
+    SQE.opcode = IORING_OP_FSYNC;
+    SQE.fd = fd;
+    SQE.fsync_flags = DataSync ? IORING_FSYNC_DATASYNC : 0;
+
+    auto Submitted = SubmitAndWait(SQE);
+    if (Submitted.has_value()) {
+      return static_cast<int64_t>(*Submitted);
+    }
+
+    uint64_t Result = DataSync ? ::fdatasync(fd) : ::fsync(fd);
+    SYSCALL_ERRNO();
+  }
+}
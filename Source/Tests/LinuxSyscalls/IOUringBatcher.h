@@ -0,0 +1,118 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Batches guest blocking file I/O through a shared host io_uring
+$end_info$
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace FEX::HLE {
+  /**
+   * @brief Routes guest read/write/pread/pwrite/fsync through a single host io_uring shared by all guest threads
+   *
+   * Each guest thread queues its SQE under a short lock and then enters the kernel with every SQE
+   * that hasn't been consumed yet. If another thread's io_uring_enter already consumed and completed
+   * our SQE then we return without making a host syscall at all.
+   *
+   * Reads and writes are submitted with RWF_NOWAIT so the kernel completes them inline or fails them
+   * with EAGAIN. Anything that can't complete inline falls back to the regular blocking host syscall,
+   * which keeps guest visible blocking semantics (including signal interruption) intact.
+   */
+  class IOUringBatcher final {
+  public:
+    IOUringBatcher() = default;
+    ~IOUringBatcher();
+
+    /**
+     * @brief Creates the shared ring
+     *
+     * @return false if the host kernel doesn't support the io_uring features we depend on
+     */
+    bool Initialize();
+
+    /**
+     * @brief Must be called in the child of a fork that doesn't share the address space
+     *
+     * The ring mappings are MAP_SHARED with the parent so the child needs its own ring.
+     */
+    void CleanupAfterFork();
+
+    // Syscall style returns. Negative errno on failure
+    uint64_t Read(int fd, void *buf, size_t count);
+    uint64_t Write(int fd, const void *buf, size_t count);
+    uint64_t PRead(int fd, void *buf, size_t count, uint64_t offset);
+    uint64_t PWrite(int fd, const void *buf, size_t count, uint64_t offset);
+    uint64_t FSync(int fd, bool DataSync);
+
+  private:
+    struct Request {
+      int32_t Result{};
+      bool Done{};
+      // The waiter gave up on it, whoever reaps the completion frees it
+      bool Orphaned{};
+    };
+
+    struct SubmissionQueue {
+      uint32_t *Head{};
+      uint32_t *Tail{};
+      uint32_t Mask{};
+      uint32_t *Array{};
+      io_uring_sqe *SQEs{};
+    };
+
+    struct CompletionQueue {
+      uint32_t *Head{};
+      uint32_t *Tail{};
+      uint32_t Mask{};
+      io_uring_cqe *CQEs{};
+    };
+
+    void Shutdown();
+
+    /**
+     * @brief Queues the SQE and blocks until it completes
+     *
+     * @return std::nullopt if the ring couldn't take the request, or broke before the kernel consumed it.
+     * Caller must fall back to the host syscall
+     * -EIO if the ring broke after the kernel consumed the request. It may have been done already, it must not be redone
+     */
+    std::optional<int32_t> SubmitAndWait(io_uring_sqe const &SQE);
+
+    // Must be called with RingMutex held
+    void ReapCompletions();
+
+    int64_t ReadWrite(bool IsWrite, int fd, void *buf, size_t count, int64_t Offset);
+
+    std::mutex RingMutex;
+    int RingFD {-1};
+    bool Broken{};
+    // Threads inside io_uring_enter, only those can make the kernel consume SQEs
+    uint32_t Entering{};
+    // Requests whose waiter gave up, freed once reaped or when the ring goes away
+    std::vector<Request*> Orphans;
+
+    // Number of requests sitting in the SQ or CQ that haven't been reaped
+    // Bounded by the SQ size so the CQ can never overflow
+    uint32_t Outstanding{};
+    uint32_t SQEntries{};
+
+    SubmissionQueue SQ{};
+    CompletionQueue CQ{};
+
+    void *SQRingPtr{};
+    size_t SQRingSize{};
+    void *CQRingPtr{};
+    size_t CQRingSize{};
+    size_t SQEsSize{};
+  };
+}
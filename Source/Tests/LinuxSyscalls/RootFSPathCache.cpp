@@ -0,0 +1,247 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Caches guest path resolution inside of the rootfs
+$end_info$
+*/
+
+#include "Tests/LinuxSyscalls/RootFSPathCache.h"
+
+#include <FEXCore/Utils/LogManager.h>
+#include <FEXCore/Utils/Threads.h>
+
+#include <errno.h>
+#include <new>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace FEX::HLE {
+  // Anything that can change which files exist in a directory, or the directory itself going away
+  constexpr static uint32_t WATCH_MASK =
+    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+  RootFSPathCache::RootFSPathCache(std::string_view RootFS)
+    : RootFS {RootFS} {
+    // Watches are added per directory, don't carry a trailing separator in the base
+    while (this->RootFS.size() > 1 && this->RootFS.back() == '/') {
+      this->RootFS.pop_back();
+    }
+  }
+
+  RootFSPathCache::~RootFSPathCache() {
+    // The watcher thread is detached and sits in a blocking read until the process exits.
+    // State is intentionally leaked so it is always valid for that thread.
+    if (State) {
+      State->Broken = true;
+    }
+  }
+
+  bool RootFSPathCache::Initialize() {
+    if (!State) {
+      State = new WatcherState{};
+    }
+
+    State->FD = inotify_init1(IN_CLOEXEC);
+    if (State->FD == -1) {
+      LogMan::Msg::DFmt("Couldn't create inotify instance for the RootFS path cache: {}", errno);
+      State->Broken = true;
+      return false;
+    }
+
+    State->Broken = false;
+
+    // The watcher thread must never receive signals
+    uint64_t OldMask = FEXCore::Threads::SetSignalMask(~0ULL);
+    Watcher = FEXCore::Threads::Thread::Create(WatcherThread, State);
+    FEXCore::Threads::SetSignalMask(OldMask);
+    Watcher->detach();
+
+    return true;
+  }
+
+  void RootFSPathCache::CleanupAfterFork() {
+    // Another thread in the parent may have held the lock at the time of fork
+    // We are the only thread in the child so reconstruct it in place
+    new (&CacheMutex) std::mutex{};
+
+    // The watcher thread didn't survive the fork and the inotify instance is still the parent's.
+    // Drop the inherited watches without touching the parent's instance.
+    Watcher.reset();
+    if (State && State->FD != -1) {
+      close(State->FD);
+      State->FD = -1;
+    }
+
+    Entries.clear();
+    LRU.clear();
+    WatchedDirs.clear();
+
+    if (!Initialize()) {
+      return;
+    }
+
+    CachedGeneration = State->Generation.load();
+  }
+
+  void *RootFSPathCache::WatcherThread(void *Arg) {
+    auto State = reinterpret_cast<WatcherState*>(Arg);
+    alignas(inotify_event) char Buffer[4096];
+
+    while (true) {
+      ssize_t Result = read(State->FD, Buffer, sizeof(Buffer));
+      if (Result == -1 && errno == EINTR) {
+        continue;
+      }
+
+      if (Result <= 0) {
+        // Guest closed our FD or something equally bad happened
+        // Without notifications nothing in the cache can be trusted
+        State->Broken = true;
+        State->Generation.fetch_add(1);
+        return nullptr;
+      }
+
+      bool Changed{};
+      for (ssize_t Offset = 0; Offset < Result; ) {
+        auto Event = reinterpret_cast<inotify_event const*>(&Buffer[Offset]);
+        // IN_IGNORED on its own is from us removing a watch during a flush
+        if (Event->mask & ~IN_IGNORED) {
+          Changed = true;
+        }
+        Offset += sizeof(inotify_event) + Event->len;
+      }
+
+      if (Changed) {
+        State->Generation.fetch_add(1);
+      }
+    }
+  }
+
+  void RootFSPathCache::FlushIfStale() {
+    if (State->Generation.load() != CachedGeneration) {
+      Flush();
+    }
+  }
+
+  void RootFSPathCache::Flush() {
+    CachedGeneration = State->Generation.load();
+
+    Entries.clear();
+    LRU.clear();
+
+    for (auto &[Dir, WD] : WatchedDirs) {
+      inotify_rm_watch(State->FD, WD);
+    }
+    WatchedDirs.clear();
+  }
+
+  bool RootFSPathCache::Find(std::string_view GuestPath, Entry *Result) {
+    if (!State || State->Broken) {
+      return false;
+    }
+
+    std::unique_lock lk(CacheMutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+      return false;
+    }
+
+    FlushIfStale();
+
+    auto it = Entries.find(GuestPath);
+    if (it == Entries.end()) {
+      return false;
+    }
+
+    // Move to the front of the LRU
+    LRU.splice(LRU.begin(), LRU, it->second);
+    *Result = it->second->second;
+    return true;
+  }
+
+  bool RootFSPathCache::BeginResolve(uint64_t *Generation) {
+    if (!State || State->Broken) {
+      return false;
+    }
+
+    *Generation = State->Generation.load();
+    return true;
+  }
+
+  bool RootFSPathCache::Watch(std::string_view HostPath) {
+    if (HostPath.size() <= RootFS.size() ||
+        HostPath.compare(0, RootFS.size(), RootFS) != 0) {
+      // Not something we know how to watch
+      return false;
+    }
+
+    std::unique_lock lk(CacheMutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+      return false;
+    }
+
+    FlushIfStale();
+
+    // Watch every directory from the rootfs down to the parent of this path.
+    // Only the deepest existing one is needed to see the rest of the path appear.
+    size_t DirEnd = RootFS.size();
+    while (DirEnd != std::string_view::npos) {
+      std::string Dir {HostPath.substr(0, DirEnd)};
+
+      if (!WatchedDirs.contains(Dir)) {
+        if (WatchedDirs.size() >= MAX_WATCHES) {
+          // Start over rather than growing the kernel's watch list forever
+          Invalidate();
+          return false;
+        }
+
+        int WD = inotify_add_watch(State->FD, Dir.c_str(), WATCH_MASK);
+        if (WD == -1) {
+          // Something in the path doesn't exist
+          // Parent directory is watched so we will see it being created
+          return errno == ENOENT || errno == ENOTDIR;
+        }
+
+        WatchedDirs.emplace(std::move(Dir), WD);
+      }
+
+      DirEnd = HostPath.find('/', DirEnd + 1);
+    }
+
+    return true;
+  }
+
+  void RootFSPathCache::Insert(std::string_view GuestPath, Entry &&Result, uint64_t Generation) {
+    std::unique_lock lk(CacheMutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+      return;
+    }
+
+    FlushIfStale();
+
+    if (Generation != CachedGeneration) {
+      // Something changed while resolving
+      return;
+    }
+
+    auto it = Entries.find(GuestPath);
+    if (it != Entries.end()) {
+      it->second->second = std::move(Result);
+      LRU.splice(LRU.begin(), LRU, it->second);
+      return;
+    }
+
+    auto &Item = LRU.emplace_front(GuestPath, std::move(Result));
+    Entries.emplace(Item.first, LRU.begin());
+
+    if (LRU.size() > MAX_ENTRIES) {
+      Entries.erase(LRU.back().first);
+      LRU.pop_back();
+    }
+  }
+
+  void RootFSPathCache::Invalidate() {
+    if (State) {
+      State->Generation.fetch_add(1);
+    }
+  }
+}
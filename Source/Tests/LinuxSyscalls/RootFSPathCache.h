@@ -0,0 +1,110 @@
+/*
+$info$
+tags: LinuxSyscalls|common
+desc: Caches guest path resolution inside of the rootfs
+$end_info$
+*/
+
+#pragma once
+
+#include <FEXCore/Utils/Threads.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace FEX::HLE {
+  /**
+   * @brief LRU cache of where a guest path ends up inside of the rootfs after following absolute symlinks
+   *
+   * Also remembers when a path doesn't exist in the rootfs so callers can go directly to the host path.
+   *
+   * Every directory a cached resolution depends on is watched with inotify from a background thread.
+   * Any change to one of those directories drops the whole cache. Guest syscalls that create files
+   * through the rootfs invalidate the cache synchronously with `Invalidate`.
+   *
+   * All the locking here is `try_lock`. If a guest signal handler interrupts a thread that is inside the cache
+   * then lookups from the handler just miss, which keeps this safe without masking signals.
+   */
+  class RootFSPathCache final {
+  public:
+    struct Entry {
+      std::string Path;
+      bool Exists{};
+    };
+
+    RootFSPathCache(std::string_view RootFS);
+    ~RootFSPathCache();
+
+    /**
+     * @brief Creates the inotify instance and the watcher thread
+     *
+     * @return false if the cache can't be used
+     */
+    bool Initialize();
+
+    /**
+     * @brief Must be called in the child of a fork that doesn't share the address space
+     *
+     * The inotify instance is shared with the parent and the watcher thread doesn't exist in the child.
+     */
+    void CleanupAfterFork();
+
+    bool Find(std::string_view GuestPath, Entry *Result);
+
+    /**
+     * @name Filling the cache
+     *
+     * A resolution takes a generation with `BeginResolve`, calls `Watch` on each host path before probing it
+     * and then `Insert`s the result. The insert is discarded if anything changed in the meantime.
+     * @{ */
+    bool BeginResolve(uint64_t *Generation);
+    bool Watch(std::string_view HostPath);
+    void Insert(std::string_view GuestPath, Entry &&Result, uint64_t Generation);
+    /**  @} */
+
+    void Invalidate();
+
+  private:
+    constexpr static size_t MAX_ENTRIES = 4096;
+    constexpr static size_t MAX_WATCHES = 8192;
+
+    // Shared with the watcher thread
+    // Never freed since a blocked watcher thread can't be woken to shut it down
+    struct WatcherState {
+      std::atomic<uint64_t> Generation{};
+      std::atomic<bool> Broken{};
+      int FD {-1};
+    };
+
+    static void *WatcherThread(void *Arg);
+
+    // Must be called with CacheMutex held
+    void FlushIfStale();
+    void Flush();
+
+    std::string RootFS;
+
+    WatcherState *State{};
+    std::unique_ptr<FEXCore::Threads::Thread> Watcher{};
+
+    std::mutex CacheMutex;
+    // Generation that the contents of the cache are valid for
+    uint64_t CachedGeneration{};
+
+    // Most recently used at the front
+    // Map keys are views in to the list's strings
+    using LRUList = std::list<std::pair<std::string, Entry>>;
+    LRUList LRU{};
+    std::unordered_map<std::string_view, LRUList::iterator> Entries{};
+
+    // Host directory -> inotify watch descriptor
+    std::unordered_map<std::string, int> WatchedDirs{};
+  };
+}
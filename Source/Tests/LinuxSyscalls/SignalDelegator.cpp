@@ -7,6 +7,7 @@ $end_info$
 
 #include <FEXCore/Core/Context.h>
 #include <FEXCore/Debug/InternalThreadState.h>
+#include "Common/SocketLogging.h"
 #include "Tests/LinuxSyscalls/SignalDelegator.h"
 
 #include <FEXCore/Core/CoreState.h>
@@ -17,7 +18,9 @@ $end_info$
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXHeaderUtils/Syscalls.h>
 
+#include <array>
 #include <atomic>
+#include <bit>
 #include <string.h>
 
 #include <errno.h>
@@ -56,14 +59,34 @@ namespace FEX::HLE {
       .ss_size = 0,
     };
     // This is the thread's current signal mask
+    // Only the guest sees this, the host mask is applied lazily, see CalculateHostMask
     FEXCore::GuestSAMask CurrentSignalMask{};
     // The mask prior to a suspend
     FEXCore::GuestSAMask PreviousSuspendMask{};
 
-    uint64_t PendingSignals{};
+    // The host mask outside of host signal handlers
+    uint64_t HostMask{};
+    bool HostMaskInitialized{};
+
+    // Signals that arrived while guest masked and are now blocked on the host until the guest unmasks them
+    uint64_t HostBlockedSignals{};
+
+    // The ones of those held on to by this thread, with the siginfo they arrived with
+    uint64_t DeferredSignals{};
+    std::array<siginfo_t, SignalDelegator::MAX_SIGNALS> DeferredInfo{};
+  };
+
+  // Process directed signals that were handed back to the process while a marker for them is queued
+  struct ProcessDeferredSignal {
+    std::atomic<bool> InFlight{};
+    siginfo_t Info{};
   };
 
+  // SIGKILL and SIGSTOP can't be masked
+  constexpr static uint64_t MASKABLE_SIGNALS = ~((1ULL << (SIGKILL - 1)) | (1ULL << (SIGSTOP - 1)));
+
   thread_local ThreadState ThreadData{};
+  static std::array<ProcessDeferredSignal, SignalDelegator::MAX_SIGNALS> ProcessDeferred{};
 
   static void SignalHandlerThunk(int Signal, siginfo_t *Info, void *UContext) {
     GlobalDelegator->HandleSignal(Signal, Info, UContext);
@@ -81,14 +104,162 @@ namespace FEX::HLE {
     return Set->Val | (1ULL << Signal);
   }
 
+  static bool IsSynchronousFault(int Signal, siginfo_t *Info) {
+    // The kernel delivers these even when blocked, the guest can't defer them
+    switch (Signal) {
+      case SIGSEGV:
+      case SIGBUS:
+      case SIGILL:
+      case SIGFPE:
+      case SIGTRAP:
+        return Info->si_code > 0;
+      default:
+        return false;
+    }
+  }
+
+  // The siginfo doesn't say who a signal was sent to, only these are certain to have been sent to the whole process
+  // Anything else might have been aimed at this thread, eg SIGPIPE from a write, SIGEV_THREAD_ID timers or rt_tgsigqueueinfo
+  static bool IsProcessDirected(int Signal, siginfo_t *Info) {
+    switch (Info->si_code) {
+      case SI_USER:
+        // kill() from another process, tgkill is SI_TKILL and the kernel's own SI_USER signals come with our PID
+        return Info->si_pid != ::getpid();
+      case SI_KERNEL:
+        // Interval timers signal the process
+        return Signal == SIGALRM || Signal == SIGVTALRM || Signal == SIGPROF;
+      default:
+        // Child state changes are sent to the process
+        return Signal == SIGCHLD && Info->si_code > 0;
+    }
+  }
+
+  uint64_t SignalDelegator::GetRequiredSignalsMask() const {
+    uint64_t Mask{};
+    for (size_t i = 0; i < MAX_SIGNALS; ++i) {
+      if (HostHandlers[i + 1].Required.load(std::memory_order_relaxed)) {
+        Mask |= (1ULL << i);
+      }
+    }
+    return Mask;
+  }
+
+  // The kernel only lets the main thread queue a signal with a kernel or kill() siginfo
+  // So a deferred signal is queued again as a marker pointing at where its original siginfo is kept
+  static int QueueDeferredSignalMarker(int Signal, siginfo_t *OriginalInfo, bool ToThread) {
+    siginfo_t Marker{};
+    Marker.si_signo = Signal;
+    Marker.si_code = SI_QUEUE;
+    Marker.si_pid = ::getpid();
+    Marker.si_uid = ::getuid();
+    Marker.si_value.sival_ptr = OriginalInfo;
+
+    if (ToThread) {
+      return ::syscall(SYS_rt_tgsigqueueinfo, ::getpid(), FHU::Syscalls::gettid(), Signal, &Marker);
+    }
+    return ::syscall(SYS_rt_sigqueueinfo, ::getpid(), Signal, &Marker);
+  }
+
+  static bool IsDeferredSignalMarker(siginfo_t const *Info, siginfo_t const *OriginalInfo) {
+    return Info->si_code == SI_QUEUE &&
+           Info->si_pid == ::getpid() &&
+           Info->si_value.sival_ptr == OriginalInfo;
+  }
+
+  // Swaps a marker for the siginfo the signal originally arrived with
+  static void RestoreDeferredSignalInfo(int Signal, siginfo_t *Info) {
+    if (IsDeferredSignalMarker(Info, &ThreadData.DeferredInfo[Signal - 1])) {
+      *Info = ThreadData.DeferredInfo[Signal - 1];
+    }
+    else if (IsDeferredSignalMarker(Info, &ProcessDeferred[Signal - 1].Info)) {
+      *Info = ProcessDeferred[Signal - 1].Info;
+      ProcessDeferred[Signal - 1].InFlight.store(false, std::memory_order_release);
+    }
+  }
+
+  // Queues the deferred signals this thread held on to that the guest has unmasked now
+  static void RedeliverUnmaskedSignals() {
+    uint64_t Unmasked = ThreadData.DeferredSignals & ~ThreadData.CurrentSignalMask.Val;
+    ThreadData.DeferredSignals &= ~Unmasked;
+    ThreadData.HostBlockedSignals &= ThreadData.CurrentSignalMask.Val;
+
+    for (int Signal = 1; Unmasked != 0; ++Signal, Unmasked >>= 1) {
+      if (Unmasked & 1) {
+        // Still blocked on the host, gets delivered once the host mask catches up
+        QueueDeferredSignalMarker(Signal, &ThreadData.DeferredInfo[Signal - 1], true);
+      }
+    }
+  }
+
+  void SignalDelegator::DeferGuestSignal(FEXCore::Core::InternalThreadState *Thread, int Signal, siginfo_t *Info, void *UContext) {
+    ucontext_t* _context = (ucontext_t*)UContext;
+    const uint64_t SignalBit = 1ULL << (Signal - 1);
+
+    // Block it on the host now so further ones stay pending in the kernel instead of landing back in here
+    ::syscall(SYS_rt_sigprocmask, SIG_BLOCK, &SignalBit, nullptr, 8);
+
+    // Keep it blocked once the handler returns
+    uint64_t HostMask{};
+    memcpy(&HostMask, &_context->uc_sigmask, sizeof(uint64_t));
+    HostMask |= SignalBit;
+    memcpy(&_context->uc_sigmask, &HostMask, sizeof(uint64_t));
+    ThreadData.HostMask |= SignalBit;
+    ThreadData.HostBlockedSignals |= SignalBit;
+
+    // Process directed signals go back to the process so any thread that isn't masking it can take it
+    // Only one can be in flight per signal, anything past that is held on to by this thread
+    if (IsProcessDirected(Signal, Info)) {
+      auto &Slot = ProcessDeferred[Signal - 1];
+      bool Expected = false;
+      if (Slot.InFlight.compare_exchange_strong(Expected, true, std::memory_order_acquire)) {
+        Slot.Info = *Info;
+        if (QueueDeferredSignalMarker(Signal, &Slot.Info, false) == 0) {
+          return;
+        }
+        Slot.InFlight.store(false, std::memory_order_release);
+      }
+    }
+
+    // Delivered with this siginfo once the guest unmasks it
+    ThreadData.DeferredInfo[Signal - 1] = *Info;
+    ThreadData.DeferredSignals |= SignalBit;
+  }
+
+  uint64_t SignalDelegator::CalculateHostMask(uint64_t GuestMask) const {
+    const uint64_t NoThunkSignals = ~ThunkSignals.load(std::memory_order_relaxed);
+    return ((GuestMask & NoThunkSignals) | ThreadData.HostBlockedSignals) & MASKABLE_SIGNALS & ~GetRequiredSignalsMask();
+  }
+
+  void SignalDelegator::UpdateHostMask() {
+    // Before the thread is set up the host mask is still the one the guest mask gets taken from
+    if (!ThreadData.HostMaskInitialized) {
+      return;
+    }
+
+    RedeliverUnmaskedSignals();
+
+    const uint64_t HostMask = CalculateHostMask(ThreadData.CurrentSignalMask.Val);
+    if (HostMask != ThreadData.HostMask) {
+      ThreadData.HostMask = HostMask;
+      ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &HostMask, nullptr, 8);
+      // We might not even return here which is spooky
+    }
+  }
+
   void SignalDelegator::HandleGuestSignal(FEXCore::Core::InternalThreadState *Thread, int Signal, void *Info, void *UContext) {
     // Let the host take first stab at handling the signal
     SignalHandler &Handler = HostHandlers[Signal];
 
-    ucontext_t* _context = (ucontext_t*)UContext;
+    // A deferred signal coming back, the guest gets the siginfo it originally arrived with
+    RestoreDeferredSignalInfo(Signal, static_cast<siginfo_t*>(Info));
 
-    // Remove the pending signal
-    ThreadData.PendingSignals &= ~(1ULL << (Signal - 1));
+    // The guest has this signal masked, hold on to it until it gets unmasked
+    if (SigIsMember(&ThreadData.CurrentSignalMask, Signal) &&
+        !Handler.Required.load(std::memory_order_relaxed) &&
+        !IsSynchronousFault(Signal, static_cast<siginfo_t*>(Info))) {
+      DeferGuestSignal(Thread, Signal, static_cast<siginfo_t*>(Info), UContext);
+      return;
+    }
 
     // We have an emulation thread pointer, we can now modify its state
     if (Handler.GuestAction.sigaction_handler.handler == SIG_DFL) {
@@ -105,25 +276,21 @@ namespace FEX::HLE {
       if (Handler.GuestHandler &&
           Handler.GuestHandler(Thread, Signal, Info, UContext, &Handler.GuestAction, &ThreadData.GuestAltStack)) {
 
-        // Set up a new mask based on this signals signal mask
-        uint64_t NewMask = Handler.GuestAction.sa_mask.Val;
+        // The guest handler runs with this signal's mask added to the current one
+        // The dispatcher has already saved the current mask and gives it back on sigreturn
+        uint64_t NewMask = ThreadData.CurrentSignalMask.Val | Handler.GuestAction.sa_mask.Val;
 
-        // If NODEFER then the new signal mask includes this signal
+        // Unless NODEFER the new signal mask also includes this signal
         if (!(Handler.GuestAction.sa_flags & SA_NODEFER)) {
           NewMask |= (1ULL << (Signal - 1));
         }
 
-        // Walk our required signals and stop masking them if requested
-        for (size_t i = 0; i < MAX_SIGNALS; ++i) {
-          if (HostHandlers[i + 1].Required.load(std::memory_order_relaxed)) {
-            // Never mask our required signals
-            NewMask &= ~(1ULL << i);
-          }
-        }
+        ThreadData.CurrentSignalMask.Val = NewMask & MASKABLE_SIGNALS;
 
-        // Update our host signal mask so we don't hit race conditions with signals
-        // This allows us to maintain the expected signal mask through the guest signal handling and then all the way back again
-        memcpy(&_context->uc_sigmask, &NewMask, sizeof(uint64_t));
+        // Applied to the host once the host handler returns
+        ucontext_t* _context = (ucontext_t*)UContext;
+        ThreadData.HostMask = CalculateHostMask(ThreadData.CurrentSignalMask.Val);
+        memcpy(&_context->uc_sigmask, &ThreadData.HostMask, sizeof(uint64_t));
 
         // We handled this signal, continue running
         return;
@@ -132,6 +299,9 @@ namespace FEX::HLE {
     }
 
     // Unhandled crash
+    // The process is likely going down, get the last log messages out first
+    FEX::SocketLogging::Client::Flush();
+
     // Call back in to the previous handler
     if (Handler.OldAction.sa_flags & SA_SIGINFO) {
       Handler.OldAction.sigaction(Signal, static_cast<siginfo_t*>(Info), UContext);
@@ -231,6 +401,15 @@ namespace FEX::HLE {
       SignalHandler.HostAction.handler = SIG_DFL;
     }
 
+    const uint64_t SignalBit = 1ULL << (Signal - 1);
+    const bool HasThunk = SignalHandler.HostAction.handler != SIG_DFL && SignalHandler.HostAction.handler != SIG_IGN;
+    if (!HasThunk) {
+      // The kernel acts on it directly from now on, block it first if this thread has it masked
+      // Other threads catch up the next time their mask changes
+      ThunkSignals.fetch_and(~SignalBit, std::memory_order_relaxed);
+      UpdateHostMask();
+    }
+
     // Only update the old action if we haven't ever been installed
     const int Result = ::syscall(SYS_rt_sigaction, Signal, &SignalHandler.HostAction, SignalHandler.Installed ? nullptr : &SignalHandler.OldAction, 8);
     if (Result < 0) {
@@ -239,6 +418,12 @@ namespace FEX::HLE {
       return false;
     }
 
+    if (HasThunk) {
+      // Masked ones can be deferred by the thunk now
+      ThunkSignals.fetch_or(SignalBit, std::memory_order_relaxed);
+      UpdateHostMask();
+    }
+
     return true;
   }
 
@@ -314,8 +499,16 @@ namespace FEX::HLE {
       LogMan::Msg::EFmt("Failed to install alternative signal stack {}", strerror(errno));
     }
 
-    // Get the current host signal mask
+    // The host mask we were started with is the guest's mask
     ::syscall(SYS_rt_sigprocmask, 0, nullptr, &ThreadData.CurrentSignalMask.Val, 8);
+    ThreadData.CurrentSignalMask.Val &= MASKABLE_SIGNALS;
+
+    // From here on the guest mask is only applied lazily
+    ThreadData.HostBlockedSignals = 0;
+    ThreadData.DeferredSignals = 0;
+    ThreadData.HostMask = CalculateHostMask(ThreadData.CurrentSignalMask.Val);
+    ThreadData.HostMaskInitialized = true;
+    ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &ThreadData.HostMask, nullptr, 8);
   }
 
   void SignalDelegator::UninstallFrontendTLSState(FEXCore::Core::InternalThreadState *Thread) {
@@ -443,19 +636,6 @@ namespace FEX::HLE {
     return 0;
   }
 
-  static void CheckForPendingSignals(FEXCore::Core::InternalThreadState *Thread) {
-    // Do we have any pending signals that became unmasked?
-    uint64_t PendingSignals = ~ThreadData.CurrentSignalMask.Val & ThreadData.PendingSignals;
-    if (PendingSignals != 0) {
-      for (int i = 0; i < 64; ++i) {
-        if (PendingSignals & (1ULL << i)) {
-          FHU::Syscalls::tgkill(Thread->ThreadManager.PID, Thread->ThreadManager.TID, i + 1);
-          // We might not even return here which is spooky
-        }
-      }
-    }
-  }
-
   uint64_t SignalDelegator::GuestSigProcMask(int how, const uint64_t *set, uint64_t *oldset) {
     // The order in which we handle signal mask setting is important here
     // old and new can point to the same location in memory.
@@ -466,39 +646,27 @@ namespace FEX::HLE {
     // 3) Give old mask back
     auto OldSet = ThreadData.CurrentSignalMask.Val;
 
+    // The host mask only changes for signals the kernel would act on directly, the rest get deferred in HandleGuestSignal
     if (!!set) {
-      uint64_t IgnoredSignalsMask = ~((1ULL << (SIGKILL - 1)) | (1ULL << (SIGSTOP - 1)));
       if (how == SIG_BLOCK) {
-        ThreadData.CurrentSignalMask.Val |= *set & IgnoredSignalsMask;
+        ThreadData.CurrentSignalMask.Val |= *set & MASKABLE_SIGNALS;
       }
       else if (how == SIG_UNBLOCK) {
-        ThreadData.CurrentSignalMask.Val &= ~(*set & IgnoredSignalsMask);
+        ThreadData.CurrentSignalMask.Val &= ~(*set & MASKABLE_SIGNALS);
       }
       else if (how == SIG_SETMASK) {
-        ThreadData.CurrentSignalMask.Val = *set & IgnoredSignalsMask;
+        ThreadData.CurrentSignalMask.Val = *set & MASKABLE_SIGNALS;
       }
       else {
         return -EINVAL;
       }
-
-      uint64_t HostMask = ThreadData.CurrentSignalMask.Val;
-      // Now actually set the host mask
-      // This will hide from the guest that we are not actually setting all of the masks it wants
-      for (size_t i = 0; i < MAX_SIGNALS; ++i) {
-        if (HostHandlers[i + 1].Required.load(std::memory_order_relaxed)) {
-          // If it is a required host signal then we can't mask it
-          HostMask &= ~(1ULL << i);
-        }
-      }
-
-      ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &HostMask, nullptr, 8);
     }
 
     if (!!oldset) {
       *oldset = OldSet;
     }
 
-    CheckForPendingSignals(GetTLSThread());
+    UpdateHostMask();
 
     return 0;
   }
@@ -508,7 +676,8 @@ namespace FEX::HLE {
       return -EINVAL;
     }
 
-    *set = ThreadData.PendingSignals;
+    // Deferred signals held on to by this thread, the rest are pending on the host
+    *set = ThreadData.DeferredSignals;
 
     sigset_t HostSet{};
     if (sigpending(&HostSet) == 0) {
@@ -519,7 +688,6 @@ namespace FEX::HLE {
         }
       }
 
-      // Merge the real pending signal mask as well
       *set |= HostSignals;
     }
     return 0;
@@ -530,18 +698,21 @@ namespace FEX::HLE {
       return -EINVAL;
     }
 
-    uint64_t IgnoredSignalsMask = ~((1ULL << (SIGKILL - 1)) | (1ULL << (SIGSTOP - 1)));
-
     // Backup the mask
     ThreadData.PreviousSuspendMask = ThreadData.CurrentSignalMask;
     // Set the new mask
-    ThreadData.CurrentSignalMask.Val = *set & IgnoredSignalsMask;
+    ThreadData.CurrentSignalMask.Val = *set & MASKABLE_SIGNALS;
     sigset_t HostSet{};
 
     sigemptyset(&HostSet);
 
+    // Deferred signals the guest is now waiting on get queued again
+    RedeliverUnmaskedSignals();
+
+    // Everything the guest masks is blocked while suspended, only the signals it waits on can wake it
+    const uint64_t SuspendMask = (ThreadData.CurrentSignalMask.Val | ThreadData.HostBlockedSignals) & ~GetRequiredSignalsMask();
     for (int32_t i = 0; i < MAX_SIGNALS; ++i) {
-      if (*set & (1ULL << i)) {
+      if (SuspendMask & (1ULL << i)) {
         sigaddset(&HostSet, i + 1);
       }
     }
@@ -561,20 +732,67 @@ namespace FEX::HLE {
     // then this is safe-ish
     ThreadData.CurrentSignalMask = ThreadData.PreviousSuspendMask;
 
-    CheckForPendingSignals(GetTLSThread());
+    UpdateHostMask();
 
     return Result == -1 ? -errno : Result;
 
   }
 
+  uint64_t SignalDelegator::GetGuestSignalMask() {
+    return ThreadData.CurrentSignalMask.Val;
+  }
+
+  void SignalDelegator::RestoreGuestSignalMask(uint64_t Mask, void *UContext) {
+    ucontext_t* _context = (ucontext_t*)UContext;
+
+    ThreadData.CurrentSignalMask.Val = Mask & MASKABLE_SIGNALS;
+
+    // Deferred signals that are no longer masked get delivered once we return
+    RedeliverUnmaskedSignals();
+
+    // The host mask that was saved on entry can be stale if the guest mask changed inside the handler
+    ThreadData.HostMask = CalculateHostMask(ThreadData.CurrentSignalMask.Val);
+    memcpy(&_context->uc_sigmask, &ThreadData.HostMask, sizeof(uint64_t));
+  }
+
+  void SignalDelegator::BlockGuestMaskedSignals() {
+    uint64_t HostMask = (ThreadData.CurrentSignalMask.Val | ThreadData.HostBlockedSignals) & ~GetRequiredSignalsMask();
+    ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &HostMask, nullptr, 8);
+  }
+
+  void SignalDelegator::RestoreHostSignalMask() {
+    // Anything that arrived in between gets deferred as usual
+    ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &ThreadData.HostMask, nullptr, 8);
+  }
+
   uint64_t SignalDelegator::GuestSigTimedWait(uint64_t *set, siginfo_t *info, const struct timespec *timeout, size_t sigsetsize) {
     if (sigsetsize > sizeof(uint64_t)) {
       return -EINVAL;
     }
 
-    uint64_t Result = ::syscall(SYS_rt_sigtimedwait, set, info, timeout);
+    // Deferred signals held on to by this thread are no longer pending on the host
+    const uint64_t Deferred = ThreadData.DeferredSignals & *set;
+    if (Deferred) {
+      const int Signal = std::countr_zero(Deferred) + 1;
+      ThreadData.DeferredSignals &= ~(1ULL << (Signal - 1));
+      if (info) {
+        *info = ThreadData.DeferredInfo[Signal - 1];
+      }
+      return Signal;
+    }
 
-    return Result == -1 ? -errno : Result;
+    siginfo_t HostInfo{};
+    uint64_t Result = ::syscall(SYS_rt_sigtimedwait, set, &HostInfo, timeout, sizeof(uint64_t));
+    if (Result == -1) {
+      return -errno;
+    }
+
+    RestoreDeferredSignalInfo(Result, &HostInfo);
+    if (info) {
+      *info = HostInfo;
+    }
+
+    return Result;
   }
 
   uint64_t SignalDelegator::GuestSignalFD(int fd, const uint64_t *set, size_t sigsetsize, int flags) {
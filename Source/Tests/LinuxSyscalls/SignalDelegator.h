@@ -53,6 +53,18 @@ namespace FEX::HLE {
       uint64_t GuestSigSuspend(uint64_t *set, size_t sigsetsize);
       uint64_t GuestSigTimedWait(uint64_t *set, siginfo_t *info, const struct timespec *timeout, size_t sigsetsize);
       uint64_t GuestSignalFD(int fd, const uint64_t *set, size_t sigsetsize , int flags);
+
+      uint64_t GetGuestSignalMask() override;
+      void RestoreGuestSignalMask(uint64_t Mask, void *UContext) override;
+
+      /**
+       * @brief Temporarily sets the host mask to the guest mask
+       *
+       * The guest mask is only applied to the host lazily, so anything that inherits the host mask
+       * (new threads, execve) needs to be wrapped in this and RestoreHostSignalMask.
+       */
+      void BlockGuestMaskedSignals();
+      void RestoreHostSignalMask();
     /**  @} */
 
       void UninstallHostHandler(int Signal);
@@ -108,6 +120,22 @@ namespace FEX::HLE {
     bool InstallHostThunk(int Signal);
     bool UpdateHostThunk(int Signal);
 
+    uint64_t GetRequiredSignalsMask() const;
+    void DeferGuestSignal(FEXCore::Core::InternalThreadState *Thread, int Signal, siginfo_t *Info, void *UContext);
+
+    /**
+     * @brief The host mask to use while the guest has GuestMask applied
+     *
+     * Guest masked signals with a host thunk are only blocked once one arrives, the ones without a thunk
+     * would be acted on by the kernel directly and always stay blocked.
+     */
+    uint64_t CalculateHostMask(uint64_t GuestMask) const;
+    // Applies the calling thread's mask to the host, outside of a host signal handler
+    void UpdateHostMask();
+
+    // Signals that have the host thunk installed, the rest are SIG_DFL or SIG_IGN on the host
+    std::atomic<uint64_t> ThunkSignals{};
+
     std::mutex HostDelegatorMutex;
     std::mutex GuestDelegatorMutex;
   };
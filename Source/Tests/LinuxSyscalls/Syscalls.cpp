@@ -6,9 +6,13 @@ desc: Glue logic, brk allocations
 $end_info$
 */
 
+#include "Common/Config.h"
+#include "Common/ExecServer.h"
+#include "Common/SocketLogging.h"
 #include "Linux/Utils/ELFContainer.h"
 
 #include "Tests/LinuxSyscalls/LinuxAllocator.h"
+#include "Tests/LinuxSyscalls/SignalDelegator.h"
 #include "Tests/LinuxSyscalls/Syscalls.h"
 #include "Tests/LinuxSyscalls/Syscalls/Thread.h"
 #include "Tests/LinuxSyscalls/x32/Syscalls.h"
@@ -34,6 +38,7 @@ $end_info$
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -113,7 +118,46 @@ static bool IsSupportedByInterpreter(std::string const &Filename) {
   return false;
 }
 
-uint64_t ExecveHandler(const char *pathname, char* const* argv, char* const* envp, ExecveAtArgs *Args) {
+static uint64_t ExecveWithGuestSignalMask(FEXCore::Core::CpuStateFrame *Frame, const char *Filename, char* const* argv, char* const* envp, ExecveAtArgs *Args, char const* const* ExecServerArgv = nullptr) {
+  // Signal masks survive execve, so the new process needs to start with the guest's mask rather than our open host mask
+  auto SignalDelegator = FEX::HLE::_SyscallHandler->GetSignalDelegator();
+  SignalDelegator->BlockGuestMaskedSignals();
+
+  // Anything still queued is lost once the process image gets replaced
+  FEX::SocketLogging::Client::Flush();
+
+  // ExecServerArgv is what FEX would get started with for this program
+  // Only FEX gets started with those, it can skip parsing the config files again
+  std::optional<FEX::Config::SnapshotEnvironment> SnapshotEnv;
+  if (ExecServerArgv) {
+    envp = SnapshotEnv.emplace(envp).Get();
+  }
+
+  // execveat is left alone, its path can be relative to a directory fd
+  if (ExecServerArgv && !Args && FEX::HLE::_SyscallHandler->ExecServerEnabled()) {
+    // Only returns if the exec server didn't take the program
+    FEX::ExecServer::Client::TryExec(ExecServerArgv, envp, [CTX = Frame->Thread->CTX]() {
+      FEXCore::Context::PauseOtherThreads(CTX);
+    });
+  }
+
+  uint64_t Result{};
+  if (Args) {
+    Result = ::syscall(SYS_execveat, Args->dirfd, Filename, argv, envp, Args->flags);
+  }
+  else {
+    Result = execve(Filename, argv, envp);
+  }
+
+  // Only returns on failure
+  int ExecveErrno = errno;
+  SignalDelegator->RestoreHostSignalMask();
+  errno = ExecveErrno;
+
+  SYSCALL_ERRNO();
+}
+
+uint64_t ExecveHandler(FEXCore::Core::CpuStateFrame *Frame, const char *pathname, char* const* argv, char* const* envp, ExecveAtArgs *Args) {
   std::string Filename{};
 
   std::error_code ec;
@@ -157,20 +201,22 @@ uint64_t ExecveHandler(const char *pathname, char* const* argv, char* const* env
   // We can only call execve directly if we both have an interpreter installed AND were ran with the interpreter
   // If the user ran FEX through FEXLoader then we must go down the emulated path
   ELFLoader::ELFContainer::ELFType Type = ELFLoader::ELFContainer::GetELFType(Filename);
-  uint64_t Result{};
   if (FEX::HLE::_SyscallHandler->IsInterpreterInstalled() &&
       FEX::HLE::_SyscallHandler->IsInterpreter() &&
       (Type == ELFLoader::ELFContainer::ELFType::TYPE_X86_32 ||
        Type == ELFLoader::ELFContainer::ELFType::TYPE_X86_64)) {
     // If the FEX interpreter is installed then just execve the ELF file
     // This will stay inside of our emulated environment since binfmt_misc will capture it
-    if (Args) {
-      Result = ::syscall(SYS_execveat, Args->dirfd, Filename.c_str(), argv, envp, Args->flags);
-    }
-    else {
-      Result = execve(Filename.c_str(), argv, envp);
+    // binfmt_misc would start the interpreter with the filename in place of argv[0]
+    std::vector<const char *> InterpreterArgs{"FEXInterpreter", Filename.c_str()};
+    if (argv && *argv) {
+      for (auto Arg = argv + 1; *Arg; ++Arg) {
+        InterpreterArgs.emplace_back(*Arg);
+      }
     }
-    SYSCALL_ERRNO();
+    InterpreterArgs.emplace_back(nullptr);
+
+    return ExecveWithGuestSignalMask(Frame, Filename.c_str(), argv, envp, Args, InterpreterArgs.data());
   }
 
   if (!IsSupportedByInterpreter(Filename) && Type == ELFLoader::ELFContainer::ELFType::TYPE_NONE) {
@@ -184,13 +230,7 @@ uint64_t ExecveHandler(const char *pathname, char* const* argv, char* const* env
     // We are trying to execute an ELF of a different architecture
     // We can't know if we can support this without architecture specific checks and binfmt_misc parsing
     // Just execve it and let the kernel handle the process
-    if (Args) {
-      Result = ::syscall(SYS_execveat, Args->dirfd, Filename.c_str(), argv, envp, Args->flags);
-    }
-    else {
-      Result = execve(Filename.c_str(), argv, envp);
-    }
-    SYSCALL_ERRNO();
+    return ExecveWithGuestSignalMask(Frame, Filename.c_str(), argv, envp, Args);
   }
 
   // We don't have an interpreter installed or we are executing a non-ELF executable
@@ -220,15 +260,7 @@ uint64_t ExecveHandler(const char *pathname, char* const* argv, char* const* env
     ExecveArgs.emplace_back(nullptr);
   }
 
-  if (Args) {
-    Result = ::syscall(SYS_execveat, Args->dirfd, "/proc/self/exe",
-                       const_cast<char *const *>(ExecveArgs.data()), envp, Args->flags);
-  }
-  else {
-    Result = execve("/proc/self/exe", const_cast<char *const *>(ExecveArgs.data()), envp);
-  }
-
-  SYSCALL_ERRNO();
+  return ExecveWithGuestSignalMask(Frame, "/proc/self/exe", const_cast<char *const *>(ExecveArgs.data()), envp, Args, argv ? ExecveArgs.data() : nullptr);
 }
 
 static bool AnyFlagsSet(uint64_t Flags, uint64_t Mask) {
@@ -479,7 +511,11 @@ uint64_t CloneHandler(FEXCore::Core::CpuStateFrame *Frame, FEX::HLE::clone3_args
       reinterpret_cast<pid_t*>(args->args.child_tid),
       reinterpret_cast<void*>(args->args.tls));
   } else {
+    // The new thread picks up its guest mask from the host mask it starts with
+    auto SignalDelegator = FEX::HLE::_SyscallHandler->GetSignalDelegator();
+    SignalDelegator->BlockGuestMaskedSignals();
     auto NewThread = FEX::HLE::CreateNewThread(Thread->CTX, Frame, &args->args);
+    SignalDelegator->RestoreHostSignalMask();
 
     // Return the new threads TID
     uint64_t Result = NewThread->ThreadManager.GetTID();
@@ -593,6 +629,13 @@ SyscallHandler::SyscallHandler(FEXCore::Context::Context *ctx, FEX::HLE::SignalD
   HostKernelVersion = CalculateHostKernelVersion();
   GuestKernelVersion = CalculateGuestKernelVersion();
   Alloc32Handler = FEX::HLE::Create32BitAllocator();
+
+  if (IOUringBatching() && IsHostKernelVersionAtLeast(5, 11, 0)) {
+    IOBatcher = std::make_unique<FEX::HLE::IOUringBatcher>();
+    if (!IOBatcher->Initialize()) {
+      IOBatcher.reset();
+    }
+  }
 }
 
 SyscallHandler::~SyscallHandler() {
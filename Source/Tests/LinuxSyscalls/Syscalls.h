@@ -8,6 +8,7 @@ $end_info$
 #pragma once
 
 #include "Tests/LinuxSyscalls/FileManagement.h"
+#include "Tests/LinuxSyscalls/IOUringBatcher.h"
 #include "Tests/LinuxSyscalls/LinuxAllocator.h"
 
 #include <FEXCore/Config/Config.h>
@@ -76,7 +77,7 @@ struct ExecveAtArgs {
   int flags;
 };
 
-uint64_t ExecveHandler(const char *pathname, char* const* argv, char* const* envp, ExecveAtArgs *Args);
+uint64_t ExecveHandler(FEXCore::Core::CpuStateFrame *Frame, const char *pathname, char* const* argv, char* const* envp, ExecveAtArgs *Args);
 
 class SyscallHandler : public FEXCore::HLE::SyscallHandler {
 public:
@@ -136,6 +137,8 @@ public:
   FEX_CONFIG_OPT(RootFSPath, ROOTFS);
   FEX_CONFIG_OPT(ThreadsConfig, THREADS);
   FEX_CONFIG_OPT(Is64BitMode, IS64BIT_MODE);
+  FEX_CONFIG_OPT(IOUringBatching, IOURINGBATCHING);
+  FEX_CONFIG_OPT(ExecServerEnabled, EXECSERVER);
 
   uint32_t GetHostKernelVersion() const { return HostKernelVersion; }
   uint32_t GetGuestKernelVersion() const { return GuestKernelVersion; }
@@ -157,6 +160,9 @@ public:
 
   FEX::HLE::MemAllocator *Get32BitAllocator() { return Alloc32Handler.get(); }
 
+  // nullptr unless io_uring batching was requested and the host supports it
+  FEX::HLE::IOUringBatcher *GetIOUringBatcher() { return IOBatcher.get(); }
+
 protected:
   std::vector<SyscallFunctionDefinition> Definitions{};
   std::mutex MMapMutex;
@@ -184,6 +190,7 @@ private:
   #endif
 
   std::unique_ptr<FEX::HLE::MemAllocator> Alloc32Handler{};
+  std::unique_ptr<FEX::HLE::IOUringBatcher> IOBatcher{};
 };
 
 uint64_t HandleSyscall(SyscallHandler *Handler, FEXCore::Core::CpuStateFrame *Frame, FEXCore::HLE::SyscallArguments *Args);
@@ -27,15 +27,45 @@ $end_info$
 
 namespace FEX::HLE {
   void RegisterFD(FEX::HLE::SyscallHandler *const Handler) {
-    REGISTER_SYSCALL_IMPL_PASS(read, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
-      uint64_t Result = ::read(fd, buf, count);
-      SYSCALL_ERRNO();
-    });
+    if (Handler->GetIOUringBatcher()) {
+      // These can't be passthrough, the syscall optimization pass would inline them past the batcher
+      REGISTER_SYSCALL_IMPL(read, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->Read(fd, buf, count);
+      });
 
-    REGISTER_SYSCALL_IMPL_PASS(write, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
-      uint64_t Result = ::write(fd, buf, count);
-      SYSCALL_ERRNO();
-    });
+      REGISTER_SYSCALL_IMPL(write, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->Write(fd, buf, count);
+      });
+
+      REGISTER_SYSCALL_IMPL(fsync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->FSync(fd, false);
+      });
+
+      REGISTER_SYSCALL_IMPL(fdatasync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->FSync(fd, true);
+      });
+    }
+    else {
+      REGISTER_SYSCALL_IMPL_PASS(read, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
+        uint64_t Result = ::read(fd, buf, count);
+        SYSCALL_ERRNO();
+      });
+
+      REGISTER_SYSCALL_IMPL_PASS(write, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
+        uint64_t Result = ::write(fd, buf, count);
+        SYSCALL_ERRNO();
+      });
+
+      REGISTER_SYSCALL_IMPL_PASS(fsync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
+        uint64_t Result = ::fsync(fd);
+        SYSCALL_ERRNO();
+      });
+
+      REGISTER_SYSCALL_IMPL_PASS(fdatasync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
+        uint64_t Result = ::fdatasync(fd);
+        SYSCALL_ERRNO();
+      });
+    }
 
     REGISTER_SYSCALL_IMPL(open, [](FEXCore::Core::CpuStateFrame *Frame, const char *pathname, int flags, uint32_t mode) -> uint64_t {
       flags = FEX::HLE::RemapFromX86Flags(flags);
@@ -89,16 +119,6 @@ namespace FEX::HLE {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS(fsync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
-      uint64_t Result = ::fsync(fd);
-      SYSCALL_ERRNO();
-    });
-
-    REGISTER_SYSCALL_IMPL_PASS(fdatasync, [](FEXCore::Core::CpuStateFrame *Frame, int fd) -> uint64_t {
-      uint64_t Result = ::fdatasync(fd);
-      SYSCALL_ERRNO();
-    });
-
     REGISTER_SYSCALL_IMPL_PASS(ftruncate, [](FEXCore::Core::CpuStateFrame *Frame, int fd, off_t length) -> uint64_t {
       uint64_t Result = ::ftruncate(fd, length);
       SYSCALL_ERRNO();
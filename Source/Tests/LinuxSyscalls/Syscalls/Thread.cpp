@@ -129,6 +129,14 @@ namespace FEX::HLE {
       // Frame->Thread is /ONLY/ safe to access when CLONE_THREAD flag is not set
       FEXCore::Context::CleanupAfterFork(CTX, Frame->Thread);
 
+      // Without a shared address space the io_uring mappings can't be shared with the parent
+      if (!(flags & CLONE_VM)) {
+        if (auto Batcher = FEX::HLE::_SyscallHandler->GetIOUringBatcher()) {
+          Batcher->CleanupAfterFork();
+        }
+        FEX::HLE::_SyscallHandler->FM.CleanupAfterFork();
+      }
+
       Thread->CurrentFrame->State.gregs[FEXCore::X86State::REG_RAX] = 0;
       Thread->CurrentFrame->State.gregs[FEXCore::X86State::REG_RBX] = 0;
       Thread->CurrentFrame->State.gregs[FEXCore::X86State::REG_RBP] = 0;
@@ -168,11 +176,6 @@ namespace FEX::HLE {
   }
 
   uint64_t ForkGuest(FEXCore::Core::InternalThreadState *Thread, FEXCore::Core::CpuStateFrame *Frame, uint32_t flags, void *stack, pid_t *parent_tid, pid_t *child_tid, void *tls) {
-    // Just before we fork, pull the Filemanagement mutex so it is in a safe state
-    // Locking the mutex will mean that both processes will end up with a locked mutex
-    auto Mutex = FEX::HLE::_SyscallHandler->FM.GetFDLock();
-    Mutex->lock();
-
     pid_t Result{};
     if (flags & CLONE_VFORK) {
       // XXX: We don't currently support a vfork as it causes problems.
@@ -183,9 +186,6 @@ namespace FEX::HLE {
       Result = fork();
     }
 
-    // Unlock the mutex on both sides of the fork
-    Mutex->unlock();
-
     if (Result == 0) {
       // Child
       // update the internal TID
@@ -197,6 +197,14 @@ namespace FEX::HLE {
       // Clear all the other threads that are being tracked
       FEXCore::Context::CleanupAfterFork(Thread->CTX, Frame->Thread);
 
+      // The io_uring is shared with the parent, the child needs its own
+      if (auto Batcher = FEX::HLE::_SyscallHandler->GetIOUringBatcher()) {
+        Batcher->CleanupAfterFork();
+      }
+
+      // Path cache watcher thread doesn't exist in the child
+      FEX::HLE::_SyscallHandler->FM.CleanupAfterFork();
+
       // only a  single thread running so no need to remove anything from the thread array
 
       // Handle child setup now
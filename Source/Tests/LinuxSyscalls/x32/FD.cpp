@@ -252,7 +252,7 @@ namespace FEX::HLE::x32 {
     SYSCALL_ERRNO();
   };
 
-  void RegisterFD() {
+  void RegisterFD(FEX::HLE::SyscallHandler *const Handler) {
     REGISTER_SYSCALL_IMPL_X32_PASS(poll, [](FEXCore::Core::CpuStateFrame *Frame, struct pollfd *fds, nfds_t nfds, int timeout) -> uint64_t {
       uint64_t Result = ::poll(fds, nfds, timeout);
       SYSCALL_ERRNO();
@@ -961,23 +961,42 @@ namespace FEX::HLE::x32 {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_X32(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
-      uint64_t Offset = offset_high;
-      Offset <<= 32;
-      Offset |= offset_low;
+    if (Handler->GetIOUringBatcher()) {
+      REGISTER_SYSCALL_IMPL_X32(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
+        uint64_t Offset = offset_high;
+        Offset <<= 32;
+        Offset |= offset_low;
 
-      uint64_t Result = ::pread64(fd, buf, count, Offset);
-      SYSCALL_ERRNO();
-    });
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->PRead(fd, buf, count, Offset);
+      });
 
-    REGISTER_SYSCALL_IMPL_X32(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
-      uint64_t Offset = offset_high;
-      Offset <<= 32;
-      Offset |= offset_low;
+      REGISTER_SYSCALL_IMPL_X32(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
+        uint64_t Offset = offset_high;
+        Offset <<= 32;
+        Offset |= offset_low;
 
-      uint64_t Result = ::pwrite64(fd, buf, count, Offset);
-      SYSCALL_ERRNO();
-    });
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->PWrite(fd, buf, count, Offset);
+      });
+    }
+    else {
+      REGISTER_SYSCALL_IMPL_X32(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
+        uint64_t Offset = offset_high;
+        Offset <<= 32;
+        Offset |= offset_low;
+
+        uint64_t Result = ::pread64(fd, buf, count, Offset);
+        SYSCALL_ERRNO();
+      });
+
+      REGISTER_SYSCALL_IMPL_X32(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, uint32_t count, uint32_t offset_low, uint32_t offset_high) -> uint64_t {
+        uint64_t Offset = offset_high;
+        Offset <<= 32;
+        Offset |= offset_low;
+
+        uint64_t Result = ::pwrite64(fd, buf, count, Offset);
+        SYSCALL_ERRNO();
+      });
+    }
 
     REGISTER_SYSCALL_IMPL_X32(readahead, [](FEXCore::Core::CpuStateFrame *Frame, int fd, uint32_t offset_low, uint64_t offset_high, size_t count) -> uint64_t {
       uint64_t Offset = offset_high;
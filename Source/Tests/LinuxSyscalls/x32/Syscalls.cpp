@@ -30,7 +30,7 @@ namespace FEXCore::Context {
 
 namespace FEX::HLE::x32 {
   void RegisterEpoll(FEX::HLE::SyscallHandler *const Handler);
-  void RegisterFD();
+  void RegisterFD(FEX::HLE::SyscallHandler *const Handler);
   void RegisterFS();
   void RegisterInfo();
   void RegisterIO();
@@ -135,7 +135,7 @@ namespace FEX::HLE::x32 {
 
     // 32bit specific
     FEX::HLE::x32::RegisterEpoll(this);
-    FEX::HLE::x32::RegisterFD();
+    FEX::HLE::x32::RegisterFD(this);
     FEX::HLE::x32::RegisterFS();
     FEX::HLE::x32::RegisterInfo();
     FEX::HLE::x32::RegisterIO();
@@ -26,7 +26,7 @@ $end_info$
 #include <unistd.h>
 
 namespace FEX::HLE::x64 {
-  void RegisterFD() {
+  void RegisterFD(FEX::HLE::SyscallHandler *const Handler) {
     REGISTER_SYSCALL_IMPL_X64_PASS(poll, [](FEXCore::Core::CpuStateFrame *Frame, struct pollfd *fds, nfds_t nfds, int timeout) -> uint64_t {
       uint64_t Result = ::poll(fds, nfds, timeout);
       SYSCALL_ERRNO();
@@ -169,15 +169,26 @@ namespace FEX::HLE::x64 {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_X64_PASS(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
-      uint64_t Result = ::pread64(fd, buf, count, offset);
-      SYSCALL_ERRNO();
-    });
+    if (Handler->GetIOUringBatcher()) {
+      REGISTER_SYSCALL_IMPL_X64(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->PRead(fd, buf, count, offset);
+      });
 
-    REGISTER_SYSCALL_IMPL_X64_PASS(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
-      uint64_t Result = ::pwrite64(fd, buf, count, offset);
-      SYSCALL_ERRNO();
-    });
+      REGISTER_SYSCALL_IMPL_X64(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
+        return FEX::HLE::_SyscallHandler->GetIOUringBatcher()->PWrite(fd, buf, count, offset);
+      });
+    }
+    else {
+      REGISTER_SYSCALL_IMPL_X64_PASS(pread64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
+        uint64_t Result = ::pread64(fd, buf, count, offset);
+        SYSCALL_ERRNO();
+      });
+
+      REGISTER_SYSCALL_IMPL_X64_PASS(pwrite64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
+        uint64_t Result = ::pwrite64(fd, buf, count, offset);
+        SYSCALL_ERRNO();
+      });
+    }
 
     REGISTER_SYSCALL_IMPL_X64_PASS(process_vm_readv, [](FEXCore::Core::CpuStateFrame *Frame, pid_t pid, const struct iovec *local_iov, unsigned long liovcnt, const struct iovec *remote_iov, unsigned long riovcnt, unsigned long flags) -> uint64_t {
       uint64_t Result = ::process_vm_readv(pid, local_iov, liovcnt, remote_iov, riovcnt, flags);
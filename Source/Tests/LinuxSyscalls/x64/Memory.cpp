@@ -12,6 +12,9 @@ $end_info$
 
 #include <sys/mman.h>
 #include <sys/shm.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <map>
 #include <unistd.h>
 
@@ -27,9 +30,40 @@ static std::string get_fdpath(int fd)
   return std::filesystem::canonical(std::filesystem::path("/proc/self/fd") / std::to_string(fd), ec).string();
 }
 
+// A failed mprotect can still have changed part of the range, the host's mappings say what it ended up as
+static void RestoreGuestProtection(FEXCore::Context::Context *CTX, uintptr_t Base, size_t Length) {
+  const uintptr_t End = Length > UINTPTR_MAX - Base ? UINTPTR_MAX : Base + Length;
+
+  std::fstream fs("/proc/self/maps", std::fstream::in | std::fstream::binary);
+  std::string Line;
+  while (std::getline(fs, Line)) {
+    uint64_t MapBegin{};
+    uint64_t MapEnd{};
+    char Perms[5]{};
+    if (sscanf(Line.c_str(), "%lx-%lx %4s", &MapBegin, &MapEnd, Perms) != 3) {
+      continue;
+    }
+
+    const uintptr_t PartBegin = std::max<uintptr_t>(Base, MapBegin);
+    const uintptr_t PartEnd = std::min<uintptr_t>(End, MapEnd);
+    if (PartBegin >= PartEnd) {
+      continue;
+    }
+
+    const int Prot =
+      (Perms[0] == 'r' ? PROT_READ : 0) |
+      (Perms[1] == 'w' ? PROT_WRITE : 0) |
+      (Perms[2] == 'x' ? PROT_EXEC : 0);
+    FEXCore::Context::ProtectGuestMapping(CTX, PartBegin, PartEnd - PartBegin, Prot);
+  }
+}
+
 namespace FEX::HLE::x64 {
   void RegisterMemory(FEX::HLE::SyscallHandler *const Handler) {
     REGISTER_SYSCALL_IMPL_X64(munmap, [](FEXCore::Core::CpuStateFrame *Frame, void *addr, size_t length) -> uint64_t {
+      // Before the memory goes away, a compile in another thread might be reading it
+      FEXCore::Context::RemoveGuestMapping(Frame->Thread->CTX, (uintptr_t)addr, length);
+
       uint64_t Result{};
       if (addr < (void*)0x1'0000'0000ULL) {
         Result = (uint64_t)static_cast<FEX::HLE::SyscallHandler*>(FEX::HLE::_SyscallHandler)->Get32BitAllocator()->
@@ -58,6 +92,10 @@ namespace FEX::HLE::x64 {
 
       uint64_t Result{};
 
+      if (flags & MAP_FIXED) {
+        FEXCore::Context::RemoveGuestMapping(Frame->Thread->CTX, (uintptr_t)addr, length);
+      }
+
       bool Map32Bit = flags & FEX::HLE::X86_64_MAP_32BIT;
       if (Map32Bit) {
         Result = (uint64_t)static_cast<FEX::HLE::SyscallHandler*>(FEX::HLE::_SyscallHandler)->Get32BitAllocator()->
@@ -79,22 +117,49 @@ namespace FEX::HLE::x64 {
 
           FEXCore::Context::AddNamedRegion(Thread->CTX, Result, length, offset, filename);
         }
+        FEXCore::Context::AddGuestMapping(Thread->CTX, Result, length,
+          !(flags & MAP_ANONYMOUS) && (flags & MAP_TYPE) == MAP_PRIVATE, prot);
         FEXCore::Context::FlushCodeRange(Thread, (uintptr_t)Result, length);
       }
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_X64_PASS(mremap, [](FEXCore::Core::CpuStateFrame *Frame, void *old_address, size_t old_size, size_t new_size, int flags, void *new_address) -> uint64_t {
+    REGISTER_SYSCALL_IMPL_X64(mremap, [](FEXCore::Core::CpuStateFrame *Frame, void *old_address, size_t old_size, size_t new_size, int flags, void *new_address) -> uint64_t {
+      auto Thread = Frame->Thread;
+      // Moved memory is no longer considered read-only
+      FEXCore::Context::RemoveGuestMapping(Thread->CTX, (uintptr_t)old_address, old_size);
+      if (flags & MREMAP_FIXED) {
+        FEXCore::Context::RemoveGuestMapping(Thread->CTX, (uintptr_t)new_address, new_size);
+      }
+
       uint64_t Result = reinterpret_cast<uint64_t>(::mremap(old_address, old_size, new_size, flags, new_address));
+
+      if (Result != -1) {
+        FEXCore::Context::FlushCodeRange(Thread, (uintptr_t)old_address, old_size);
+      }
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X64(mprotect, [](FEXCore::Core::CpuStateFrame *Frame, void *addr, size_t len, int prot) -> uint64_t {
+      auto Thread = Frame->Thread;
+      const bool ReadOnly = (prot & PROT_READ) && !(prot & PROT_WRITE);
+      // Nothing gets read from the range while its protection changes
+      FEXCore::Context::ProtectGuestMapping(Thread->CTX, (uintptr_t)addr, len, PROT_NONE);
+
       uint64_t Result = ::mprotect(addr, len, prot);
 
-      auto Thread = Frame->Thread;
-      if (Result != -1 && prot & PROT_EXEC) {
-        FEXCore::Context::FlushCodeRange(Thread, (uintptr_t)addr, len);
+      if (Result != -1) {
+        FEXCore::Context::ProtectGuestMapping(Thread->CTX, (uintptr_t)addr, len, prot);
+
+        // Code that folded loads from the memory goes stale once it is writable
+        if (prot & PROT_EXEC || !ReadOnly) {
+          FEXCore::Context::FlushCodeRange(Thread, (uintptr_t)addr, len);
+        }
+      }
+      else if (FEXCore::Context::TracksGuestMappings(Thread->CTX)) {
+        const int MProtectErrno = errno;
+        RestoreGuestProtection(Thread->CTX, (uintptr_t)addr, len);
+        errno = MProtectErrno;
       }
       SYSCALL_ERRNO();
     });
@@ -14,7 +14,7 @@ $end_info$
 
 namespace FEX::HLE::x64 {
   void RegisterEpoll(FEX::HLE::SyscallHandler *const Handler);
-  void RegisterFD();
+  void RegisterFD(FEX::HLE::SyscallHandler *const Handler);
   void RegisterInfo();
   void RegisterIO();
   void RegisterIoctl();
@@ -126,7 +126,7 @@ namespace FEX::HLE::x64 {
 
     // 64bit specific
     FEX::HLE::x64::RegisterEpoll(this);
-    FEX::HLE::x64::RegisterFD();
+    FEX::HLE::x64::RegisterFD(this);
     FEX::HLE::x64::RegisterInfo();
     FEX::HLE::x64::RegisterIO();
     FEX::HLE::x64::RegisterIoctl();
@@ -222,6 +222,13 @@ namespace CPUStats {
         ImGui::Text("%f", BlocksCompiled.back());
       }
 
+      if (FEX::DebuggerState::ActiveCore()) {
+        auto RuntimeStats = FEXCore::Context::Debug::GetRuntimeStatsForThread(FEX::DebuggerState::GetContext(), CPUState::CurrentThreadSelected);
+        ImGui::Text("Code segments evicted: %lu", RuntimeStats->CodeSegmentsEvicted.load());
+        ImGui::Text("Blocks evicted: %lu", RuntimeStats->BlocksEvicted.load());
+        ImGui::Text("Blocks recompiled: %lu", RuntimeStats->BlocksRecompiled.load());
+      }
+
     }
     ImGui::End();
   }
@@ -654,23 +661,8 @@ namespace IR {
       return;
     }
 
-    FEXCore::Core::ThreadState *State = FEXCore::Context::Debug::GetThreadState(FEX::DebuggerState::GetContext());
-    FEXCore::Core::InternalThreadState *TS = reinterpret_cast<FEXCore::Core::InternalThreadState*>(State);
-
-    auto Local = TS->LocalIRCache;
-    auto &DebugData = TS->DebugData;
-
-    for (auto &LocalEntry : TS->LocalIRCache) {
-       std::ostringstream out;
-       out << "0x" << std::hex << LocalEntry.first;
-       IRDebugData DebugData;
-       DebugData.Debug = LocalEntry.second.DebugData.get();
-       DebugData.RIP = IR.first;
-       DebugData.RIPString = out.str();
-       DebugData.GuestCodeSize = std::to_string(DebugData.Debug->GuestCodeSize);
-       DebugData.GuestInstructionCount = std::to_string(DebugData.Debug->GuestInstructionCount);
-       IRListTexts.emplace_back(DebugData);
-    }
+    // The thread's IR cache is internal to FEXCore and can't be walked from here
+    // IRListTexts stays empty until there is a debug interface for listing the cached blocks
   }
 }
 
@@ -45,6 +45,7 @@ void CreateCoreCallback(char const *Filename, bool ELF) {
   FEXCore::Config::SetConfig(CTX, FEXCore::Config::CONFIG_DEFAULTCORE, FEX::DebuggerState::GetCoreType());
 
   FEXCore::Context::InitializeContext(CTX);
+  FEXCore::Context::Debug::RetainDebugData(CTX);
 
   bool Result{};
   if (ELF) {
@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+#include <FEXCore/Utils/Allocator.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+  // A range that is free in the test process on every host VA size
+  struct TestRange {
+    uintptr_t Begin;
+    uintptr_t End;
+  };
+
+  TestRange GetTestRange() {
+    const uintptr_t Begin = 1ULL << (FEXCore::Allocator::DetermineVASize() - 2);
+    return {Begin, Begin + 16ULL * 1024 * 1024 * 1024};
+  }
+
+  bool IsMappable(uintptr_t Ptr) {
+    void *Result = ::mmap(reinterpret_cast<void*>(Ptr), 4096, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (Result == MAP_FAILED) {
+      return false;
+    }
+
+    ::munmap(Result, 4096);
+    return Result == reinterpret_cast<void*>(Ptr);
+  }
+
+  size_t CountMappings() {
+    std::ifstream Maps("/proc/self/maps");
+    std::string Line;
+    size_t Count{};
+    while (std::getline(Maps, Line)) {
+      ++Count;
+    }
+    return Count;
+  }
+}
+
+TEST_CASE("StealMemoryRegion - Reserves around existing mappings") {
+  const auto Range = GetTestRange();
+
+  // Existing mappings at the start, in the middle and at the end of the range
+  const uintptr_t Holes[] = {
+    Range.Begin,
+    Range.Begin + 5ULL * 1024 * 1024 * 1024 + 4096 * 3,
+    Range.End - 4096,
+  };
+
+  for (auto Hole : Holes) {
+    void *Ptr = ::mmap(reinterpret_cast<void*>(Hole), 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    REQUIRE(Ptr == reinterpret_cast<void*>(Hole));
+    memset(Ptr, 0xAA, 4096);
+  }
+
+  auto Cache = FEXCore::Allocator::StealMemoryRegion(Range.Begin, Range.End);
+  REQUIRE(Cache != nullptr);
+
+  // Everything else in the range is taken
+  CHECK_FALSE(IsMappable(Range.Begin + 4096));
+  CHECK_FALSE(IsMappable(Range.Begin + 1024 * 1024 * 1024));
+  CHECK_FALSE(IsMappable(Range.End - 4096 * 2));
+
+  // Reclaiming hands it back without touching the existing mappings
+  FEXCore::Allocator::ReclaimMemoryRegion(Cache);
+
+  CHECK(IsMappable(Range.Begin + 4096));
+  CHECK(IsMappable(Range.Begin + 1024 * 1024 * 1024));
+  CHECK(IsMappable(Range.End - 4096 * 2));
+
+  for (auto Hole : Holes) {
+    CHECK(*reinterpret_cast<uint8_t*>(Hole + 4095) == 0xAA);
+    ::munmap(reinterpret_cast<void*>(Hole), 4096);
+  }
+}
+
+TEST_CASE("StealMemoryRegion - Fully mapped range") {
+  const auto Range = GetTestRange();
+  const size_t Size = 1024 * 1024;
+
+  void *Ptr = ::mmap(reinterpret_cast<void*>(Range.Begin), Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  REQUIRE(Ptr == reinterpret_cast<void*>(Range.Begin));
+
+  // Nothing to steal
+  auto Cache = FEXCore::Allocator::StealMemoryRegion(Range.Begin, Range.Begin + Size);
+  CHECK(Cache == nullptr);
+  FEXCore::Allocator::ReclaimMemoryRegion(Cache);
+
+  ::munmap(Ptr, Size);
+}
+
+// Startup cost of the VA reservation, run with: Allocator "[.benchmark]"
+TEST_CASE("StealMemoryRegion - Startup benchmark", "[.benchmark]") {
+  constexpr size_t Iterations = 20;
+
+  // Same as Steal48BitVA on a host with one more bit of VA, the top half of the VA with the stack and libraries in it
+  const size_t Bits = FEXCore::Allocator::DetermineVASize();
+  const uintptr_t Begin = 1ULL << (Bits - 1);
+  const uintptr_t End = 1ULL << Bits;
+
+  const size_t MappingsBefore = CountMappings();
+  size_t MappingsDuring{};
+
+  const auto Start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < Iterations; ++i) {
+    auto Cache = FEXCore::Allocator::StealMemoryRegion(Begin, End);
+    REQUIRE(Cache != nullptr);
+    if (i == 0) {
+      MappingsDuring = CountMappings();
+    }
+    FEXCore::Allocator::ReclaimMemoryRegion(Cache);
+  }
+  const auto Duration = std::chrono::steady_clock::now() - Start;
+
+  printf("StealMemoryRegion + ReclaimMemoryRegion of the top %zu bits: %.1fus per iteration, %zu mappings added\n",
+    Bits - 1,
+    std::chrono::duration<double, std::micro>(Duration).count() / Iterations,
+    MappingsDuring - MappingsBefore);
+}
@@ -0,0 +1,188 @@
+#include <catch2/catch.hpp>
+#include <FEXCore/Utils/Allocator.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sys/mman.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+  constexpr size_t PAGE_SIZE = 4096;
+
+  // The allocator reserves all of the VA above 32-bit, it can only be set up once per process
+  void EnsureHooks() {
+    static bool Installed = [] {
+      FEXCore::Allocator::SetupHooks();
+      return true;
+    }();
+    (void)Installed;
+  }
+
+  void *Map(size_t Size, void *Addr = nullptr, int Flags = 0) {
+    return FEXCore::Allocator::mmap(Addr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | Flags, -1, 0);
+  }
+}
+
+TEST_CASE("OSAllocator - Allocations are reused after munmap") {
+  EnsureHooks();
+
+  void *Ptr = Map(PAGE_SIZE * 16);
+  REQUIRE(Ptr != MAP_FAILED);
+  CHECK(reinterpret_cast<uintptr_t>(Ptr) >= 0x1'0000'0000ULL);
+  memset(Ptr, 0xAA, PAGE_SIZE * 16);
+
+  REQUIRE(FEXCore::Allocator::munmap(Ptr, PAGE_SIZE * 16) == 0);
+
+  // Memory that went back is PROT_NONE and zeroed on the next use
+  void *Again = Map(PAGE_SIZE * 16);
+  CHECK(Again == Ptr);
+  CHECK(*reinterpret_cast<uint8_t*>(Again) == 0);
+  FEXCore::Allocator::munmap(Again, PAGE_SIZE * 16);
+}
+
+TEST_CASE("OSAllocator - Holes are filled first") {
+  EnsureHooks();
+
+  void *Big = Map(PAGE_SIZE * 8);
+  void *A = Map(PAGE_SIZE);
+  void *B = Map(PAGE_SIZE);
+  void *C = Map(PAGE_SIZE);
+  REQUIRE(Big != MAP_FAILED);
+  REQUIRE(A != MAP_FAILED);
+  REQUIRE(B != MAP_FAILED);
+  REQUIRE(C != MAP_FAILED);
+
+  REQUIRE(FEXCore::Allocator::munmap(Big, PAGE_SIZE * 8) == 0);
+  REQUIRE(FEXCore::Allocator::munmap(B, PAGE_SIZE) == 0);
+
+  // The smallest hole that fits
+  void *Small = Map(PAGE_SIZE);
+  CHECK(Small == B);
+
+  // Then the next one
+  void *Medium = Map(PAGE_SIZE * 4);
+  CHECK(Medium == Big);
+
+  for (auto [Ptr, Size] : {std::pair{A, 1}, {C, 1}, {Small, 1}, {Medium, 4}}) {
+    FEXCore::Allocator::munmap(Ptr, PAGE_SIZE * Size);
+  }
+}
+
+TEST_CASE("OSAllocator - Fixed placement") {
+  EnsureHooks();
+
+  void *Ptr = Map(PAGE_SIZE * 4);
+  REQUIRE(Ptr != MAP_FAILED);
+
+  // Overlapping an existing allocation
+  auto Overlapping = reinterpret_cast<uint8_t*>(Ptr) + PAGE_SIZE * 2;
+  CHECK(Map(PAGE_SIZE * 4, Overlapping, MAP_FIXED_NOREPLACE) == MAP_FAILED);
+  CHECK(errno == EEXIST);
+
+  // Replacing part of it is fine
+  CHECK(Map(PAGE_SIZE, Overlapping, MAP_FIXED) == Overlapping);
+
+  REQUIRE(FEXCore::Allocator::munmap(Ptr, PAGE_SIZE * 4) == 0);
+
+  // Now free
+  CHECK(Map(PAGE_SIZE * 4, Overlapping, MAP_FIXED_NOREPLACE) == Overlapping);
+
+  // A hint that is free gets used as is
+  void *Hinted = Map(PAGE_SIZE * 2, Ptr);
+  CHECK(Hinted == Ptr);
+
+  FEXCore::Allocator::munmap(Overlapping, PAGE_SIZE * 4);
+  FEXCore::Allocator::munmap(Hinted, PAGE_SIZE * 2);
+}
+
+TEST_CASE("OSAllocator - Threads never get overlapping allocations") {
+  EnsureHooks();
+
+  constexpr size_t NumThreads = 8;
+  constexpr size_t Iterations = 2000;
+  std::atomic<bool> Overlapped{};
+  std::atomic<bool> Failed{};
+
+  std::vector<std::thread> Threads;
+  for (size_t i = 0; i < NumThreads; ++i) {
+    Threads.emplace_back([&, i] {
+      std::mt19937 Rand(i);
+      std::vector<std::pair<uint64_t*, size_t>> Live;
+
+      for (size_t j = 0; j < Iterations; ++j) {
+        if (Live.size() > 32 || (!Live.empty() && Rand() % 3 == 0)) {
+          auto [Ptr, Size] = Live[Rand() % Live.size()];
+          // Anyone else writing here would have changed this
+          if (*Ptr != reinterpret_cast<uint64_t>(Ptr) || Ptr[Size / sizeof(uint64_t) - 1] != i) {
+            Overlapped = true;
+          }
+          FEXCore::Allocator::munmap(Ptr, Size);
+          std::erase(Live, std::pair{Ptr, Size});
+          continue;
+        }
+
+        size_t Size = PAGE_SIZE * (1 + Rand() % 16);
+        auto Ptr = reinterpret_cast<uint64_t*>(Map(Size));
+        if (Ptr == MAP_FAILED) {
+          Failed = true;
+          break;
+        }
+        *Ptr = reinterpret_cast<uint64_t>(Ptr);
+        Ptr[Size / sizeof(uint64_t) - 1] = i;
+        Live.emplace_back(Ptr, Size);
+      }
+
+      for (auto [Ptr, Size] : Live) {
+        FEXCore::Allocator::munmap(Ptr, Size);
+      }
+    });
+  }
+
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+
+  CHECK_FALSE(Failed);
+  CHECK_FALSE(Overlapped);
+}
+
+// Mmap and munmap cost with many live allocations, run with: OSAllocator "[.benchmark]"
+TEST_CASE("OSAllocator - Fragmented benchmark", "[.benchmark]") {
+  EnsureHooks();
+
+  constexpr size_t NumAllocations = 20000;
+  constexpr size_t Iterations = 20000;
+
+  // Every other allocation freed, leaving lots of single page holes
+  std::vector<void*> Allocations;
+  for (size_t i = 0; i < NumAllocations; ++i) {
+    Allocations.emplace_back(Map(PAGE_SIZE));
+  }
+  for (size_t i = 0; i < NumAllocations; i += 2) {
+    FEXCore::Allocator::munmap(Allocations[i], PAGE_SIZE);
+  }
+
+  const auto Start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < Iterations; ++i) {
+    // Doesn't fit in any of the holes
+    void *Ptr = Map(PAGE_SIZE * 2);
+    REQUIRE(Ptr != MAP_FAILED);
+    FEXCore::Allocator::munmap(Ptr, PAGE_SIZE * 2);
+  }
+  const auto Duration = std::chrono::steady_clock::now() - Start;
+
+  printf("Mmap + Munmap with %zu holes: %.2fus per iteration\n",
+    NumAllocations / 2,
+    std::chrono::duration<double, std::micro>(Duration).count() / Iterations);
+
+  for (size_t i = 1; i < NumAllocations; i += 2) {
+    FEXCore::Allocator::munmap(Allocations[i], PAGE_SIZE);
+  }
+}
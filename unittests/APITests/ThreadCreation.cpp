@@ -0,0 +1,146 @@
+#include <catch2/catch.hpp>
+#include <FEXCore/Config/Config.h>
+#include <FEXCore/Core/CodeLoader.h>
+#include <FEXCore/Core/Context.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+  // Thread creation doesn't depend on what the backend does with the code
+  class NullBackend final : public FEXCore::CPU::CPUBackend {
+  public:
+    std::string GetName() override { return "Null"; }
+
+    void *CompileCode(uint64_t Entry,
+                      FEXCore::IR::IRListView const *IR,
+                      FEXCore::Core::DebugData *DebugData,
+                      FEXCore::IR::RegisterAllocationData *RAData) override {
+      return nullptr;
+    }
+
+    void *MapRegion(void *HostPtr, uint64_t GuestPtr, uint64_t Size) override { return HostPtr; }
+
+    bool NeedsOpDispatch() override { return true; }
+
+    void ClearCache() override { ++CacheClears; }
+
+    size_t CacheClears{};
+  };
+
+  class NullLoader final : public FEXCore::CodeLoader {
+  public:
+    uint64_t StackSize() const override { return 0; }
+    uint64_t GetStackPointer() override { return 0; }
+    uint64_t DefaultRIP() const override { return 0; }
+  };
+
+  class TestContext {
+  public:
+    TestContext() {
+      FEXCore::Config::Initialize();
+      FEXCore::Config::Load();
+      FEXCore::Config::Set(FEXCore::Config::CONFIG_CORE, std::to_string(FEXCore::Config::CONFIG_CUSTOM));
+
+      FEXCore::Context::InitializeStaticTables();
+      CTX = FEXCore::Context::CreateNewContext();
+      FEXCore::Context::SetCustomCPUBackendFactory(CTX, [](FEXCore::Context::Context*, FEXCore::Core::InternalThreadState*) {
+        return std::make_unique<NullBackend>();
+      });
+      FEXCore::Context::InitializeContext(CTX);
+      FEXCore::Context::InitCore(CTX, &Loader);
+    }
+
+    ~TestContext() {
+      FEXCore::Context::DestroyContext(CTX);
+      FEXCore::Context::ShutdownStaticTables();
+      FEXCore::Config::Shutdown();
+    }
+
+    FEXCore::Core::InternalThreadState *CreateThread() {
+      FEXCore::Core::CPUState State{};
+      return FEXCore::Context::CreateThread(CTX, &State, 0);
+    }
+
+    void DestroyThread(FEXCore::Core::InternalThreadState *Thread) {
+      FEXCore::Context::DestroyThread(CTX, Thread);
+    }
+
+    FEXCore::Context::Context *CTX;
+    NullLoader Loader;
+  };
+}
+
+TEST_CASE("ThreadCreation - Torn down threads are reused") {
+  TestContext Test;
+
+  auto Thread = Test.CreateThread();
+  auto Backend = Thread->CPUBackend.get();
+  Thread->CurrentFrame->State.rip = 0x1234;
+  Thread->Stats.BlocksCompiled = 10;
+  const auto TID = Thread->ThreadManager.GetTID();
+  Test.DestroyThread(Thread);
+
+  auto Reused = Test.CreateThread();
+  REQUIRE(Reused == Thread);
+
+  // The JIT state stays
+  CHECK(Reused->CPUBackend.get() == Backend);
+  CHECK(static_cast<NullBackend*>(Backend)->CacheClears == 1);
+
+  // Everything else starts over
+  CHECK(Reused->CurrentFrame == &Reused->BaseFrameState);
+  CHECK(Reused->CurrentFrame->Thread == Reused);
+  CHECK(Reused->CurrentFrame->State.rip == 0);
+  CHECK(Reused->Stats.BlocksCompiled.load() == 0);
+  CHECK(Reused->ThreadManager.GetTID() != TID);
+  CHECK_FALSE(Reused->DestroyedByParent);
+
+  Test.DestroyThread(Reused);
+}
+
+TEST_CASE("ThreadCreation - Many threads at once") {
+  TestContext Test;
+
+  std::vector<FEXCore::Core::InternalThreadState*> Threads;
+  for (size_t i = 0; i < 32; ++i) {
+    Threads.emplace_back(Test.CreateThread());
+  }
+  for (auto Thread : Threads) {
+    Test.DestroyThread(Thread);
+  }
+
+  // Only some of them get kept, the rest are freed
+  std::vector<FEXCore::Core::InternalThreadState*> Again;
+  for (size_t i = 0; i < 32; ++i) {
+    auto Thread = Again.emplace_back(Test.CreateThread());
+    CHECK(Thread->CPUBackend != nullptr);
+    CHECK(Thread->LookupCache != nullptr);
+  }
+  for (auto Thread : Again) {
+    Test.DestroyThread(Thread);
+  }
+}
+
+// Cost of setting up and tearing down a guest thread's state, run with: ThreadCreation "[.benchmark]"
+TEST_CASE("ThreadCreation - Create and destroy benchmark", "[.benchmark]") {
+  TestContext Test;
+
+  constexpr size_t Iterations = 2000;
+
+  const auto Start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < Iterations; ++i) {
+    Test.DestroyThread(Test.CreateThread());
+  }
+  const auto Duration = std::chrono::steady_clock::now() - Start;
+
+  printf("CreateThread + DestroyThread: %.2fus per iteration\n",
+    std::chrono::duration<double, std::micro>(Duration).count() / Iterations);
+}
@@ -0,0 +1,105 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RBX": "122"
+  }
+}
+%endif
+
+; One indirect jump sees more targets than its inline cache holds, so it moves on to the L1 lookup
+; Then one of the targets gets unmapped and mapped again with different code, the jump has to run the new code
+
+%define TARGETS 0x30000000
+
+mov rsp, 0xe8000000
+mov r12, 0xe0000000
+
+; mmap(TARGETS, 4 pages, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0)
+mov edi, TARGETS
+mov esi, 0x4000
+mov edx, 3
+mov r10d, 0x32
+mov r8, -1
+xor r9d, r9d
+mov eax, 9
+syscall
+
+; Page N: add rbx, N + 1; ret
+mov rdi, TARGETS
+mov rax, 0xc301c38348
+mov [rdi + 0x0000], rax
+mov rax, 0xc302c38348
+mov [rdi + 0x1000], rax
+mov rax, 0xc303c38348
+mov [rdi + 0x2000], rax
+mov rax, 0xc304c38348
+mov [rdi + 0x3000], rax
+
+; Table of the targets
+mov [r12 + 0x00], rdi
+lea rax, [rdi + 0x1000]
+mov [r12 + 0x08], rax
+lea rax, [rdi + 0x2000]
+mov [r12 + 0x10], rax
+lea rax, [rdi + 0x3000]
+mov [r12 + 0x18], rax
+
+; mprotect(TARGETS, 4 pages, PROT_READ | PROT_EXEC)
+mov edi, TARGETS
+mov esi, 0x4000
+mov edx, 5
+mov eax, 10
+syscall
+
+; Every target twice through the same jump
+xor ebx, ebx
+mov r13d, 2
+outer:
+xor r14d, r14d
+inner:
+mov rax, [r12 + r14 * 8]
+call site
+inc r14d
+cmp r14d, 4
+jne inner
+dec r13d
+jnz outer
+
+; munmap(TARGETS, 1 page)
+mov edi, TARGETS
+mov esi, 0x1000
+mov eax, 11
+syscall
+
+; mmap(TARGETS, 1 page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0)
+mov edi, TARGETS
+mov esi, 0x1000
+mov edx, 3
+mov r10d, 0x32
+mov r8, -1
+xor r9d, r9d
+mov eax, 9
+syscall
+
+; add rbx, 100; ret
+mov rdi, TARGETS
+mov rax, 0xc364c38348
+mov [rdi], rax
+
+; mprotect(TARGETS, 1 page, PROT_READ | PROT_EXEC)
+mov edi, TARGETS
+mov esi, 0x1000
+mov edx, 5
+mov eax, 10
+syscall
+
+; The replaced target and one that is still cached
+mov rax, [r12 + 0x00]
+call site
+mov rax, [r12 + 0x08]
+call site
+
+hlt
+
+site:
+jmp rax
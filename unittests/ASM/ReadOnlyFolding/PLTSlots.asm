@@ -0,0 +1,107 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RBX": "2",
+    "RCX": "1",
+    "RDX": "1"
+  }
+}
+%endif
+
+; Calls through PLT stubs in a private file mapping, like a shared library would have
+; Page 0 is the PLT and the functions, page 1 a read-only GOT slot and page 2 a slot still writable from lazy binding
+
+; The test is assembled at 0 but runs at 0x10000, direct references to absolute addresses need to account for that
+%define CODE_BASE 0x10000
+%define PLT_BASE 0x20000000
+
+start:
+mov rsp, 0xe8000000
+mov r14, 0xe0001000
+
+; memfd_create("plt", 0)
+mov rdi, 0xe0000000
+mov dword [rdi], 0x00746c70
+xor esi, esi
+mov eax, 319
+syscall
+mov r15, rax
+
+; jmp [rip + 0xffa], to the read-only slot
+mov rax, 0x00000ffa25ff
+mov [r14 + 0x00], rax
+; jmp [rip + 0x1fea], to the lazy slot
+mov rax, 0x00001fea25ff
+mov [r14 + 0x10], rax
+; add rcx, 1; ret
+mov rax, 0xc301c18348
+mov [r14 + 0x20], rax
+; add rdx, 1; ret
+mov rax, 0xc301c28348
+mov [r14 + 0x30], rax
+; add rbx, 1; ret
+mov rax, 0xc301c38348
+mov [r14 + 0x40], rax
+
+mov rax, PLT_BASE + 0x40
+mov [r14 + 0x1000], rax
+mov rax, PLT_BASE + 0x20
+mov [r14 + 0x2000], rax
+
+; write(fd, contents, 3 pages)
+mov rdi, r15
+mov rsi, r14
+mov edx, 0x3000
+mov eax, 1
+syscall
+
+; mmap(PLT_BASE, 1 page, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_FIXED, fd, 0)
+mov rdi, PLT_BASE
+mov esi, 0x1000
+mov edx, 5
+mov r10d, 0x12
+mov r8, r15
+xor r9d, r9d
+mov eax, 9
+syscall
+
+; mmap(PLT_BASE + 1 page, 1 page, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 1 page)
+mov rdi, PLT_BASE + 0x1000
+mov esi, 0x1000
+mov edx, 1
+mov r10d, 0x12
+mov r8, r15
+mov r9d, 0x1000
+mov eax, 9
+syscall
+
+; mmap(PLT_BASE + 2 pages, 1 page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 2 pages)
+mov rdi, PLT_BASE + 0x2000
+mov esi, 0x1000
+mov edx, 3
+mov r10d, 0x12
+mov r8, r15
+mov r9d, 0x2000
+mov eax, 9
+syscall
+
+xor ebx, ebx
+xor ecx, ecx
+xor edx, edx
+
+; Read-only slot, through the PLT stub and with -fno-plt style calls
+call PLT_BASE - CODE_BASE
+call [rel start + PLT_BASE - CODE_BASE + 0x1000]
+
+; Lazy slot, the block is compiled while the slot points at the first function
+; The second time around the slot points elsewhere and the guard has to miss
+mov esi, 2
+loop_top:
+call PLT_BASE - CODE_BASE + 0x10
+
+mov rax, PLT_BASE + 0x30
+mov [PLT_BASE + 0x2000], rax
+dec esi
+jnz loop_top
+
+hlt
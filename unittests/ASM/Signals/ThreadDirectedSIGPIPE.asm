@@ -0,0 +1,125 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "1",
+    "RBX": "1"
+  }
+}
+%endif
+
+; A thread that masks SIGPIPE writes to a pipe without a reader
+; That SIGPIPE is meant for the writing thread, the main thread has it unmasked but must not take it
+; Once the writer unmasks it the handler has to run on the writer
+
+; 0x00: TID the handler ran on
+; 0x08: Number of times the handler ran
+; 0x10: Child TID, cleared by the kernel once the child exits
+; 0x18: Pipe fds
+; 0x20: Signal action
+; 0x40: Signal mask
+; 0x50: Sleep time
+mov r12, 0xe0000000
+mov rsp, 0xe8000000
+
+; rt_sigaction(SIGPIPE, {handler, SA_RESTORER, restorer, 0}, NULL, 8)
+lea rax, [rel handler]
+mov [r12 + 0x20], rax
+mov qword [r12 + 0x28], 0x04000000
+lea rax, [rel restorer]
+mov [r12 + 0x30], rax
+mov qword [r12 + 0x38], 0
+mov edi, 13
+lea rsi, [r12 + 0x20]
+xor edx, edx
+mov r10d, 8
+mov eax, 13
+syscall
+
+; pipe(fds), then close the read end
+lea rdi, [r12 + 0x18]
+mov eax, 22
+syscall
+mov edi, [r12 + 0x18]
+mov eax, 3
+syscall
+
+; clone(CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD | CLONE_SYSVSEM | CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID, stack, &tid, &tid, 0)
+mov edi, 0x3d0f00
+mov rsi, 0xe0100000
+lea rdx, [r12 + 0x10]
+mov r10, rdx
+xor r8d, r8d
+mov eax, 56
+syscall
+test rax, rax
+jz child
+mov r13, rax
+
+wait_loop:
+mov edx, [r12 + 0x10]
+test edx, edx
+jz done
+; futex(&tid, FUTEX_WAIT, tid, NULL)
+lea rdi, [r12 + 0x10]
+xor esi, esi
+xor r10d, r10d
+mov eax, 202
+syscall
+jmp wait_loop
+
+done:
+mov rax, [r12 + 0x08]
+xor ebx, ebx
+cmp [r12 + 0x00], r13
+sete bl
+hlt
+
+child:
+; rt_sigprocmask(SIG_BLOCK, {SIGPIPE}, NULL, 8)
+mov qword [r12 + 0x40], 1 << 12
+xor edi, edi
+lea rsi, [r12 + 0x40]
+xor edx, edx
+mov r10d, 8
+mov eax, 14
+syscall
+
+; write(fds[1], buf, 1) fails with EPIPE and raises SIGPIPE for this thread
+mov edi, [r12 + 0x1c]
+lea rsi, [r12 + 0x40]
+mov edx, 1
+mov eax, 1
+syscall
+
+; nanosleep(10ms), gives a wrongly routed SIGPIPE time to land on the main thread
+mov qword [r12 + 0x50], 0
+mov qword [r12 + 0x58], 10000000
+lea rdi, [r12 + 0x50]
+xor esi, esi
+mov eax, 35
+syscall
+
+; rt_sigprocmask(SIG_UNBLOCK, {SIGPIPE}, NULL, 8), the handler runs here
+mov edi, 1
+lea rsi, [r12 + 0x40]
+xor edx, edx
+mov r10d, 8
+mov eax, 14
+syscall
+
+; exit(0), only ends this thread
+xor edi, edi
+mov eax, 60
+syscall
+
+handler:
+mov eax, 186
+syscall
+mov rdx, 0xe0000000
+mov [rdx + 0x00], rax
+lock inc qword [rdx + 0x08]
+ret
+
+restorer:
+mov eax, 15
+syscall